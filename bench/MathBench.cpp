@@ -0,0 +1,193 @@
+// Micro benchmarks for the vectorized math kernels against their scalar reference
+// implementations. Build with -DPBR_BUILD_BENCHMARKS=ON and pick the instruction set
+// through PBR_SIMD.
+
+#include <PBRMath.h>
+#include <BBox.h>
+
+#include <chrono>
+#include <random>
+
+using namespace pbr;
+using namespace pbr::math;
+
+namespace {
+
+constexpr std::size_t NumInputs = 1024;
+constexpr int NumRounds = 2000;
+
+// Keeps results alive so the compiler can't drop the timed loops
+volatile float Sink = 0;
+
+Mat4 RandomMatrix(std::mt19937& rng) {
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    Mat4 ret;
+    for (unsigned r = 0; r < 4; ++r)
+        for (unsigned c = 0; c < 4; ++c)
+            ret(r, c) = dist(rng);
+
+    // Diagonally dominant, so always invertible
+    for (unsigned i = 0; i < 4; ++i)
+        ret(i, i) += 4.0f;
+
+    return ret;
+}
+
+Mat4 RandomAffine(std::mt19937& rng) {
+    Mat4 ret = RandomMatrix(rng);
+    ret(3, 0) = ret(3, 1) = ret(3, 2) = 0;
+    ret(3, 3) = 1;
+    return ret;
+}
+
+BBox3 TransformCorners(const Mat4& mat, const BBox3& box) {
+    BBox3 ret(FLOAT_INFINITY, -FLOAT_INFINITY);
+    for (unsigned i = 0; i < 8; ++i) {
+        const Vec3 corner{box[i & 1].x, box[(i >> 1) & 1].y, box[(i >> 2) & 1].z};
+        ret.expand(scalar::Mul(mat, Vec4(corner, 1.0f)));
+    }
+    return ret;
+}
+
+float MaxError(const Mat4& a, const Mat4& b) {
+    float err = 0;
+    for (unsigned r = 0; r < 4; ++r)
+        for (unsigned c = 0; c < 4; ++c)
+            err = std::max(err, std::abs(a(r, c) - b(r, c)));
+    return err;
+}
+
+template<typename Func>
+double NsPerOp(Func&& func) {
+    using namespace std::chrono;
+
+    const auto start = steady_clock::now();
+    for (int round = 0; round < NumRounds; ++round)
+        for (std::size_t i = 0; i < NumInputs; ++i)
+            func(i);
+    const auto end = steady_clock::now();
+
+    return duration<double, std::nano>(end - start).count() / (NumRounds * NumInputs);
+}
+
+void Report(const std::string& name, double reference, double vectorized, float error) {
+    std::cout << std::format("{:<12} {:>10.2f} {:>10.2f} {:>8.2f}x {:>12.3g}\n", name,
+                             reference, vectorized, reference / vectorized, error);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+
+    std::vector<Mat4> mats(NumInputs), affine(NumInputs);
+    std::vector<Vec4> vecs(NumInputs);
+    std::vector<BBox3> boxes(NumInputs);
+    for (std::size_t i = 0; i < NumInputs; ++i) {
+        mats[i] = RandomMatrix(rng);
+        affine[i] = RandomAffine(rng);
+        vecs[i] = {dist(rng), dist(rng), dist(rng), 1.0f};
+
+        const Vec3 p{dist(rng), dist(rng), dist(rng)};
+        boxes[i] = {p, p + Vec3(std::abs(dist(rng)))};
+    }
+
+#ifdef PBR_SIMD_AVX2
+    std::cout << "SIMD: AVX2\n";
+#elif defined(PBR_SIMD_SSE)
+    std::cout << "SIMD: SSE\n";
+#else
+    std::cout << "SIMD: None\n";
+#endif
+
+    std::cout << std::format("{:<12} {:>10} {:>10} {:>9} {:>12}\n", "Op", "Scalar ns",
+                             "Vector ns", "Speedup", "Max error");
+
+    auto next = [](std::size_t i) { return (i + 1) % NumInputs; };
+
+    // Matrix product
+    {
+        float err = 0;
+        for (std::size_t i = 0; i < NumInputs; ++i) {
+            const Mat4 ref = scalar::Mul(mats[i], mats[next(i)]);
+            err = std::max(err, MaxError(ref, mats[i] * mats[next(i)]));
+        }
+
+        const double ref = NsPerOp([&](std::size_t i) {
+            Sink = Sink + scalar::Mul(mats[i], mats[next(i)])(0, 0);
+        });
+        const double vec = NsPerOp(
+            [&](std::size_t i) { Sink = Sink + (mats[i] * mats[next(i)])(0, 0); });
+
+        Report("Mat4 * Mat4", ref, vec, err);
+    }
+
+    // Matrix vector product
+    {
+        float err = 0;
+        for (std::size_t i = 0; i < NumInputs; ++i) {
+            const Vec4 diff = scalar::Mul(mats[i], vecs[i]) - mats[i] * vecs[i];
+            err = std::max(err, Abs(diff).max());
+        }
+
+        const double ref = NsPerOp(
+            [&](std::size_t i) { Sink = Sink + scalar::Mul(mats[i], vecs[i]).x; });
+        const double vec =
+            NsPerOp([&](std::size_t i) { Sink = Sink + (mats[i] * vecs[i]).x; });
+
+        Report("Mat4 * Vec4", ref, vec, err);
+    }
+
+    // Transpose
+    {
+        float err = 0;
+        for (const Mat4& mat : mats)
+            err = std::max(err, MaxError(scalar::Transpose(mat), Transpose(mat)));
+
+        const double ref = NsPerOp(
+            [&](std::size_t i) { Sink = Sink + scalar::Transpose(mats[i])(0, 1); });
+        const double vec =
+            NsPerOp([&](std::size_t i) { Sink = Sink + Transpose(mats[i])(0, 1); });
+
+        Report("Transpose", ref, vec, err);
+    }
+
+    // Inverse
+    {
+        float err = 0;
+        for (const Mat4& mat : mats) {
+            err = std::max(err, MaxError(scalar::Inverse(mat), Inverse(mat)));
+            err = std::max(err, MaxError(mat * Inverse(mat), Mat4()));
+        }
+
+        const double ref = NsPerOp(
+            [&](std::size_t i) { Sink = Sink + scalar::Inverse(mats[i])(0, 0); });
+        const double vec =
+            NsPerOp([&](std::size_t i) { Sink = Sink + Inverse(mats[i])(0, 0); });
+
+        Report("Inverse", ref, vec, err);
+    }
+
+    // Bounding box transform
+    {
+        float err = 0;
+        for (std::size_t i = 0; i < NumInputs; ++i) {
+            const BBox3 ref = TransformCorners(affine[i], boxes[i]);
+            const BBox3 box = Transform(affine[i], boxes[i]);
+            err = std::max(err, Abs(ref.min() - box.min()).max());
+            err = std::max(err, Abs(ref.max() - box.max()).max());
+        }
+
+        const double ref = NsPerOp([&](std::size_t i) {
+            Sink = Sink + TransformCorners(affine[i], boxes[i]).min().x;
+        });
+        const double vec = NsPerOp(
+            [&](std::size_t i) { Sink = Sink + Transform(affine[i], boxes[i]).min().x; });
+
+        Report("BBox3", ref, vec, err);
+    }
+
+    return 0;
+}
@@ -2,8 +2,6 @@ const float PI = 3.14159265358979;
 const float MaxSpecularLod = 8;
 const float ClearCoatF0 = 0.04;
 
-const int NUM_LIGHTS = 5;
-
 const int LIGHT_NONE = 0;
 const int LIGHT_POINT = 1;
 const int LIGHT_SPOT = 2;
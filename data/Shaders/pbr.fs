@@ -9,6 +9,7 @@ in FragData {
     vec3 normal;
     vec2 texCoords;
     mat3 TBN;
+    flat uint material;
 }
 vsIn;
 
@@ -22,6 +23,14 @@ layout(std140, binding = 1) uniform cameraBlock {
     vec3 ViewPos;
 };
 
+layout(std140, binding = 2) uniform clusterBlock {
+    uvec3 ClusterDims;
+    uint NumGlobalLights;
+    vec2 ClusterTileScale;
+    float ClusterDepthScale;
+    float ClusterDepthBias;
+};
+
 struct Light {
     vec3 position;
     float auxA;
@@ -29,11 +38,16 @@ struct Light {
     int type;
     vec3 auxB;
     float auxC;
+    float range;
 };
 
-layout(std140, binding = 2) uniform lightBlock { Light lights[NUM_LIGHTS]; };
+// Global lights first, followed by the lights referenced from clusters
+layout(std430, binding = 5) readonly buffer lightBlock { Light lights[]; };
+layout(std430, binding = 6) readonly buffer clusterGridBlock { uvec2 clusters[]; };
+layout(std430, binding = 7) readonly buffer lightIndexBlock { uint lightIndices[]; };
 
-// Material parameters
+// Material parameters, each map is only sampled by the variants that define HAS_*_MAP.
+// Without it the default the map would hold is used.
 layout(location = 1) uniform sampler2D diffuseTex;
 layout(location = 2) uniform sampler2D normalTex;
 layout(location = 3) uniform sampler2D metallicTex;
@@ -42,12 +56,16 @@ layout(location = 5) uniform sampler2D aoTex;
 layout(location = 6) uniform sampler2D emissiveTex;
 layout(location = 7) uniform sampler2D clearCoatNormTex;
 
-layout(location = 8) uniform vec3 diffuse;
-layout(location = 9) uniform float metallic;
-layout(location = 10) uniform float roughness;
-layout(location = 11) uniform float spec;
-layout(location = 12) uniform float clearCoatRough;
-layout(location = 13) uniform float clearCoat;
+struct Material {
+    vec3 diffuse;
+    float spec;
+    float metallic;
+    float roughness;
+    float clearCoat;
+    float clearCoatRough;
+};
+
+layout(std430, binding = 4) readonly buffer materialBlock { Material materials[]; };
 
 // IBL precomputation
 layout(location = 15) uniform samplerCube irradianceTex;
@@ -62,11 +80,18 @@ struct ShadingContext {
     vec3 clearCoatNormal;
     float NdotV, NdotL, NdotVcc;
     float a, ao, att, specNorm, metal, rough, dist;
+    float clearCoat, clearCoatRough;
 };
 
+// Normal of a planar normal map
+vec3 GeometricNormal() {
+    return normalize(vsIn.TBN[2]);
+}
+
+// Z is rebuilt from the xy of the map, so two channel BC5 normal maps work too
 vec3 PerturbNormal(in sampler2D normalMap) {
-    vec3 normal = texture(normalMap, vsIn.texCoords).rgb;
-    normal = normal * 2.0 - 1.0;
+    vec2 xy = texture(normalMap, vsIn.texCoords).rg * 2.0 - 1.0;
+    vec3 normal = vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0)));
     return normalize(vsIn.TBN * normal);
 }
 
@@ -127,23 +152,28 @@ void CalcLightAttrs(inout ShadingContext sc, in Light l) {
 
     sc.L = toLight;
     sc.dist = length(sc.L);
+#ifdef HAS_AREA_LIGHTS
     if (l.type == LIGHT_SPHERE)
         sc.L = closestPtSphere(sc, l.auxA);
     else if (l.type == LIGHT_TUBE)
         sc.L = closestPtTube(sc, l, toLight);
+#endif
 
     sc.L = normalize(sc.L);
     sc.H = normalize(sc.V + sc.L);
 
     // Light attenuation
     sc.att = 1.0;
+#ifdef HAS_SPOT_LIGHTS
     if (l.type == LIGHT_SPOT)
         sc.att = SpotAngleAttenuation(sc.L, l.auxB, l.auxA, l.auxC);
-    sc.att *= PointAttenuation(sc.dist, 0.01);
+#endif
+    sc.att *= PointAttenuation(sc.dist, 1.0 / l.range);
 
     // Normalization factor
     // Only specular component for area lights
     sc.specNorm = 1.0;
+#ifdef HAS_AREA_LIGHTS
     switch (l.type) {
         case LIGHT_SPHERE:
         case LIGHT_TUBE:
@@ -152,6 +182,7 @@ void CalcLightAttrs(inout ShadingContext sc, in Light l) {
             sc.specNorm = ap * ap * PI;
             break;
     }
+#endif
 }
 
 vec3 EvalSpecularIBL(vec3 R, float NdotV, vec3 F0, float roughness) {
@@ -179,14 +210,14 @@ vec3 EnvironmentLighting(in ShadingContext sc) {
     // ---------------------------------------------------------------------
     //    Clearcoat
     // ---------------------------------------------------------------------
-    float Fcc = fresnSchlick(sc.NdotVcc, ClearCoatF0, 1.0) * clearCoat;
-    vec3 iblClearCoat = EvalSpecularIBL(sc.Rcc, sc.NdotVcc, vec3(ClearCoatF0), clearCoatRough);
+    float Fcc = fresnSchlick(sc.NdotVcc, ClearCoatF0, 1.0) * sc.clearCoat;
+    vec3 iblClearCoat = EvalSpecularIBL(sc.Rcc, sc.NdotVcc, vec3(ClearCoatF0), sc.clearCoatRough);
 
     // Attenuate base layer
     iblDiffuse *= 1.0 - Fcc;
     iblSpecular *= 1.0 - Fcc;
 
-    return (iblDiffuse + iblSpecular) * sc.ao + iblClearCoat * clearCoat;
+    return (iblDiffuse + iblSpecular) * sc.ao + iblClearCoat * sc.clearCoat;
 #else
     return (iblDiffuse + iblSpecular) * sc.ao;
 #endif
@@ -214,12 +245,12 @@ vec3 ShadingLight(in ShadingContext sc) {
     float NdotHcc = clamp(dot(sc.clearCoatNormal, sc.H), 0.0, 1.0);
     float NdotLcc = max(dot(sc.clearCoatNormal, sc.L), 0.0);
 
-    float remapClearRough = clamp(clearCoatRough, 0.089, 1.0);
+    float remapClearRough = clamp(sc.clearCoatRough, 0.089, 1.0);
     float clearCoatA = remapClearRough * remapClearRough;
 
     float Dcc = distGGX(NdotHcc, clearCoatA);
     float Vcc = visKelemen(HdotL);
-    float Fcc = fresnSchlick(HdotV, ClearCoatF0, 1.0) * clearCoat;
+    float Fcc = fresnSchlick(HdotV, ClearCoatF0, 1.0) * sc.clearCoat;
     float clearCoatLayer = Dcc * Vcc * Fcc;
 
     return (baseLayer * (1.0 - Fcc) * sc.NdotL + clearCoatLayer * NdotLcc) * Li;
@@ -229,27 +260,77 @@ vec3 ShadingLight(in ShadingContext sc) {
 }
 
 void GetMaterial(inout ShadingContext sc) {
-    sc.kd = diffuse * toLinearRGB(texture(diffuseTex, vsIn.texCoords).rgb, gamma);
-    sc.rough = roughness * texture(roughTex, vsIn.texCoords).r;
+    const Material mat = materials[vsIn.material];
+
+    sc.kd = mat.diffuse;
+#ifdef HAS_DIFFUSE_MAP
+    sc.kd *= toLinearRGB(texture(diffuseTex, vsIn.texCoords).rgb, gamma);
+#endif
+
+    sc.rough = mat.roughness;
+#ifdef HAS_ROUGHNESS_MAP
+    sc.rough *= texture(roughTex, vsIn.texCoords).r;
+#endif
     sc.rough = clamp(sc.rough, 0.089, 1.0);
-    sc.metal = metallic * texture(metallicTex, vsIn.texCoords).r;
-    sc.ao = texture(aoTex, vsIn.texCoords).r;
     sc.a = sc.rough * sc.rough;
+
+    sc.metal = mat.metallic;
+#ifdef HAS_METALLIC_MAP
+    sc.metal *= texture(metallicTex, vsIn.texCoords).r;
+#endif
+
+    sc.ao = 1.0;
+#ifdef HAS_OCCLUSION_MAP
+    sc.ao = texture(aoTex, vsIn.texCoords).r;
+#endif
+
+    sc.Le = vec3(0);
+#ifdef HAS_EMISSIVE_MAP
     sc.Le = toLinearRGB(texture(emissiveTex, vsIn.texCoords).rgb, gamma);
+#endif
 
 #ifdef HAS_CLEARCOAT
+#ifdef HAS_CLEARCOAT_NORMAL_MAP
     sc.clearCoatNormal = PerturbNormal(clearCoatNormTex);
+#else
+    sc.clearCoatNormal = GeometricNormal();
+#endif
+    sc.clearCoat = mat.clearCoat;
+    sc.clearCoatRough = mat.clearCoatRough;
 #endif
 
     // Map F0 to diffuse color for metals and maxmimum 0.04 for dielectrics
-    sc.F0 = 0.16 * spec * spec * (1.0 - sc.metal) + sc.kd * sc.metal;
+    sc.F0 = 0.16 * mat.spec * mat.spec * (1.0 - sc.metal) + sc.kd * sc.metal;
+}
+
+vec3 EvalLight(inout ShadingContext sc, in Light l) {
+    CalcLightAttrs(sc, l);
+
+    if (l.type != LIGHT_TUBE)
+        sc.NdotL = max(dot(sc.N, sc.L), 0.0);
+
+    return ShadingLight(sc);
+}
+
+uint ClusterIndex() {
+    float depth = -(ViewMatrix * vec4(vsIn.position, 1.0)).z;
+    float slice = log(depth) * ClusterDepthScale - ClusterDepthBias;
+
+    uvec3 cluster = uvec3(gl_FragCoord.xy * ClusterTileScale, max(slice, 0.0));
+    cluster = min(cluster, ClusterDims - 1);
+
+    return cluster.x + ClusterDims.x * (cluster.y + ClusterDims.y * cluster.z);
 }
 
 void main(void) {
     ShadingContext sc;
 
     sc.V = normalize(ViewPos - vsIn.position);
+#ifdef HAS_NORMAL_MAP
     sc.N = PerturbNormal(normalTex);
+#else
+    sc.N = GeometricNormal();
+#endif
     sc.R = reflect(-sc.V, sc.N);
 
     GetMaterial(sc);
@@ -264,18 +345,12 @@ void main(void) {
     vec3 Lenv = EnvironmentLighting(sc) * envIntensity;
 
     vec3 Lrad = vec3(0);
-    for (int i = 0; i < NUM_LIGHTS; ++i) {
-        const Light l = lights[i];
-        if (l.type == LIGHT_NONE)
-            continue;
-
-        CalcLightAttrs(sc, l);
+    for (uint i = 0; i < NumGlobalLights; ++i)
+        Lrad += EvalLight(sc, lights[i]);
 
-        if (l.type != LIGHT_TUBE)
-            sc.NdotL = max(dot(sc.N, sc.L), 0.0);
-
-        Lrad += ShadingLight(sc);
-    }
+    const uvec2 cluster = clusters[ClusterIndex()];
+    for (uint i = 0; i < cluster.y; ++i)
+        Lrad += EvalLight(sc, lights[lightIndices[cluster.x + i]]);
 
     vec3 Lsum = sc.Le + Lenv + Lrad;
     Lsum = ToneMap(toneMapType, Lsum, exposure);
@@ -1,10 +1,18 @@
+// Packed geometry stores octahedral normals and tangents in the xy of these
 layout(location = 0) in vec3 Position;
 layout(location = 1) in vec3 Normal;
 layout(location = 2) in vec2 TexCoords;
 layout(location = 3) in vec4 Tangent;
 
-layout(location = 20) uniform mat4 ModelMatrix;
-layout(location = 21) uniform mat3 NormalMatrix;
+struct Instance {
+    mat4 modelMatrix;
+    mat4 normalMatrix;
+    vec4 positionScale; // w is 1 when normals and tangents are packed
+    vec4 positionOffset;
+    uint material;
+};
+
+layout(std430, binding = 3) readonly buffer instanceBlock { Instance instances[]; };
 
 layout(std140, binding = 1) uniform cameraBlock {
     mat4 ViewMatrix;
@@ -19,18 +27,41 @@ out FragData {
     vec3 normal;
     vec2 texCoords;
     mat3 TBN;
+    flat uint material;
 }
 vsOut;
 
+vec3 DecodeOctahedral(vec2 e) {
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-v.z, 0.0);
+    v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);
+    return normalize(v);
+}
+
 void main(void) {
-    vsOut.position = vec3(ModelMatrix * vec4(Position, 1.0));
-    vsOut.normal = normalize(NormalMatrix * Normal);
+    const Instance inst = instances[gl_BaseInstance + gl_InstanceID];
+    const mat4 ModelMatrix = inst.modelMatrix;
+    const mat3 NormalMatrix = mat3(inst.normalMatrix);
+
+    vec3 position = Position * inst.positionScale.xyz + inst.positionOffset.xyz;
+    vec3 normal = Normal;
+    vec4 tangent = Tangent;
+    if (inst.positionScale.w > 0.0) {
+        // The tangent's y is remapped to [0, 1] and signed by the bitangent
+        normal = DecodeOctahedral(Normal.xy);
+        tangent.xyz = DecodeOctahedral(vec2(Tangent.x, abs(Tangent.y) * 2.0 - 1.0));
+        tangent.w = Tangent.y < 0.0 ? -1.0 : 1.0;
+    }
+
+    vsOut.position = vec3(ModelMatrix * vec4(position, 1.0));
+    vsOut.normal = normalize(NormalMatrix * normal);
     vsOut.texCoords = TexCoords;
 
-    vec3 T = normalize(vec3(ModelMatrix * vec4(Tangent.xyz, 0.0)));
-    vec3 N = normalize(vec3(ModelMatrix * vec4(Normal, 0.0)));
-    vec3 B = Tangent.w * normalize(cross(N, T));
+    vec3 T = normalize(vec3(ModelMatrix * vec4(tangent.xyz, 0.0)));
+    vec3 N = normalize(vec3(ModelMatrix * vec4(normal, 0.0)));
+    vec3 B = tangent.w * normalize(cross(N, T));
     vsOut.TBN = mat3(T, B, N);
+    vsOut.material = inst.material;
 
     gl_Position = ViewProjMatrix * vec4(vsOut.position, 1.0);
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 using namespace pbr;
 using namespace argparse;
+using namespace std::literals;
 
 CliOptions pbr::ParseArgs(int argc, char* argv[]) {
     ArgumentParser program("pbr-sm", "1.0");
@@ -11,7 +12,8 @@ CliOptions pbr::ParseArgs(int argc, char* argv[]) {
 
     program.add_argument("scene")
         .help("Path to XML file containing the scene description.")
-        .nargs(1);
+        .nargs(nargs_pattern::optional)
+        .default_value(""s);
 
     program.add_argument("--width")
         .help("Demo window width.")
@@ -37,6 +39,90 @@ CliOptions pbr::ParseArgs(int argc, char* argv[]) {
         .default_value(8u)
         .scan<'u', unsigned int>();
 
+    program.add_argument("--upload-budget")
+        .help("Megabytes of streamed texture data uploaded per frame.")
+        .nargs(1)
+        .default_value(32u)
+        .scan<'u', unsigned int>();
+
+    program.add_argument("--mip-filter")
+        .help("Filter for the mip chains generated for textures, kaiser or box.")
+        .nargs(1)
+        .default_value("kaiser"s)
+        .choices("kaiser", "box");
+
+    program.add_argument("--vertex-format")
+        .help("Vertex layout of loaded meshes: full floats, compact with packed normals, "
+              "tangents and uvs, or quantized positions as well.")
+        .nargs(1)
+        .default_value("full"s)
+        .choices("full", "compact", "quantized");
+
+    program.add_argument("--lod-error")
+        .help("Screen space error, in pixels, meshes pick their level of detail by. 0 "
+              "always draws them at full detail.")
+        .nargs(1)
+        .default_value(1.0f)
+        .scan<'g', float>();
+
+    program.add_argument("--trace")
+        .help("Record CPU and GPU frame markers from the start and write them to this "
+              "Chrome trace file on exit.")
+        .nargs(1)
+        .default_value(""s);
+
+    program.add_argument("--capture")
+        .help("Capture every frame, to a directory of PNG files or a raw RGB24 video "
+              "if the path ends in .raw.")
+        .nargs(1)
+        .default_value(""s);
+
+    program.add_argument("--headless")
+        .help("Render offscreen through an EGL context and benchmark the renderer.")
+        .nargs(0)
+        .implicit_value(true)
+        .default_value(false);
+
+    program.add_argument("--camera-path")
+        .help("File with camera keys replayed in headless mode.")
+        .nargs(1)
+        .default_value(""s);
+
+    program.add_argument("--frames")
+        .help("Number of frames rendered in headless mode.")
+        .nargs(1)
+        .default_value(600u)
+        .scan<'u', unsigned int>();
+
+    program.add_argument("--bench-out")
+        .help("CSV file with per frame timings written in headless mode.")
+        .nargs(1)
+        .default_value("benchmark.csv"s);
+
+    program.add_argument("--lights")
+        .help("Scatter this many extra point, spot, sphere and tube lights in the scene.")
+        .nargs(1)
+        .default_value(0u)
+        .scan<'u', unsigned int>();
+
+    program.add_argument("--no-meshlet-culling")
+        .help("Draw large meshes whole instead of culling their meshlets on the GPU.")
+        .nargs(0)
+        .implicit_value(true)
+        .default_value(false);
+
+    program.add_argument("--no-occlusion-culling")
+        .help("Draw every shape in the frustum instead of testing them against the depth "
+              "of the previous frame.")
+        .nargs(0)
+        .implicit_value(true)
+        .default_value(false);
+
+    program.add_argument("--cache-meshes")
+        .help("Build .pbrmesh caches for every OBJ file under a directory and exit.")
+        .nargs(1)
+        .default_value(""s);
+
     program.parse_args(argc, argv);
 
     CliOptions opts;
@@ -45,6 +131,23 @@ CliOptions pbr::ParseArgs(int argc, char* argv[]) {
     opts.height = program.get<int>("--height");
     opts.msaaSamples = program.get<unsigned int>("--msaa");
     opts.multiScattering = !program.get<bool>("--no-ms");
+    opts.headless = program.get<bool>("--headless");
+    opts.cameraPath = program.get("--camera-path");
+    opts.benchFrames = program.get<unsigned int>("--frames");
+    opts.benchOutput = program.get("--bench-out");
+    opts.extraLights = program.get<unsigned int>("--lights");
+    opts.uploadBudgetMB = program.get<unsigned int>("--upload-budget");
+    opts.mipFilter = program.get("--mip-filter");
+    opts.vertexFormat = program.get("--vertex-format");
+    opts.lodError = program.get<float>("--lod-error");
+    opts.meshletCulling = !program.get<bool>("--no-meshlet-culling");
+    opts.occlusionCulling = !program.get<bool>("--no-occlusion-culling");
+    opts.meshCacheDir = program.get("--cache-meshes");
+    opts.traceOutput = program.get("--trace");
+    opts.captureOutput = program.get("--capture");
+
+    if (opts.sceneFile.empty() && opts.meshCacheDir.empty())
+        throw std::runtime_error("No scene file given.\n" + program.help().str());
 
     return opts;
 }
\ No newline at end of file
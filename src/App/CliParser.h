@@ -11,6 +11,24 @@ struct CliOptions {
     unsigned int msaaSamples;
     std::string sceneFile;
     bool multiScattering;
+    unsigned int uploadBudgetMB;
+    std::string mipFilter;
+    std::string vertexFormat;
+    float lodError;
+    bool meshletCulling;
+    bool occlusionCulling;
+    std::string traceOutput;
+    std::string captureOutput;
+
+    // Headless benchmark
+    bool headless;
+    std::string cameraPath;
+    unsigned int benchFrames;
+    std::string benchOutput;
+    unsigned int extraLights;
+
+    // Offline mesh cache generation
+    std::string meshCacheDir;
 };
 
 CliOptions ParseArgs(int argc, char* argv[]);
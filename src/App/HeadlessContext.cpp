@@ -0,0 +1,103 @@
+#include <HeadlessContext.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+using namespace pbr;
+
+namespace {
+
+EGLDisplay GetHeadlessDisplay() {
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+    EGLDisplay dpy = EGL_NO_DISPLAY;
+    if (getPlatformDisplay)
+        dpy = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY,
+                                 nullptr);
+
+    if (dpy == EGL_NO_DISPLAY) {
+        LOGW("Surfaceless EGL platform unavailable. Using default display.");
+        dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    return dpy;
+}
+
+} // namespace
+
+HeadlessContext::~HeadlessContext() {
+    destroy();
+}
+
+void HeadlessContext::create() {
+    EGLDisplay dpy = GetHeadlessDisplay();
+    if (dpy == EGL_NO_DISPLAY)
+        FATAL("Failed to get an EGL display.");
+
+    EGLint major, minor;
+    if (eglInitialize(dpy, &major, &minor) != EGL_TRUE)
+        FATAL("Failed to initialize EGL (0x{:x}).", eglGetError());
+
+    LOGI("EGL Version: {}.{}", major, minor);
+
+    std::string exts = eglQueryString(dpy, EGL_EXTENSIONS);
+    if (exts.find("EGL_KHR_surfaceless_context") == std::string::npos)
+        FATAL("EGL_KHR_surfaceless_context is not supported.");
+
+    if (eglBindAPI(EGL_OPENGL_API) != EGL_TRUE)
+        FATAL("Failed to bind OpenGL API to EGL.");
+
+    // clang-format off
+    const EGLint configAttrs[] = {
+        EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+
+    const EGLint contextAttrs[] = {
+        EGL_CONTEXT_MAJOR_VERSION,       4,
+        EGL_CONTEXT_MINOR_VERSION,       6,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#ifdef DEBUG
+        EGL_CONTEXT_OPENGL_DEBUG,        EGL_TRUE,
+#endif
+        EGL_NONE
+    };
+    // clang-format on
+
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (eglChooseConfig(dpy, configAttrs, &config, 1, &numConfigs) != EGL_TRUE ||
+        numConfigs == 0)
+        FATAL("No suitable EGL config found.");
+
+    EGLContext ctx = eglCreateContext(dpy, config, EGL_NO_CONTEXT, contextAttrs);
+    if (ctx == EGL_NO_CONTEXT)
+        FATAL("Failed to create an OpenGL 4.6 context (0x{:x}). On Mesa, try "
+              "MESA_GL_VERSION_OVERRIDE=4.6 MESA_GLSL_VERSION_OVERRIDE=460.",
+              eglGetError());
+
+    if (eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx) != EGL_TRUE)
+        FATAL("Failed to make EGL context current (0x{:x}).", eglGetError());
+
+    display = dpy;
+    context = ctx;
+}
+
+void HeadlessContext::destroy() {
+    if (display == nullptr)
+        return;
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context != nullptr)
+        eglDestroyContext(display, context);
+    eglTerminate(display);
+
+    display = nullptr;
+    context = nullptr;
+}
+
+void* HeadlessContext::procAddress(const char* name) {
+    return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
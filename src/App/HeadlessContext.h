@@ -0,0 +1,30 @@
+#ifndef PBR_HEADLESSCONTEXT_H
+#define PBR_HEADLESSCONTEXT_H
+
+#include <PBR.h>
+
+namespace pbr {
+
+// Windowless OpenGL 4.6 core context created through EGL. Prefers Mesa's surfaceless
+// platform, so it works on machines without a display server (e.g. llvmpipe).
+class HeadlessContext {
+public:
+    HeadlessContext() = default;
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    void create();
+    void destroy();
+
+    static void* procAddress(const char* name);
+
+private:
+    void* display = nullptr;
+    void* context = nullptr;
+};
+
+} // namespace pbr
+
+#endif
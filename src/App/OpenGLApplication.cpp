@@ -8,6 +8,10 @@
 
 #include <format>
 #include <Utils.h>
+#include <Framebuffer.h>
+#include <HeadlessContext.h>
+#include <Profiler.h>
+#include <PixelConvert.h>
 
 using namespace pbr;
 
@@ -29,11 +33,15 @@ KeyState ActionToKeyState(int action) {
 
 } // namespace
 
-OpenGLApplication::OpenGLApplication(const std::string& title, int width, int height, int msaaSamples)
-    : _title(title), _width(width), _height(height), _msaaSamples(msaaSamples) {
+OpenGLApplication::OpenGLApplication(const std::string& title, int width, int height,
+                                     int msaaSamples, bool headless)
+    : _title(title), _width(width), _height(height), _msaaSamples(msaaSamples),
+      _headless(headless) {
     init();
 }
 
+OpenGLApplication::~OpenGLApplication() = default;
+
 void OpenGLApplication::setCallbacks() {
     using OGLApp = OpenGLApplication;
 
@@ -58,7 +66,7 @@ void OpenGLApplication::setCallbacks() {
     });
 }
 
-void OpenGLApplication::init() {
+void OpenGLApplication::initWindow() {
     glfwSetErrorCallback(
         [](int, const char* desc) { LOG_ERROR("Glfw Error: {}", desc); });
 
@@ -90,6 +98,30 @@ void OpenGLApplication::init() {
         FATAL("Failed to load OpenGL functions.");
 
     glfwSwapInterval(1);
+}
+
+void OpenGLApplication::initHeadless() {
+#ifdef PBR_EGL
+    _headlessCtx = std::make_unique<HeadlessContext>();
+    _headlessCtx->create();
+
+    int glver = gladLoadGLLoader((GLADloadproc)HeadlessContext::procAddress);
+    if (glver == 0)
+        FATAL("Failed to load OpenGL functions.");
+
+    // There is no default framebuffer, so everything goes into an offscreen target
+    _offscreen = std::make_unique<Framebuffer>(_width, _height, _msaaSamples);
+    _offscreen->bind();
+#else
+    FATAL("Headless mode requires a build with EGL support.");
+#endif
+}
+
+void OpenGLApplication::init() {
+    if (_headless)
+        initHeadless();
+    else
+        initWindow();
 
 #ifdef DEBUG
     glEnable(GL_DEBUG_OUTPUT);
@@ -105,26 +137,43 @@ void OpenGLApplication::init() {
     LOGI("OpenGL Renderer: {} ({})", renderer, vendor);
     LOGI("OpenGL Version: {}", version);
     LOGI("GLSL Version {}", glslVer);
+    LOGI("Pixel conversion: {}", PixelKernelsName());
 }
 
 void OpenGLApplication::loop() {
+    if (_headless) {
+        // The context lives until destruction, so GL resources are still released
+        runHeadless();
+        cleanup();
+        return;
+    }
+
     while (!glfwWindowShouldClose(_window)) {
+        Profiler::get().beginFrame();
+
         updateTime();
         render();
 
-        glfwSwapBuffers(_window);
+        {
+            ProfileScope scope{"Present"};
+            glfwSwapBuffers(_window);
+        }
+
+        Profiler::get().endFrame();
         glfwPollEvents();
     }
 
+    // While the context is still current
+    cleanup();
+
     glfwDestroyWindow(_window);
     glfwTerminate();
-
-    cleanup();
 }
 
 void OpenGLApplication::setTitle(const std::string& title) {
     _title = title;
-    glfwSetWindowTitle(_window, _title.c_str());
+    if (_window)
+        glfwSetWindowTitle(_window, _title.c_str());
 }
 
 void OpenGLApplication::reshape(int w, int h) {
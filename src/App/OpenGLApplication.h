@@ -7,6 +7,9 @@ struct GLFWwindow;
 
 namespace pbr {
 
+class HeadlessContext;
+class Framebuffer;
+
 enum class MouseButton : int { Left = 0, Right = 1, Middle = 2 };
 enum class KeyState : int { Released = 0, Pressed = 1, Repeat = 2 };
 consteval bool EnableConversion(MouseButton);
@@ -25,8 +28,9 @@ struct KeyboardState {
 
 class OpenGLApplication {
 public:
-    OpenGLApplication(const std::string& title, int width, int height, int msaaSamples);
-    virtual ~OpenGLApplication() = default;
+    OpenGLApplication(const std::string& title, int width, int height, int msaaSamples,
+                      bool headless = false);
+    virtual ~OpenGLApplication();
 
     void setTitle(const std::string& title);
 
@@ -35,6 +39,9 @@ public:
     virtual void tickPerSecond() = 0;
     virtual void update(float dt) = 0;
 
+    // Drives the application when there is no window, e.g. replaying a benchmark
+    virtual void runHeadless() = 0;
+
     virtual void processKeys(int key, int scancode, int action, int mods);
     virtual void reshape(int w, int h);
     virtual void processMouseClick(int button, int action, int mods);
@@ -44,6 +51,8 @@ public:
     bool isKeyPressed(int key) const;
     bool checkKey(int key, KeyState state) const;
 
+    bool isHeadless() const { return _headless; }
+
     void loop();
 
 protected:
@@ -63,6 +72,8 @@ protected:
 
 private:
     void init();
+    void initWindow();
+    void initHeadless();
     void updateTime();
     void render();
     void updateMouse(double x, double y);
@@ -72,7 +83,11 @@ private:
     double _deltaTime = 0;
     double _secondsTimer = 0;
 
-    GLFWwindow* _window;
+    bool _headless = false;
+
+    GLFWwindow* _window = nullptr;
+    std::unique_ptr<HeadlessContext> _headlessCtx;
+    std::unique_ptr<Framebuffer> _offscreen;
 };
 
 } // namespace pbr
@@ -18,12 +18,19 @@
 #include <SphereLight.h>
 #include <DirectionalLight.h>
 #include <SpotLight.h>
+#include <PointLight.h>
+#include <CameraPath.h>
+#include <GpuTimer.h>
+#include <TextureStreamer.h>
+#include <Profiler.h>
 
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 
 #include <chrono>
 #include <format>
+#include <fstream>
+#include <random>
 
 using namespace pbr;
 using namespace pbr::util;
@@ -38,10 +45,51 @@ const std::unordered_map<LightType, std::string> LightTypeToString{
     {LightType::Tube,        "Tube"       }
 };
 
+// Random local lights over the scene bounds, used to measure how shading scales
+// with the number of lights
+void ScatterLights(Scene& scene, unsigned int count) {
+    std::mt19937 rng{1337};
+    std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+
+    BBox3 bounds = scene.bbox();
+    const float size = bounds.sizes().length();
+    bounds.expand(0.1f * size);
+
+    const Vec3 extent = bounds.sizes();
+    const float range = 0.15f * size;
+
+    for (unsigned int l = 0; l < count; ++l) {
+        const Vec3 pos = bounds.min() + Vec3{unit(rng) * extent.x, unit(rng) * extent.y,
+                                             unit(rng) * extent.z};
+        const Color color{unit(rng), unit(rng), unit(rng)};
+
+        std::shared_ptr<Light> light = nullptr;
+        switch (l % 4) {
+        case 0:
+            light = std::make_shared<PointLight>(color, 1.0f, pos);
+            break;
+        case 1:
+            light = std::make_shared<SpotLight>(color, 1.0f, pos, Radians(30.0f),
+                                                Radians(40.0f));
+            break;
+        case 2:
+            light = std::make_shared<SphereLight>(color, 1.0f, pos, 0.02f * size);
+            break;
+        default:
+            light = std::make_shared<TubeLight>(color, 1.0f, pos, 0.01f * size);
+            break;
+        }
+
+        light->setRange(range);
+        scene.addLight(light);
+    }
 }
 
+} // namespace
+
 PBRApp::PBRApp(const std::string& title, const CliOptions& opts)
-    : OpenGLApplication(title, opts.width, opts.height, opts.msaaSamples) {
+    : OpenGLApplication(title, opts.width, opts.height, opts.msaaSamples, opts.headless),
+      _opts(opts) {
     prepare(opts);
 }
 
@@ -49,6 +97,10 @@ void PBRApp::prepare(const CliOptions& opts) {
     Print("Initializing renderer");
 
     RHI.initialize();
+    RHI.pbrPrograms().setGlobalFeatures(
+        opts.multiScattering ? ToUnderlying(PBRFeature::MultiScattering) : 0,
+        ToUnderlying(PBRFeature::MultiScattering));
+
     GuiInit(_width, _height);
 
     // Initialize renderer
@@ -59,8 +111,30 @@ void PBRApp::prepare(const CliOptions& opts) {
 
     Print("Loading scene");
 
+    TextureStreamer::get().setUploadBudget(std::size_t{opts.uploadBudgetMB} << 20);
+    TextureStreamer::get().setMipFilter(opts.mipFilter == "box" ? MipFilter::Box
+                                                                : MipFilter::Kaiser);
+
+    if (opts.vertexFormat == "compact")
+        RHI.setMeshVertexFormat(VertexFormat::Compact);
+    else if (opts.vertexFormat == "quantized")
+        RHI.setMeshVertexFormat(VertexFormat::Quantized);
+
+    _renderer.setLodError(opts.lodError);
+    _renderer.setMeshletCulling(opts.meshletCulling);
+    _renderer.setOcclusionCulling(opts.occlusionCulling);
+
+    // Headless runs only trace the measured frames
+    if (!opts.traceOutput.empty() && !opts.headless)
+        Profiler::get().setTracing(true);
+
+    if (!opts.captureOutput.empty())
+        _capture.startSequence(opts.captureOutput);
+
     SceneLoader loader{};
     _scene = std::move(*loader.parse(opts.sceneFile));
+    if (opts.extraLights > 0)
+        ScatterLights(_scene, opts.extraLights);
     _skyboxes = loader.getSkyboxes();
     for (const auto& sky : _skyboxes)
         _skyboxOpts.append(sky.name() + '\0');
@@ -91,14 +165,128 @@ void PBRApp::reshape(int w, int h) {
 void PBRApp::tickPerSecond() {
     _fps = _frameCount;
     _frameCount = 0;
+
+    _workerStats = JobSystem::get().stats();
+    JobSystem::get().resetStats();
+
+    _timings = Profiler::get().stats();
+}
+
+void PBRApp::runHeadless() {
+    using namespace std::chrono;
+
+    std::optional<CameraPath> path;
+    if (!_opts.cameraPath.empty()) {
+        path = LoadCameraPath(_opts.cameraPath);
+        if (!path)
+            FATAL("Unable to load camera path {}.", _opts.cameraPath);
+    }
+
+    // Only the renderer is measured
+    _showGUI = false;
+    TextureStreamer::get().finish();
+
+    // Untimed frame, so the shader variants the scene needs are compiled beforehand
+    update(0.0f);
+    renderScene();
+    glFinish();
+
+    const unsigned int numFrames = _opts.benchFrames;
+    GpuTimer gpuTimer{numFrames};
+    std::vector<double> cpuMs(numFrames);
+
+    Print("Rendering {} frames", numFrames);
+    JobSystem::get().resetStats();
+
+    auto& profiler = Profiler::get();
+    if (!_opts.traceOutput.empty())
+        profiler.setTracing(true);
+
+    for (unsigned int f = 0; f < numFrames; ++f) {
+        if (path) {
+            const float t = numFrames > 1 ? static_cast<float>(f) / (numFrames - 1) : 0;
+            auto key = path->sample(path->startTime() + t * path->duration());
+            _camera->lookAt(key.eye, key.at, key.up);
+        }
+
+        const auto start = high_resolution_clock::now();
+        profiler.beginFrame();
+
+        update(0.0f);
+
+        gpuTimer.begin(f);
+        renderScene();
+        gpuTimer.end();
+
+        profiler.endFrame();
+        glFlush();
+
+        cpuMs[f] = duration<double, std::milli>(high_resolution_clock::now() - start).count();
+    }
+
+    // Queries are only resolved once every frame has been submitted
+    glFinish();
+    profiler.flush();
+
+    const auto workerStats = JobSystem::get().stats();
+    for (std::size_t w = 0; w < workerStats.size(); ++w)
+        Print("Job thread {}: {:.1f}% busy, {} jobs, {} stolen", w,
+              100.0f * workerStats[w].utilization, workerStats[w].jobs,
+              workerStats[w].steals);
+
+    Print("Last {} frames, min / avg / p99 ms:", Profiler::HistorySize);
+    for (const auto& ms : profiler.stats())
+        Print("{:>{}}{:<20} CPU {:.3f} / {:.3f} / {:.3f}  GPU {:.3f} / {:.3f} / {:.3f}",
+              "", 2 * ms.depth, ms.name, ms.cpuMin, ms.cpuAvg, ms.cpuP99, ms.gpuMin,
+              ms.gpuAvg, ms.gpuP99);
+
+    std::vector<double> gpuMs(numFrames);
+    for (unsigned int f = 0; f < numFrames; ++f)
+        gpuMs[f] = gpuTimer.elapsedMs(f);
+
+    writeBenchmark(cpuMs, gpuMs);
+}
+
+void PBRApp::writeBenchmark(std::span<const double> cpuMs, std::span<const double> gpuMs) {
+    std::ofstream file(_opts.benchOutput);
+    if (file.fail())
+        FATAL("Couldn't open benchmark output {}.", _opts.benchOutput);
+
+    file << "frame,cpu_ms,gpu_ms\n";
+    for (std::size_t f = 0; f < cpuMs.size(); ++f)
+        file << std::format("{},{:.4f},{:.4f}\n", f, cpuMs[f], gpuMs[f]);
+
+    auto avg = [](std::span<const double> vals) {
+        double sum = 0;
+        for (double v : vals)
+            sum += v;
+        return vals.empty() ? 0.0 : sum / vals.size();
+    };
+
+    Print("Average frame time: {:.3f} ms CPU, {:.3f} ms GPU", avg(cpuMs), avg(gpuMs));
+    Print("Timings written to {}", _opts.benchOutput);
 }
 
 void PBRApp::renderScene() {
-    _scene.sortShapes(_camera->position());
+    {
+        ProfileScope scope{"Texture uploads"};
+        TextureStreamer::get().update();
+    }
+
+    {
+        ProfileScope scope{"Transforms"};
+        _scene.updateTransforms();
+    }
+
     _renderer.render(_scene, *_camera);
 
-    if (_showGUI)
+    if (_showGUI) {
+        ProfileScope scope{"GUI"};
         drawInterface();
+    }
+
+    ProfileScope scope{"Capture"};
+    _capture.update(_width, _height);
 }
 
 void PBRApp::restoreToneDefaults() {
@@ -144,7 +332,16 @@ void PBRApp::update(float dt) {
     _renderer.setEnvIntensity(_envIntensity);
 }
 
-void PBRApp::cleanup() {}
+void PBRApp::cleanup() {
+    _capture.finish();
+
+    // Frames still in flight are left out, the context may already be gone
+    auto& profiler = Profiler::get();
+    if (profiler.tracing() && !_opts.traceOutput.empty()) {
+        profiler.setTracing(false);
+        profiler.writeTrace(_opts.traceOutput);
+    }
+}
 
 void PBRApp::processKeys(int key, int scancode, int action, int mods) {
     OpenGLApplication::processKeys(key, scancode, action, mods);
@@ -153,6 +350,8 @@ void PBRApp::processKeys(int key, int scancode, int action, int mods) {
         _showGUI = !_showGUI;
     else if (checkKey('P', KeyState::Pressed))
         takeSnapshot();
+    else if (checkKey('C', KeyState::Pressed))
+        toggleCapture();
 
     if (checkKey('1', KeyState::Pressed))
         changeSkybox(0);
@@ -175,10 +374,19 @@ void PBRApp::updateMaterial(Material* mat) {
     _matParams.clearCoatRough = _selMat->clearCoatRough();
 }
 
-void PBRApp::pickObject(int x, int y) {
+std::optional<SceneHit> PBRApp::pickObject(int x, int y) {
     Ray ray = _camera->traceRay(Vec2(x, y));
-    if (auto shape = _scene.intersect(ray))
-        updateMaterial(shape.value()->material().get());
+
+    auto sceneHit = _scene.intersect(ray);
+    if (sceneHit) {
+        const TriangleHit& hit = sceneHit->hit;
+        LOGI("Picked triangle {} at t = {} (barycentrics {}, {})", hit.triangle, hit.t,
+             hit.barycentrics.x, hit.barycentrics.y);
+
+        updateMaterial(sceneHit->shape->material().get());
+    }
+
+    return sceneHit;
 }
 
 void PBRApp::processMouseClick(int button, int action, int mods) {
@@ -286,13 +494,68 @@ void PBRApp::renderMaterialsInterface() {
     ImGui::End();
 }
 
+void PBRApp::renderProfilerInterface() {
+    ImGui::SetNextWindowPos({497, 191}, ImGuiCond_Once);
+    ImGui::SetNextWindowSize({560, 220}, ImGuiCond_Once);
+
+    ImGui::Begin("Frame timings");
+    ImGui::Text("Last %zu frames, min / avg / p99 ms", Profiler::HistorySize);
+    ImGui::Separator();
+
+    for (const auto& ms : _timings) {
+        const int indent = 2 * static_cast<int>(ms.depth);
+        ImGui::Text("%*s%-*s CPU %6.3f %6.3f %6.3f   GPU %6.3f %6.3f %6.3f", indent, "",
+                    18 - indent, ms.name.c_str(), ms.cpuMin, ms.cpuAvg, ms.cpuP99,
+                    ms.gpuMin, ms.gpuAvg, ms.gpuP99);
+    }
+
+    ImGui::Separator();
+    if (ImGui::Button(Profiler::get().tracing() ? "Save trace" : "Record trace"))
+        toggleTrace();
+
+    ImGui::End();
+}
+
+void PBRApp::toggleTrace() {
+    auto& profiler = Profiler::get();
+    if (!profiler.tracing()) {
+        profiler.setTracing(true);
+        return;
+    }
+
+    profiler.setTracing(false);
+    profiler.writeTrace(_opts.traceOutput.empty() ? "trace.json" : _opts.traceOutput);
+}
+
 void PBRApp::drawInterface() {
     GuiBeginFrame(_mouse.x, _mouse.y, _mouse.buttons);
 
     ImGui::SetNextWindowPos({10, 10}, ImGuiCond_Once);
-    ImGui::SetNextWindowSize({477, 124}, ImGuiCond_Once);
+    ImGui::SetNextWindowSize({477, 156}, ImGuiCond_Once);
     ImGui::Begin("Environment");
     ImGui::Text("%g fps", _fps);
+
+    const auto& stats = _renderer.drawStats();
+    const auto& cull = _renderer.cullStats();
+    ImGui::Text("%u shapes in %u draws, %u program / %u texture / %u vao binds",
+                stats.instances, stats.draws, stats.programBinds, stats.textureBinds,
+                stats.vaoBinds);
+    ImGui::Text("%u of %u shapes culled, %u triangles", cull.culled, cull.tested,
+                stats.triangles);
+    ImGui::Text("%u meshlets tested on the GPU in %u draws", stats.meshletsTested,
+                stats.meshletDraws);
+    ImGui::Text("%u shapes tested for occlusion", stats.occlusionTested);
+
+    if (ImGui::CollapsingHeader("Job threads")) {
+        // Thread 0 is the main thread, it runs jobs while waiting on them
+        for (std::size_t w = 0; w < _workerStats.size(); ++w) {
+            const auto& ws = _workerStats[w];
+            ImGui::Text("%zu: %5.1f%% busy, %llu jobs, %llu stolen", w,
+                        100.0f * ws.utilization, static_cast<unsigned long long>(ws.jobs),
+                        static_cast<unsigned long long>(ws.steals));
+        }
+    }
+
     ImGui::Checkbox("Draw Skybox", &_showSky);
     ImGui::SliderFloat("Env Intensity", &_envIntensity, 0.0f, 1.0f);
 
@@ -362,6 +625,7 @@ void PBRApp::drawInterface() {
     ImGui::TextWrapped("WASD - Camera movement.");
     ImGui::TextWrapped("H - Toggle GUI visibility.");
     ImGui::TextWrapped("P - Take a snapshot.");
+    ImGui::TextWrapped("C - Start or stop capturing every frame.");
     ImGui::End();
 
     // Selected object window
@@ -372,6 +636,8 @@ void PBRApp::drawInterface() {
     if (_scene.lights().size() > 0)
         renderLightsInterface();
 
+    renderProfilerInterface();
+
     ImGui::Render();
 }
 
@@ -385,7 +651,13 @@ void PBRApp::takeSnapshot() {
     auto now = system_clock::now();
     auto timestamp = duration_cast<seconds>(now.time_since_epoch()).count();
 
-    auto img = ReadMainFramebuffer(0, 0, _width, _height);
-    img.flipY();
-    SaveImage(std::format("snapshot_{}.png", timestamp), img);
+    _capture.snapshot(std::format("snapshot_{}.png", timestamp));
+}
+
+void PBRApp::toggleCapture() {
+    if (_capture.recording())
+        _capture.stopSequence();
+    else
+        _capture.startSequence(_opts.captureOutput.empty() ? "capture"
+                                                           : _opts.captureOutput);
 }
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include <OpenGLApplication.h>
 
 #include <CliParser.h>
+#include <FrameCapture.h>
+#include <JobSystem.h>
+#include <Profiler.h>
 #include <Scene.h>
 #include <Renderer.h>
 #include <Skybox.h>
@@ -25,6 +28,7 @@ public:
     void cleanup() override;
 
     void tickPerSecond() override;
+    void runHeadless() override;
     void processMouseClick(int button, int action, int mods) override;
     void processKeys(int key, int scancode, int action, int mods) override;
     void reshape(int w, int h) override;
@@ -35,12 +39,16 @@ private:
     void restoreToneDefaults();
     void changeSkybox(int id);
     void takeSnapshot();
-    void pickObject(int x, int y);
+    void toggleCapture();
+    std::optional<SceneHit> pickObject(int x, int y);
     void updateMaterial(Material* mat);
     void changeToneMap(ToneMap toneMap);
     void changeLight(Light* light);
     void renderMaterialsInterface();
     void renderLightsInterface();
+    void renderProfilerInterface();
+    void toggleTrace();
+    void writeBenchmark(std::span<const double> cpuMs, std::span<const double> gpuMs);
 
     struct MaterialGuiParams {
         Color diffuse;
@@ -69,8 +77,11 @@ private:
         bool on;
     };
 
+    CliOptions _opts;
+
     Scene _scene;
     Renderer _renderer;
+    FrameCapture _capture;
 
     Camera* _camera = nullptr;
     PBRMaterial* _selMat = nullptr;
@@ -86,6 +97,8 @@ private:
     int _skybox = 0;
 
     double _fps = 0;
+    std::vector<WorkerStats> _workerStats;
+    std::vector<MarkerStats> _timings;
     bool _showGUI = true;
     bool _showSky = true;
     float _envIntensity = 1.0f;
@@ -0,0 +1,155 @@
+#include <BVH.h>
+
+#include <numeric>
+
+using namespace pbr;
+
+namespace {
+
+constexpr std::size_t NumBins = 12;
+constexpr std::uint32_t MaxLeafPrims = 4;
+
+// Past this depth nodes are split at the median, which bounds the traversal stack
+constexpr unsigned int MaxSAHDepth = 32;
+
+// Cost of visiting a node relative to testing a primitive
+constexpr float TraversalCost = 0.5f;
+
+const BBox3 EmptyBox{Vec3{FLOAT_INFINITY}, Vec3{-FLOAT_INFINITY}};
+
+struct Bin {
+    BBox3 bounds = EmptyBox;
+    std::uint32_t count = 0;
+};
+
+} // namespace
+
+void BVH::build(std::span<const BBox3> primBounds) {
+    _nodes.clear();
+    _prims.resize(primBounds.size());
+    std::iota(_prims.begin(), _prims.end(), 0);
+
+    if (primBounds.empty())
+        return;
+
+    std::vector<Vec3> centroids(primBounds.size());
+    std::transform(primBounds.begin(), primBounds.end(), centroids.begin(),
+                   [](const BBox3& box) { return box.center(); });
+
+    _nodes.reserve(2 * primBounds.size());
+    buildNode(primBounds, centroids, 0, primBounds.size(), 0);
+}
+
+std::uint32_t BVH::buildNode(std::span<const BBox3> primBounds,
+                             std::span<const Vec3> centroids, std::uint32_t begin,
+                             std::uint32_t end, unsigned int depth) {
+    const std::uint32_t index = _nodes.size();
+    _nodes.emplace_back();
+
+    BBox3 bounds = EmptyBox;
+    BBox3 centroidBounds = EmptyBox;
+    for (std::uint32_t i = begin; i < end; ++i) {
+        bounds.expand(primBounds[_prims[i]]);
+        centroidBounds.expand(centroids[_prims[i]]);
+    }
+
+    const std::uint32_t numPrims = end - begin;
+    const unsigned int axis = centroidBounds.sizes().maxDim();
+    const float cMin = centroidBounds.min()[axis];
+    const float cExtent = centroidBounds.max()[axis] - cMin;
+
+    auto makeLeaf = [&]() {
+        _nodes[index] = {bounds, begin, static_cast<std::uint16_t>(numPrims), 0};
+        return index;
+    };
+
+    // Coincident centroids can't be split
+    if (numPrims <= 1 || cExtent <= 0.0f) {
+        if (numPrims <= std::numeric_limits<std::uint16_t>::max())
+            return makeLeaf();
+    }
+
+    std::uint32_t mid = begin;
+    if (cExtent > 0.0f && depth < MaxSAHDepth) {
+        auto binIndex = [&](std::uint32_t prim) {
+            const float t = (centroids[prim][axis] - cMin) / cExtent;
+            return std::min(static_cast<std::size_t>(t * NumBins), NumBins - 1);
+        };
+
+        std::array<Bin, NumBins> bins;
+        for (std::uint32_t i = begin; i < end; ++i) {
+            Bin& bin = bins[binIndex(_prims[i])];
+            bin.bounds.expand(primBounds[_prims[i]]);
+            ++bin.count;
+        }
+
+        // Sweep from the right to get the area and count above each split plane
+        std::array<float, NumBins - 1> rightArea;
+        std::array<std::uint32_t, NumBins - 1> rightCount;
+        BBox3 right = EmptyBox;
+        std::uint32_t count = 0;
+        for (std::size_t b = NumBins - 1; b > 0; --b) {
+            right.expand(bins[b].bounds);
+            count += bins[b].count;
+            rightArea[b - 1] = count > 0 ? right.area() : 0.0f;
+            rightCount[b - 1] = count;
+        }
+
+        float bestCost = FLOAT_INFINITY;
+        std::size_t bestSplit = 0;
+        BBox3 left = EmptyBox;
+        count = 0;
+        for (std::size_t b = 0; b < NumBins - 1; ++b) {
+            left.expand(bins[b].bounds);
+            count += bins[b].count;
+            const float leftArea = count > 0 ? left.area() : 0.0f;
+            const float cost = count * leftArea + rightCount[b] * rightArea[b];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = b;
+            }
+        }
+
+        const float leafCost = numPrims;
+        const float splitCost = TraversalCost + bestCost / bounds.area();
+        if (numPrims <= MaxLeafPrims && leafCost <= splitCost)
+            return makeLeaf();
+
+        auto it = std::partition(_prims.begin() + begin, _prims.begin() + end,
+                                 [&](std::uint32_t prim) {
+                                     return binIndex(prim) <= bestSplit;
+                                 });
+        mid = std::distance(_prims.begin(), it);
+    }
+
+    // Degenerate partition, fall back to an even split along the axis
+    if (mid == begin || mid == end) {
+        mid = begin + numPrims / 2;
+        std::nth_element(_prims.begin() + begin, _prims.begin() + mid,
+                         _prims.begin() + end, [&](std::uint32_t a, std::uint32_t b) {
+                             return centroids[a][axis] < centroids[b][axis];
+                         });
+    }
+
+    buildNode(primBounds, centroids, begin, mid, depth + 1);
+    const std::uint32_t second = buildNode(primBounds, centroids, mid, end, depth + 1);
+
+    _nodes[index] = {bounds, second, 0, static_cast<std::uint8_t>(axis)};
+    return index;
+}
+
+void BVH::refit(std::span<const BBox3> primBounds) {
+    DCHECK_EQ(primBounds.size(), _prims.size());
+
+    // Children always come after their parent
+    for (std::size_t n = _nodes.size(); n-- > 0;) {
+        BVHNode& node = _nodes[n];
+        if (node.count > 0) {
+            node.bounds = EmptyBox;
+            for (std::uint32_t p = 0; p < node.count; ++p)
+                node.bounds.expand(primBounds[_prims[node.offset + p]]);
+        } else {
+            node.bounds = Expand(_nodes[n + 1].bounds, _nodes[node.offset].bounds);
+        }
+    }
+}
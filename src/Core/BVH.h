@@ -0,0 +1,91 @@
+#ifndef PBR_BVH_H
+#define PBR_BVH_H
+
+#include <PBR.h>
+#include <BBox.h>
+#include <Ray.h>
+
+#include <span>
+
+using namespace pbr::math;
+
+namespace pbr {
+
+struct BVHNode {
+    BBox3 bounds;
+    std::uint32_t offset; // First primitive for leaves, second child for interior nodes
+    std::uint16_t count;  // Number of primitives, 0 for interior nodes
+    std::uint8_t axis;
+};
+
+// Bounding volume hierarchy over abstract primitives, built with the binned surface
+// area heuristic. Nodes are stored depth first: the first child of an interior node
+// follows it, so refitting is a single reverse pass.
+class BVH {
+public:
+    void build(std::span<const BBox3> primBounds);
+    void refit(std::span<const BBox3> primBounds);
+
+    bool empty() const { return _nodes.empty(); }
+    std::size_t numNodes() const { return _nodes.size(); }
+
+    // Visits primitives whose node boxes the ray hits, nearest child first.
+    // intersect(prim, tMax) returns the hit distance, which then shortens the ray.
+    template<typename Func>
+    bool traverse(const Ray& ray, float& tMax, Func&& intersect) const;
+
+private:
+    std::uint32_t buildNode(std::span<const BBox3> primBounds,
+                            std::span<const Vec3> centroids, std::uint32_t begin,
+                            std::uint32_t end, unsigned int depth);
+
+    std::vector<BVHNode> _nodes;
+    std::vector<std::uint32_t> _prims;
+};
+
+template<typename Func>
+bool BVH::traverse(const Ray& ray, float& tMax, Func&& intersect) const {
+    if (_nodes.empty())
+        return false;
+
+    const Vec3& dir = ray.direction();
+    const std::array<bool, 3> dirNeg{dir.x < 0, dir.y < 0, dir.z < 0};
+
+    bool hit = false;
+
+    std::array<std::uint32_t, 64> stack;
+    std::size_t stackSize = 0;
+    std::uint32_t current = 0;
+
+    while (true) {
+        const BVHNode& node = _nodes[current];
+        if (node.bounds.intersectRay(ray, tMax)) {
+            if (node.count > 0) {
+                for (std::uint32_t p = 0; p < node.count; ++p) {
+                    if (auto t = intersect(_prims[node.offset + p], tMax)) {
+                        tMax = *t;
+                        hit = true;
+                    }
+                }
+            } else if (dirNeg[node.axis]) {
+                stack[stackSize++] = current + 1;
+                current = node.offset;
+                continue;
+            } else {
+                stack[stackSize++] = node.offset;
+                current = current + 1;
+                continue;
+            }
+        }
+
+        if (stackSize == 0)
+            break;
+        current = stack[--stackSize];
+    }
+
+    return hit;
+}
+
+} // namespace pbr
+
+#endif
@@ -0,0 +1,99 @@
+#include <CameraPath.h>
+
+#include <Utils.h>
+
+#include <sstream>
+
+using namespace pbr;
+using namespace pbr::math;
+
+namespace {
+
+Vec3 LerpVec(float t, const Vec3& v1, const Vec3& v2) {
+    return (1.0f - t) * v1 + t * v2;
+}
+
+} // namespace
+
+void CameraPath::addKey(const CameraKey& key) {
+    auto it = std::upper_bound(
+        _keys.begin(), _keys.end(), key.time,
+        [](float time, const CameraKey& other) { return time < other.time; });
+    _keys.insert(it, key);
+}
+
+float CameraPath::startTime() const {
+    if (_keys.empty())
+        return 0;
+    return _keys.front().time;
+}
+
+float CameraPath::duration() const {
+    if (_keys.empty())
+        return 0;
+    return _keys.back().time - _keys.front().time;
+}
+
+CameraKey CameraPath::sample(float time) const {
+    DCHECK(!_keys.empty());
+
+    if (time <= _keys.front().time)
+        return _keys.front();
+    if (time >= _keys.back().time)
+        return _keys.back();
+
+    auto next = std::upper_bound(
+        _keys.begin(), _keys.end(), time,
+        [](float t, const CameraKey& key) { return t < key.time; });
+    auto prev = next - 1;
+
+    const float span = next->time - prev->time;
+    const float t = span > 0 ? (time - prev->time) / span : 0.0f;
+
+    return {.time = time,
+            .eye = LerpVec(t, prev->eye, next->eye),
+            .at = LerpVec(t, prev->at, next->at),
+            .up = Normalize(LerpVec(t, prev->up, next->up))};
+}
+
+std::optional<CameraPath> pbr::LoadCameraPath(const fs::path& filePath) {
+    auto source = util::ReadTextFile(filePath);
+    if (!source.has_value()) {
+        LOG_ERROR("Couldn't open camera path {}.", filePath.string());
+        return std::nullopt;
+    }
+
+    CameraPath path;
+
+    std::istringstream file(*source);
+    std::string line;
+    int lineNum = 0;
+    while (std::getline(file, line)) {
+        ++lineNum;
+
+        auto start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#')
+            continue;
+
+        CameraKey key;
+        std::istringstream ss(line);
+        ss >> key.time >> key.eye >> key.at;
+        if (ss.fail()) {
+            LOG_ERROR("Malformed camera key at {}:{}.", filePath.string(), lineNum);
+            return std::nullopt;
+        }
+
+        Vec3 up;
+        if (ss >> up)
+            key.up = up;
+
+        path.addKey(key);
+    }
+
+    if (path.empty()) {
+        LOG_ERROR("Camera path {} has no keys.", filePath.string());
+        return std::nullopt;
+    }
+
+    return path;
+}
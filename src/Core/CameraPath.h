@@ -0,0 +1,44 @@
+#ifndef PBR_CAMERAPATH_H
+#define PBR_CAMERAPATH_H
+
+#include <PBR.h>
+#include <PBRMath.h>
+
+#include <filesystem>
+#include <optional>
+
+using namespace pbr::math;
+namespace fs = std::filesystem;
+
+namespace pbr {
+
+struct CameraKey {
+    float time = 0;
+    Vec3 eye{0};
+    Vec3 at{0, 0, -1};
+    Vec3 up{0, 1, 0};
+};
+
+// Piecewise linear camera path
+class CameraPath {
+public:
+    void addKey(const CameraKey& key);
+
+    CameraKey sample(float time) const;
+
+    float startTime() const;
+    float duration() const;
+
+    bool empty() const { return _keys.empty(); }
+
+private:
+    std::vector<CameraKey> _keys;
+};
+
+// Text file with one key per line: "time eye.xyz at.xyz [up.xyz]". Lines starting
+// with '#' are ignored.
+std::optional<CameraPath> LoadCameraPath(const fs::path& filePath);
+
+} // namespace pbr
+
+#endif
@@ -26,27 +26,127 @@ struct hash<Vertex> {
 
 } // namespace std
 
-Geometry::Geometry(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices) {
+namespace {
+
+// Smaller geometries cost more to cull in pieces than to draw whole
+constexpr unsigned int MeshletMinTriangles = 4096;
+
+// Per corner tangents written by MikkTSpace, at face * 3 + vertex
+struct TangentContext {
+    Geometry* geometry;
+    std::vector<Vec4> tangents;
+};
+
+} // namespace
+
+Geometry::Geometry(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices,
+                   bool uploadNow) {
     _vertices = std::move(vertices);
     _indices = std::move(indices);
 
     computeTangents();
     removeRedundantVerts();
-    upload();
+
+    if (uploadNow)
+        upload();
 }
 
-void Geometry::upload() {
+Geometry::Geometry(std::span<const Vertex> vertices, std::span<const unsigned int> indices,
+                   std::span<const MeshLod> lods, const BBox3& bbox, bool uploadNow)
+    : _vertices(vertices.begin(), vertices.end()), _indices(indices.begin(), indices.end()),
+      _lods(lods.begin(), lods.end()), _bbox(bbox) {
+    if (uploadNow) {
+        _varrays = CreateVertexArrays(vertices, indices, _format, _bbox);
+        uploadMeshlets();
+    }
+}
+
+void Geometry::upload(VertexFormat format) {
     if (!isUploaded()) {
+        _format = format;
         _varrays = CreateVertexArrays(*this);
+        uploadMeshlets();
     }
 }
 
+void Geometry::uploadMeshlets() {
+    const MeshLod full = lod(0);
+    if (full.numIndices / 3 < MeshletMinTriangles)
+        return;
+
+    std::span<const unsigned int> fullIndices{_indices.data() + full.firstIndex,
+                                              full.numIndices};
+    _meshlets = BuildMeshlets(_vertices, fullIndices, full.firstIndex);
+    _meshletBuffer = std::make_unique<Buffer>(BufferType::ShaderStorage,
+                                              _meshlets.size() * sizeof(Meshlet),
+                                              BufferFlag::None, _meshlets.data());
+}
+
+void Geometry::bindMeshlets(unsigned int index) const {
+    DCHECK(hasMeshlets());
+    _meshletBuffer->bindRange(index, 0, _meshlets.size() * sizeof(Meshlet));
+}
+
+MeshOptimizeStats Geometry::optimize(const MeshOptimizeOptions& options) {
+    DCHECK(!isUploaded());
+    DCHECK(_lods.empty());
+
+    _bvh = nullptr;
+    return OptimizeMesh(_vertices, _indices, options);
+}
+
+void Geometry::buildLods(const LodOptions& options) {
+    DCHECK(!isUploaded());
+    DCHECK(_lods.empty());
+
+    _lods = BuildLodChain(_vertices, _indices, options);
+    if (_lods.size() == 1)
+        _lods.clear();
+}
+
+MeshLod Geometry::lod(unsigned int level) const {
+    if (_lods.empty())
+        return {.firstIndex = 0,
+                .numIndices = static_cast<std::uint32_t>(_indices.size()),
+                .error = 0.0f};
+
+    return _lods[level];
+}
+
 void Geometry::draw() const {
-    _varrays->draw();
+    if (_lods.empty()) {
+        _varrays->draw();
+        return;
+    }
+
+    bind();
+    submit();
+    glBindVertexArray(0);
+}
+
+void Geometry::bind() const {
+    _varrays->bind();
+}
+
+void Geometry::submit(unsigned int numInstances, unsigned int baseInstance,
+                      unsigned int level) const {
+    if (_lods.empty()) {
+        _varrays->submit(numInstances, baseInstance);
+        return;
+    }
+
+    const MeshLod& range = _lods[level];
+    _varrays->submit(range.firstIndex, range.numIndices, numInstances, baseInstance);
+}
+
+void Geometry::submitIndirect(std::size_t commandOffset, std::size_t countOffset,
+                              unsigned int maxDraws) const {
+    _varrays->submitIndirect(commandOffset, countOffset, maxDraws);
 }
 
 void Geometry::addVertex(const Vertex& vertex) {
     _vertices.push_back(vertex);
+    _bbox.expand(vertex.position);
 }
 
 void Geometry::addIndex(unsigned int idx) {
@@ -72,21 +172,67 @@ const std::vector<unsigned int>& Geometry::indices() const {
     return _indices;
 }
 
-BBox3 Geometry::bbox() const {
-    BBox3 bbox{{FLOAT_INFINITY}, {-FLOAT_INFINITY}};
-    for (const Vertex& v : _vertices)
-        bbox.expand(v.position);
-    return bbox;
+const BBox3& Geometry::bbox() const {
+    return _bbox;
 }
 
 BSphere Geometry::bSphere() const {
-    const BBox3 box = bbox();
-    return box.sphere();
+    return _bbox.sphere();
+}
+
+std::optional<TriangleHit> Geometry::intersect(const Ray& ray, float tMax) const {
+    if (!_bvh) {
+        // Only the full detail level is traced
+        std::vector<BBox3> triBounds(lod(0).numIndices / 3);
+        for (std::size_t f = 0; f < triBounds.size(); ++f) {
+            triBounds[f] = BBox3{getVertex(f, 0).position};
+            triBounds[f].expand(getVertex(f, 1).position);
+            triBounds[f].expand(getVertex(f, 2).position);
+        }
+
+        _bvh = std::make_unique<BVH>();
+        _bvh->build(triBounds);
+    }
+
+    std::optional<TriangleHit> hit = std::nullopt;
+
+    // Moller-Trumbore, two sided
+    auto intersectTri = [&](std::uint32_t f, float tMax) -> std::optional<float> {
+        const Vec3& p0 = getVertex(f, 0).position;
+        const Vec3 e1 = getVertex(f, 1).position - p0;
+        const Vec3 e2 = getVertex(f, 2).position - p0;
+
+        const Vec3 pv = Cross(ray.direction(), e2);
+        const float det = Dot(e1, pv);
+        if (det == 0.0f)
+            return std::nullopt;
+
+        const float invDet = 1.0f / det;
+        const Vec3 tv = ray.origin() - p0;
+        const float u = Dot(tv, pv) * invDet;
+        if (u < 0.0f || u > 1.0f)
+            return std::nullopt;
+
+        const Vec3 qv = Cross(tv, e1);
+        const float v = Dot(ray.direction(), qv) * invDet;
+        if (v < 0.0f || u + v > 1.0f)
+            return std::nullopt;
+
+        const float t = Dot(e2, qv) * invDet;
+        if (t < ray.tMin() || t > tMax)
+            return std::nullopt;
+
+        hit = TriangleHit{t, f, {u, v}};
+        return t;
+    };
+
+    _bvh->traverse(ray, tMax, intersectTri);
+    return hit;
 }
 
 void Geometry::computeTangents() {
     auto getNumFaces = [](const SMikkTSpaceContext* pContext) -> int {
-        auto ptr = static_cast<Geometry*>(pContext->m_pUserData);
+        auto ptr = static_cast<TangentContext*>(pContext->m_pUserData)->geometry;
         return ptr->getNumFaces();
     };
 
@@ -94,7 +240,7 @@ void Geometry::computeTangents() {
 
     auto getPosition = [](const SMikkTSpaceContext* pContext, float fvPosOut[],
                           const int iFace, const int iVert) {
-        auto ptr = static_cast<Geometry*>(pContext->m_pUserData);
+        auto ptr = static_cast<TangentContext*>(pContext->m_pUserData)->geometry;
         auto& vertex = ptr->getVertex(iFace, iVert);
         fvPosOut[0] = vertex.position.x;
         fvPosOut[1] = vertex.position.y;
@@ -103,7 +249,7 @@ void Geometry::computeTangents() {
 
     auto getNormal = [](const SMikkTSpaceContext* pContext, float fvNormOut[],
                         const int iFace, const int iVert) {
-        auto ptr = static_cast<Geometry*>(pContext->m_pUserData);
+        auto ptr = static_cast<TangentContext*>(pContext->m_pUserData)->geometry;
         auto& vertex = ptr->getVertex(iFace, iVert);
         fvNormOut[0] = vertex.normal.x;
         fvNormOut[1] = vertex.normal.y;
@@ -112,7 +258,7 @@ void Geometry::computeTangents() {
 
     auto getTexCoord = [](const SMikkTSpaceContext* pContext, float fvTexcOut[],
                           const int iFace, const int iVert) {
-        auto ptr = static_cast<Geometry*>(pContext->m_pUserData);
+        auto ptr = static_cast<TangentContext*>(pContext->m_pUserData)->geometry;
         auto& vertex = ptr->getVertex(iFace, iVert);
         fvTexcOut[0] = vertex.uv.x;
         fvTexcOut[1] = vertex.uv.y;
@@ -120,9 +266,9 @@ void Geometry::computeTangents() {
 
     auto setTSpace = [](const SMikkTSpaceContext* pContext, const float fvTangent[],
                         const float fSign, const int iFace, const int iVert) {
-        auto ptr = static_cast<Geometry*>(pContext->m_pUserData);
-        ptr->addTangent(iFace, iVert, Vec3(fvTangent[0], fvTangent[1], fvTangent[2]),
-                        fSign);
+        auto ptr = static_cast<TangentContext*>(pContext->m_pUserData);
+        ptr->tangents[iFace * 3 + iVert] = {fvTangent[0], fvTangent[1], fvTangent[2],
+                                            fSign};
     };
 
     SMikkTSpaceInterface it{.m_getNumFaces = getNumFaces,
@@ -133,11 +279,44 @@ void Geometry::computeTangents() {
                             .m_setTSpaceBasic = setTSpace,
                             .m_setTSpace = nullptr};
 
-    SMikkTSpaceContext ctx{.m_pInterface = &it, .m_pUserData = this};
+    // Corners sharing a vertex can still need different tangents, e.g. across mirrored
+    // UV seams, so they are generated per corner first
+    TangentContext tangentCtx{.geometry = this, .tangents = {}};
+    tangentCtx.tangents.resize(_indices.size());
+
+    SMikkTSpaceContext ctx{.m_pInterface = &it, .m_pUserData = &tangentCtx};
 
     int res = genTangSpaceDefault(&ctx);
-    if (res == 0)
+    if (res == 0) {
         LOG_ERROR("Failed to compute tangents.");
+        return;
+    }
+
+    // The first corner of a vertex sets its tangent, corners that disagree get a copy
+    std::vector<bool> assigned(_vertices.size(), false);
+    std::unordered_map<Vertex, unsigned int> splits;
+    for (std::size_t c = 0; c < _indices.size(); ++c) {
+        const unsigned int idx = _indices[c];
+        const Vec4& tangent = tangentCtx.tangents[c];
+
+        if (!assigned[idx]) {
+            _vertices[idx].tangent = tangent;
+            assigned[idx] = true;
+            continue;
+        }
+
+        if (_vertices[idx].tangent == tangent)
+            continue;
+
+        Vertex split = _vertices[idx];
+        split.tangent = tangent;
+
+        auto [it, added] =
+            splits.try_emplace(split, static_cast<unsigned int>(_vertices.size()));
+        if (added)
+            _vertices.push_back(split);
+        _indices[c] = it->second;
+    }
 }
 
 std::unique_ptr<Geometry> pbr::genUnitSphere(unsigned int widthSegments,
@@ -195,7 +374,11 @@ std::unique_ptr<Geometry> pbr::genUnitSphere(unsigned int widthSegments,
         }
     }
 
-    return std::make_unique<Geometry>(std::move(vertices), std::move(indices));
+    auto geo = std::make_unique<Geometry>(std::move(vertices), std::move(indices), false);
+    geo->buildLods();
+    geo->upload();
+
+    return geo;
 }
 
 void Geometry::removeRedundantVerts() {
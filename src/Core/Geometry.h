@@ -4,7 +4,13 @@
 #include <PBR.h>
 #include <PBRMath.h>
 #include <BBox.h>
+#include <BVH.h>
+#include <Ray.h>
 #include <VertexArrays.h>
+#include <PackedVertex.h>
+#include <MeshOptimizer.h>
+#include <MeshSimplifier.h>
+#include <Meshlets.h>
 
 using namespace pbr::math;
 
@@ -27,42 +33,100 @@ struct Vertex {
 class Geometry {
 public:
     Geometry() = default;
-    Geometry(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices);
+    Geometry(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices,
+             bool uploadNow = true);
+
+    // Takes vertices that are already deduplicated and have tangents, e.g. from a mesh
+    // cache, with the indices of every level of detail. They are copied, picking and
+    // meshlets need them on the CPU.
+    Geometry(std::span<const Vertex> vertices, std::span<const unsigned int> indices,
+             std::span<const MeshLod> lods, const BBox3& bbox, bool uploadNow = true);
 
     void swap(Geometry& rhs) noexcept {
         using std::swap;
         swap(_vertices, rhs._vertices);
         swap(_indices, rhs._indices);
+        swap(_lods, rhs._lods);
+        swap(_meshlets, rhs._meshlets);
+        swap(_bbox, rhs._bbox);
+        swap(_format, rhs._format);
         swap(_varrays, rhs._varrays);
+        swap(_meshletBuffer, rhs._meshletBuffer);
+        swap(_bvh, rhs._bvh);
     }
 
     const std::vector<Vertex>& vertices() const;
+
+    // Indices of every level of detail, back to back starting with the full one
     const std::vector<unsigned int>& indices() const;
 
     void addVertex(const Vertex& vertex);
     void addIndex(unsigned int idx);
 
-    unsigned int getNumFaces() { return _indices.size() / 3; }
+    unsigned int getNumFaces() { return lod(0).numIndices / 3; }
+
+    unsigned int numLods() const { return std::max<std::size_t>(_lods.size(), 1); }
+    MeshLod lod(unsigned int level) const;
+    std::span<const MeshLod> lods() const { return _lods; }
+
+    // Meshlets of the full detail level, only built for geometries large enough to be
+    // worth culling in pieces. Their storage buffer is uploaded with the vertices.
+    std::span<const Meshlet> meshlets() const { return _meshlets; }
+    bool hasMeshlets() const { return _meshletBuffer != nullptr; }
+    void bindMeshlets(unsigned int index) const;
 
     const Vertex& getVertex(unsigned int faceIdx, unsigned int vertIdx) const;
     void addTangent(unsigned int faceIdx, unsigned int vertIdx, const Vec3& tan,
                     float sign = 1.0f);
 
-    BBox3 bbox() const;
+    const BBox3& bbox() const;
     BSphere bSphere() const;
 
+    // Closest triangle hit by an object space ray. The triangle BVH is built on first use.
+    std::optional<TriangleHit> intersect(const Ray& ray, float tMax) const;
+
     void draw() const;
-    void upload();
+    void bind() const;
+    void submit(unsigned int numInstances = 1, unsigned int baseInstance = 0,
+                unsigned int level = 0) const;
+
+    // Draws the commands, and reads their count, from the bound indirect and parameter
+    // buffers at the given byte offsets
+    void submitIndirect(std::size_t commandOffset, std::size_t countOffset,
+                        unsigned int maxDraws) const;
+
+    // Uploads the vertices in the given layout, unless they were already uploaded
+    void upload(VertexFormat format = VertexFormat::Full);
+
+    // Reorders triangles and vertices for the post-transform cache, overdraw and vertex
+    // fetch. Must run before the geometry is uploaded.
+    MeshOptimizeStats optimize(const MeshOptimizeOptions& options = {});
+
+    // Simplifies the geometry into a chain of levels of detail that share its vertices.
+    // Must run after optimize() and before the geometry is uploaded.
+    void buildLods(const LodOptions& options = {});
+
+    VertexFormat vertexFormat() const { return _format; }
+    Vec4 positionScale() const { return PositionScale(_format, _bbox); }
+    Vec4 positionOffset() const { return PositionOffset(_format, _bbox); }
 
 private:
     bool isUploaded() const { return _varrays != nullptr; }
 
+    void uploadMeshlets();
+
     void computeTangents();
     void removeRedundantVerts();
 
     std::vector<Vertex> _vertices;
     std::vector<unsigned int> _indices;
+    std::vector<MeshLod> _lods; // Empty if the only level is the full one
+    std::vector<Meshlet> _meshlets;
+    BBox3 _bbox{{FLOAT_INFINITY}, {-FLOAT_INFINITY}};
+    VertexFormat _format = VertexFormat::Full;
     std::unique_ptr<VertexArrays> _varrays = nullptr;
+    std::unique_ptr<Buffer> _meshletBuffer = nullptr;
+    mutable std::unique_ptr<BVH> _bvh = nullptr;
 };
 
 inline void swap(Geometry& lhs, Geometry& rhs) noexcept {
@@ -0,0 +1,219 @@
+#include <JobSystem.h>
+
+using namespace pbr;
+using namespace std::chrono;
+
+namespace {
+
+// Index of the worker running on this thread, 0 for threads that aren't workers
+thread_local unsigned int ThisWorker = 0;
+
+// Whether this thread is running a background job
+thread_local bool InBackground = false;
+
+} // namespace
+
+JobSystem::JobSystem() {
+    // At least one, so background jobs progress while the main thread renders
+    const unsigned int numWorkers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    _workers.resize(numWorkers + 1);
+    for (auto& worker : _workers)
+        worker = std::make_unique<Worker>();
+
+    _statsStart = steady_clock::now();
+
+    _threads.reserve(numWorkers);
+    for (unsigned int w = 1; w <= numWorkers; ++w)
+        _threads.emplace_back([this, w](std::stop_token stop) { workerLoop(stop, w); });
+}
+
+JobSystem::~JobSystem() {
+    for (auto& thread : _threads)
+        thread.request_stop();
+    _wake.notify_all();
+    _threads.clear();
+}
+
+void JobSystem::submit(Job job, JobCounter* counter, JobPriority priority) {
+    if (counter)
+        counter->_pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (InBackground)
+        priority = JobPriority::Background;
+
+    if (priority == JobPriority::Background) {
+        std::scoped_lock lock{_backgroundMutex};
+        _background.push_back({std::move(job), counter, priority});
+    } else {
+        auto& worker = *_workers[ThisWorker];
+        std::scoped_lock lock{worker.mutex};
+        worker.queue.push_back({std::move(job), counter, priority});
+    }
+    _queued.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders this against a worker checking _queued before sleeping
+    { std::scoped_lock lock{_sleepMutex}; }
+    _wake.notify_one();
+}
+
+void JobSystem::wait(const JobCounter& counter, JobPriority help) {
+    const bool background = InBackground || help == JobPriority::Background;
+    while (!counter.done()) {
+        if (!runOne(ThisWorker, background))
+            std::this_thread::yield();
+    }
+}
+
+std::optional<JobSystem::Entry> JobSystem::pop(unsigned int self, bool background) {
+    // Newest own job first, it is the most likely to be in cache
+    {
+        auto& own = *_workers[self];
+        std::scoped_lock lock{own.mutex};
+        if (!own.queue.empty()) {
+            Entry entry = std::move(own.queue.back());
+            own.queue.pop_back();
+            return entry;
+        }
+    }
+
+    // Oldest job of someone else, usually the biggest piece of work left there
+    const auto numQueues = static_cast<unsigned int>(_workers.size());
+    for (unsigned int i = 1; i < numQueues; ++i) {
+        auto& victim = *_workers[(self + i) % numQueues];
+        std::scoped_lock lock{victim.mutex};
+        if (!victim.queue.empty()) {
+            Entry entry = std::move(victim.queue.front());
+            victim.queue.pop_front();
+            _workers[self]->steals.fetch_add(1, std::memory_order_relaxed);
+            return entry;
+        }
+    }
+
+    if (background) {
+        std::scoped_lock lock{_backgroundMutex};
+        if (!_background.empty()) {
+            Entry entry = std::move(_background.front());
+            _background.pop_front();
+            return entry;
+        }
+    }
+
+    return std::nullopt;
+}
+
+bool JobSystem::runOne(unsigned int self, bool background) {
+    if (_queued.load(std::memory_order_acquire) == 0)
+        return false;
+
+    auto entry = pop(self, background);
+    if (!entry)
+        return false;
+
+    _queued.fetch_sub(1, std::memory_order_relaxed);
+
+    const bool wasBackground = InBackground;
+    InBackground = entry->priority == JobPriority::Background;
+
+    const auto start = steady_clock::now();
+    entry->job();
+    const auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start);
+
+    InBackground = wasBackground;
+
+    auto& worker = *_workers[self];
+    worker.busyNs.fetch_add(elapsed.count(), std::memory_order_relaxed);
+    worker.jobs.fetch_add(1, std::memory_order_relaxed);
+
+    // Last, the waiting thread may release the counter right after
+    if (entry->counter)
+        entry->counter->_pending.fetch_sub(1, std::memory_order_acq_rel);
+
+    return true;
+}
+
+void JobSystem::workerLoop(std::stop_token stop, unsigned int self) {
+    ThisWorker = self;
+
+    while (!stop.stop_requested()) {
+        if (runOne(self, true))
+            continue;
+
+        std::unique_lock lock{_sleepMutex};
+        _wake.wait(lock, stop, [this] { return _queued.load() > 0; });
+    }
+}
+
+std::vector<WorkerStats> JobSystem::stats() const {
+    const double elapsed = duration<double>(steady_clock::now() - _statsStart).count();
+
+    std::vector<WorkerStats> stats;
+    stats.reserve(_workers.size());
+    for (const auto& worker : _workers) {
+        WorkerStats& ws = stats.emplace_back();
+        ws.jobs = worker->jobs.load(std::memory_order_relaxed);
+        ws.steals = worker->steals.load(std::memory_order_relaxed);
+        ws.busySeconds = worker->busyNs.load(std::memory_order_relaxed) * 1e-9;
+        ws.utilization =
+            elapsed > 0.0 ? static_cast<float>(std::min(ws.busySeconds / elapsed, 1.0))
+                          : 0.0f;
+    }
+
+    return stats;
+}
+
+void JobSystem::resetStats() {
+    for (auto& worker : _workers) {
+        worker->jobs = 0;
+        worker->steals = 0;
+        worker->busyNs = 0;
+    }
+
+    _statsStart = steady_clock::now();
+}
+
+// --------------------------------------------------------------------------------------
+//      Task Graph
+// --------------------------------------------------------------------------------------
+TaskGraph::TaskId TaskGraph::add(std::function<void()> task,
+                                 std::initializer_list<TaskId> deps) {
+    const auto id = static_cast<TaskId>(_nodes.size());
+
+    Node& node = _nodes.emplace_back();
+    node.task = std::move(task);
+    node.numDeps = deps.size();
+
+    for (TaskId dep : deps) {
+        CHECK_LT(dep, id);
+        _nodes[dep].successors.push_back(id);
+    }
+
+    return id;
+}
+
+void TaskGraph::launch(TaskId id, JobCounter& counter) {
+    JobSystem::get().submit(
+        [this, id, &counter] {
+            Node& node = _nodes[id];
+            node.task();
+
+            // Successors are submitted before this job retires, so the counter can't
+            // reach zero while tasks are still pending
+            for (TaskId next : node.successors)
+                if (_nodes[next].remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    launch(next, counter);
+        },
+        &counter);
+}
+
+void TaskGraph::run() {
+    for (Node& node : _nodes)
+        node.remaining.store(node.numDeps, std::memory_order_relaxed);
+
+    JobCounter counter;
+    for (TaskId id = 0; id < _nodes.size(); ++id)
+        if (_nodes[id].numDeps == 0)
+            launch(id, counter);
+
+    JobSystem::get().wait(counter);
+}
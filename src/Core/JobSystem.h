@@ -0,0 +1,154 @@
+#ifndef PBR_JOBSYSTEM_H
+#define PBR_JOBSYSTEM_H
+
+#include <PBR.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace pbr {
+
+// Number of submitted jobs of a group that haven't finished yet
+class JobCounter {
+public:
+    bool done() const { return _pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<std::uint32_t> _pending = 0;
+};
+
+struct WorkerStats {
+    std::uint64_t jobs = 0;
+    std::uint64_t steals = 0;
+    double busySeconds = 0.0;
+    float utilization = 0.0f; // Busy fraction of the time since the last resetStats()
+};
+
+// Background jobs, like streaming decodes, only run when no other job is queued. Frame
+// waits never pick them up, so they can't stall a frame. Jobs submitted from a
+// background job are background jobs too.
+enum class JobPriority { Normal, Background };
+
+// Work stealing scheduler. Every worker owns a deque: it pushes and pops jobs at the
+// back and idle workers steal from the front of the others. Threads that aren't
+// workers, like the main thread, share queue 0. Background jobs share a single FIFO
+// queue. Waiting on a counter runs queued jobs instead of blocking, so jobs may submit
+// and wait on other jobs.
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    static JobSystem& get() {
+        static JobSystem _inst;
+        return _inst;
+    }
+
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Worker threads plus the calling thread
+    unsigned int numThreads() const { return _threads.size() + 1; }
+
+    void submit(Job job, JobCounter* counter = nullptr,
+                JobPriority priority = JobPriority::Normal);
+
+    // Only runs background jobs meanwhile when asked to, or when called from one
+    void wait(const JobCounter& counter, JobPriority help = JobPriority::Normal);
+
+    // Calls func(begin, end) over [0, count) in ranges of grain elements. The calling
+    // thread runs the first range and returns once all of them are done.
+    template<typename Func>
+    void parallelFor(std::size_t count, std::size_t grain, Func&& func) {
+        grain = std::max<std::size_t>(grain, 1);
+        if (count <= grain || _threads.empty()) {
+            if (count > 0)
+                func(std::size_t(0), count);
+            return;
+        }
+
+        JobCounter counter;
+        for (std::size_t begin = grain; begin < count; begin += grain) {
+            const std::size_t end = std::min(begin + grain, count);
+            submit([&func, begin, end] { func(begin, end); }, &counter);
+        }
+
+        func(std::size_t(0), grain);
+        wait(counter);
+    }
+
+    // Entry 0 accumulates the jobs run by threads that aren't workers
+    std::vector<WorkerStats> stats() const;
+    void resetStats();
+
+private:
+    struct Entry {
+        Job job;
+        JobCounter* counter;
+        JobPriority priority;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Entry> queue;
+
+        std::atomic<std::uint64_t> jobs = 0;
+        std::atomic<std::uint64_t> steals = 0;
+        std::atomic<std::uint64_t> busyNs = 0;
+    };
+
+    JobSystem();
+
+    bool runOne(unsigned int self, bool background);
+    std::optional<Entry> pop(unsigned int self, bool background);
+    void workerLoop(std::stop_token stop, unsigned int self);
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<std::jthread> _threads;
+
+    std::mutex _backgroundMutex;
+    std::deque<Entry> _background;
+
+    // Queued jobs across all deques, idle workers sleep while it is zero
+    std::atomic<std::uint32_t> _queued = 0;
+    std::mutex _sleepMutex;
+    std::condition_variable_any _wake;
+
+    std::chrono::steady_clock::time_point _statsStart;
+};
+
+// Tasks with dependencies. Each task is submitted to the job system as soon as all
+// the tasks it depends on have finished.
+class TaskGraph {
+public:
+    using TaskId = std::uint32_t;
+
+    // Dependencies must have been added before, which keeps the graph acyclic
+    TaskId add(std::function<void()> task, std::initializer_list<TaskId> deps = {});
+
+    // Runs every task and returns once all have finished
+    void run();
+
+private:
+    struct Node {
+        std::function<void()> task;
+        std::vector<TaskId> successors;
+        std::uint32_t numDeps = 0;
+        std::atomic<std::uint32_t> remaining = 0;
+    };
+
+    void launch(TaskId id, JobCounter& counter);
+
+    std::deque<Node> _nodes;
+};
+
+} // namespace pbr
+
+#endif
@@ -1,7 +1,7 @@
 #include <Mesh.h>
 
 #include <Geometry.h>
-#include <ObjLoader.h>
+#include <MeshCache.h>
 #include <RenderInterface.h>
 #include <Resources.h>
 #include <Material.h>
@@ -28,11 +28,28 @@ BSphere Mesh::bSphere() const {
     return _bbox.sphere();
 }
 
-std::optional<float> Mesh::intersect(const Ray& ray, float tMax) const {
-    return bbox().intersectRay(ray, tMax);
+std::optional<TriangleHit> Mesh::intersect(const Ray& ray, float tMax) const {
+    // The direction is left unnormalized so that hit distances stay in world units
+    const Mat4 worldToObj = Inverse(objToWorld());
+    const Ray objRay{worldToObj * ray.origin(),
+                     Vec3(worldToObj * Vec4(ray.direction(), 0.0f))};
+
+    return _geometry->intersect(objRay, tMax);
+}
+
+std::optional<fs::path> pbr::MeshSourcePath(const ParameterMap& params) {
+    if (params.lookup<std::string>("type") != "obj")
+        return std::nullopt;
+
+    fs::path parentDir = params.lookup("parentdir", ""s);
+    auto fileName = params.lookup<std::string>("filename");
+    CHECK(fileName.has_value());
+
+    return parentDir / *fileName;
 }
 
-std::unique_ptr<Shape> pbr::CreateMesh(const ParameterMap& params) {
+std::unique_ptr<Shape> pbr::CreateMesh(const ParameterMap& params,
+                                       sref<Geometry> geometry) {
     auto typeOpt = params.lookup<std::string>("type");
     CHECK(typeOpt.has_value());
 
@@ -40,21 +57,24 @@ std::unique_ptr<Shape> pbr::CreateMesh(const ParameterMap& params) {
 
     auto type = *typeOpt;
     if (type == "obj") {
-        fs::path parentDir = params.lookup("parentdir", ""s);
-        auto fileName = params.lookup<std::string>("filename");
-        CHECK(fileName.has_value());
-
-        auto fullPath = parentDir / *fileName;
-        auto objFile = LoadObjFile(fullPath);
-        if (!objFile.has_value())
-            FATAL("Unable to load mesh {}.", fullPath.string());
-
-        geo = std::make_unique<Geometry>(std::move((*objFile).vertices),
-                                         std::move((*objFile).indices));
+        geo = std::move(geometry);
+        if (!geo) {
+            auto fullPath = *MeshSourcePath(params);
+            geo = LoadCachedObj(fullPath, false);
+            if (!geo)
+                FATAL("Unable to load mesh {}.", fullPath.string());
+        }
+
+        geo->upload(RHI.meshVertexFormat());
     } else if (type == "sphere") {
         auto widthSegments = params.lookup<unsigned int>("widthSegments", 128);
         auto heightSegments = params.lookup<unsigned int>("heightSegments", 64);
-        geo = genUnitSphere(widthSegments, heightSegments);
+
+        // Default tessellation shares the unit sphere resource, so it can be instanced
+        if (widthSegments == 128 && heightSegments == 64)
+            geo = Resource.get<Geometry>("unitSphere");
+        else
+            geo = genUnitSphere(widthSegments, heightSegments);
     } else if (type == "quad") {
         geo = Resource.get<Geometry>("unitQuad");
     } else {
@@ -3,6 +3,10 @@
 
 #include <Shape.h>
 
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
 namespace pbr {
 
 class Mesh : public Shape {
@@ -12,13 +16,19 @@ public:
     BBox3 bbox() const override;
     BSphere bSphere() const override;
 
-    std::optional<float> intersect(const Ray& ray, float tMax) const override;
+    std::optional<TriangleHit> intersect(const Ray& ray, float tMax) const override;
 
 private:
     BBox3 _bbox;
 };
 
-std::unique_ptr<Shape> CreateMesh(const ParameterMap& params);
+// Source file of an obj mesh entry, nullopt for the built-in types
+std::optional<fs::path> MeshSourcePath(const ParameterMap& params);
+
+// Obj meshes load their source unless the geometry is given, e.g. one loaded without
+// upload on a worker thread. It is uploaded here.
+std::unique_ptr<Shape> CreateMesh(const ParameterMap& params,
+                                  sref<Geometry> geometry = nullptr);
 
 } // namespace pbr
 
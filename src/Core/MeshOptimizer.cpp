@@ -0,0 +1,291 @@
+#include <MeshOptimizer.h>
+
+#include <Geometry.h>
+
+#include <numeric>
+
+using namespace pbr;
+using namespace pbr::math;
+
+namespace {
+
+constexpr unsigned int Unused = std::numeric_limits<unsigned int>::max();
+
+// Vertex to triangles adjacency, the triangles of vertex v are
+// triangles[offsets[v]] to triangles[offsets[v + 1]]
+struct Adjacency {
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> triangles;
+};
+
+Adjacency BuildAdjacency(std::span<const unsigned int> indices, std::size_t numVertices) {
+    Adjacency adj;
+    adj.offsets.assign(numVertices + 1, 0);
+    adj.triangles.resize(indices.size());
+
+    for (unsigned int v : indices)
+        ++adj.offsets[v + 1];
+    std::partial_sum(adj.offsets.begin(), adj.offsets.end(), adj.offsets.begin());
+
+    std::vector<std::uint32_t> fill(adj.offsets.begin(), adj.offsets.end() - 1);
+    for (std::size_t i = 0; i < indices.size(); ++i)
+        adj.triangles[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+
+    return adj;
+}
+
+// Twice the area times the normal of a triangle
+Vec3 WeightedNormal(std::span<const Vertex> vertices, const unsigned int* tri) {
+    const Vec3& p0 = vertices[tri[0]].position;
+    return Cross(vertices[tri[1]].position - p0, vertices[tri[2]].position - p0);
+}
+
+Vec3 Centroid(std::span<const Vertex> vertices, const unsigned int* tri) {
+    return (vertices[tri[0]].position + vertices[tri[1]].position +
+            vertices[tri[2]].position) /
+           3.0f;
+}
+
+} // namespace
+
+VertexCacheStats pbr::AnalyzeVertexCache(std::span<const unsigned int> indices,
+                                         std::size_t numVertices, int cacheSize) {
+    if (indices.empty())
+        return {};
+
+    // A vertex is still cached while fewer than cacheSize misses happened since its own
+    std::vector<std::int64_t> cachedAt(numVertices, -std::int64_t{cacheSize} - 1);
+    std::vector<bool> used(numVertices, false);
+
+    std::int64_t misses = 0;
+    std::size_t numUsed = 0;
+    for (unsigned int v : indices) {
+        if (misses - cachedAt[v] > cacheSize)
+            cachedAt[v] = misses++;
+
+        if (!used[v]) {
+            used[v] = true;
+            ++numUsed;
+        }
+    }
+
+    return {.acmr = static_cast<float>(misses) / (indices.size() / 3),
+            .atvr = static_cast<float>(misses) / numUsed};
+}
+
+std::vector<std::uint32_t> pbr::OptimizeVertexCache(std::span<unsigned int> indices,
+                                                    std::size_t numVertices,
+                                                    int cacheSize) {
+    const Adjacency adj = BuildAdjacency(indices, numVertices);
+
+    std::vector<std::uint32_t> live(numVertices);
+    for (std::size_t v = 0; v < numVertices; ++v)
+        live[v] = adj.offsets[v + 1] - adj.offsets[v];
+
+    std::vector<std::int64_t> cachedAt(numVertices, 0);
+    std::int64_t time = cacheSize + 1;
+
+    std::vector<bool> emitted(indices.size() / 3, false);
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+
+    std::vector<unsigned int> deadEnds, candidates;
+    std::vector<std::uint32_t> jumps;
+    std::size_t cursor = 0;
+
+    // Most recently used vertex with triangles left, else the next one in input order
+    auto skipDeadEnd = [&]() -> std::int64_t {
+        while (!deadEnds.empty()) {
+            const unsigned int v = deadEnds.back();
+            deadEnds.pop_back();
+            if (live[v] > 0)
+                return v;
+        }
+
+        for (; cursor < numVertices; ++cursor)
+            if (live[cursor] > 0)
+                return static_cast<std::int64_t>(cursor);
+
+        return -1;
+    };
+
+    std::int64_t fan = skipDeadEnd();
+    while (fan >= 0) {
+        candidates.clear();
+        for (auto a = adj.offsets[fan]; a < adj.offsets[fan + 1]; ++a) {
+            const std::uint32_t t = adj.triangles[a];
+            if (emitted[t])
+                continue;
+
+            for (int k = 0; k < 3; ++k) {
+                const unsigned int v = indices[3 * t + k];
+                output.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+
+                if (time - cachedAt[v] > cacheSize)
+                    cachedAt[v] = time++;
+            }
+
+            emitted[t] = true;
+        }
+
+        // Prefer the candidate that has been cached the longest but whose remaining
+        // triangles still fit before it's evicted
+        std::int64_t next = -1, best = -1;
+        for (unsigned int v : candidates) {
+            if (live[v] == 0)
+                continue;
+
+            std::int64_t priority = 0;
+            if (time - cachedAt[v] + 2 * std::int64_t{live[v]} <= cacheSize)
+                priority = time - cachedAt[v];
+
+            if (priority > best) {
+                best = priority;
+                next = v;
+            }
+        }
+
+        if (next < 0) {
+            next = skipDeadEnd();
+            if (next >= 0)
+                jumps.push_back(static_cast<std::uint32_t>(output.size() / 3));
+        }
+
+        fan = next;
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+    return jumps;
+}
+
+void pbr::OptimizeOverdraw(std::span<unsigned int> indices,
+                           std::span<const Vertex> vertices,
+                           std::span<const std::uint32_t> jumps,
+                           const MeshOptimizeOptions& options) {
+    const std::size_t numTris = indices.size() / 3;
+    if (numTris == 0)
+        return;
+
+    const int cacheSize = options.cacheSize;
+    const float maxAcmr = AnalyzeVertexCache(indices, vertices.size(), cacheSize).acmr *
+                          options.overdrawThreshold;
+
+    // Each cluster starts with a cold cache, so its ACMR so far includes what splitting
+    // there costs
+    std::vector<std::uint32_t> starts{0};
+    std::vector<std::int64_t> cachedAt(vertices.size(), -std::int64_t{cacheSize} - 1);
+    std::int64_t time = 0, clusterMisses = 0;
+    auto jump = jumps.begin();
+
+    for (std::uint32_t t = 0; t < numTris; ++t) {
+        while (jump != jumps.end() && *jump < t)
+            ++jump;
+
+        const std::uint32_t clusterTris = t - starts.back();
+        const bool hard = jump != jumps.end() && *jump == t;
+        const bool soft = clusterTris > 0 && clusterMisses <= maxAcmr * clusterTris;
+        if (clusterTris > 0 && (hard || soft)) {
+            starts.push_back(t);
+            clusterMisses = 0;
+            time += cacheSize;
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            const unsigned int v = indices[3 * t + k];
+            if (time - cachedAt[v] > cacheSize) {
+                cachedAt[v] = time++;
+                ++clusterMisses;
+            }
+        }
+    }
+    starts.push_back(static_cast<std::uint32_t>(numTris));
+
+    const std::size_t numClusters = starts.size() - 1;
+    if (numClusters < 2)
+        return;
+
+    // Area weighted centroids and normals
+    Vec3 meshCentroid{0.0f};
+    float meshArea = 0.0f;
+    std::vector<Vec3> centroids(numClusters, Vec3{0.0f});
+    std::vector<Vec3> normals(numClusters, Vec3{0.0f});
+
+    for (std::size_t c = 0; c < numClusters; ++c) {
+        float area = 0.0f;
+        for (std::uint32_t t = starts[c]; t < starts[c + 1]; ++t) {
+            const unsigned int* tri = &indices[3 * t];
+            const Vec3 normal = WeightedNormal(vertices, tri);
+            const float triArea = normal.length();
+
+            centroids[c] += Centroid(vertices, tri) * triArea;
+            normals[c] += normal;
+            area += triArea;
+        }
+
+        meshCentroid += centroids[c];
+        meshArea += area;
+        centroids[c] = area > 0.0f ? centroids[c] / area
+                                   : Centroid(vertices, &indices[3 * starts[c]]);
+    }
+
+    if (meshArea > 0.0f)
+        meshCentroid = meshCentroid / meshArea;
+
+    std::vector<float> facing(numClusters);
+    for (std::size_t c = 0; c < numClusters; ++c) {
+        const float length = normals[c].length();
+        facing[c] =
+            length > 0.0f ? Dot(centroids[c] - meshCentroid, normals[c] / length) : 0.0f;
+    }
+
+    std::vector<std::uint32_t> order(numClusters);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](auto a, auto b) { return facing[a] > facing[b]; });
+
+    std::vector<unsigned int> sorted;
+    sorted.reserve(indices.size());
+    for (std::uint32_t c : order)
+        sorted.insert(sorted.end(), indices.begin() + 3 * starts[c],
+                      indices.begin() + 3 * starts[c + 1]);
+
+    std::copy(sorted.begin(), sorted.end(), indices.begin());
+}
+
+void pbr::OptimizeVertexFetch(std::vector<Vertex>& vertices,
+                              std::span<unsigned int> indices) {
+    std::vector<unsigned int> remap(vertices.size(), Unused);
+
+    unsigned int next = 0;
+    for (unsigned int& index : indices) {
+        if (remap[index] == Unused)
+            remap[index] = next++;
+        index = remap[index];
+    }
+
+    // Vertices no triangle uses are dropped
+    std::vector<Vertex> reordered(next);
+    for (std::size_t v = 0; v < vertices.size(); ++v)
+        if (remap[v] != Unused)
+            reordered[remap[v]] = vertices[v];
+
+    vertices = std::move(reordered);
+}
+
+MeshOptimizeStats pbr::OptimizeMesh(std::vector<Vertex>& vertices,
+                                    std::vector<unsigned int>& indices,
+                                    const MeshOptimizeOptions& options) {
+    MeshOptimizeStats stats;
+    stats.before = AnalyzeVertexCache(indices, vertices.size(), options.cacheSize);
+
+    const auto jumps = OptimizeVertexCache(indices, vertices.size(), options.cacheSize);
+    if (options.overdraw)
+        OptimizeOverdraw(indices, vertices, jumps, options);
+    OptimizeVertexFetch(vertices, indices);
+
+    stats.after = AnalyzeVertexCache(indices, vertices.size(), options.cacheSize);
+    return stats;
+}
@@ -0,0 +1,56 @@
+#ifndef PBR_MESHOPTIMIZER_H
+#define PBR_MESHOPTIMIZER_H
+
+#include <PBR.h>
+
+namespace pbr {
+
+struct Vertex;
+
+struct MeshOptimizeOptions {
+    int cacheSize = 16; // Entries of the simulated FIFO post-transform cache
+
+    // Sorts clusters of triangles so outward facing ones are drawn first, letting a
+    // cluster cost up to overdrawThreshold times the ACMR of the whole mesh
+    bool overdraw = true;
+    float overdrawThreshold = 1.05f;
+};
+
+// Average vertex shader invocations per triangle (ACMR) and per vertex (ATVR) of an index
+// buffer drawn through a FIFO cache. 0.5 and 1 are the best possible.
+struct VertexCacheStats {
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+
+struct MeshOptimizeStats {
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+VertexCacheStats AnalyzeVertexCache(std::span<const unsigned int> indices,
+                                    std::size_t numVertices, int cacheSize);
+
+// Tipsify [Sander et al. 2007], "Fast Triangle Reordering for Vertex Locality and
+// Reduced Overdraw". Fans around vertices in the cache, picking the next one by how long
+// it stays there, and jumps to a dead end when none is left. Returns the first triangle
+// after every jump.
+std::vector<std::uint32_t> OptimizeVertexCache(std::span<unsigned int> indices,
+                                               std::size_t numVertices, int cacheSize);
+
+// Splits the triangle order into clusters at the given jumps and wherever the ACMR so far
+// allows, then sorts the clusters by how much they face away from the mesh's centroid
+void OptimizeOverdraw(std::span<unsigned int> indices, std::span<const Vertex> vertices,
+                      std::span<const std::uint32_t> jumps,
+                      const MeshOptimizeOptions& options);
+
+// Orders vertices by their first use in the index buffer, remapping the indices
+void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::span<unsigned int> indices);
+
+MeshOptimizeStats OptimizeMesh(std::vector<Vertex>& vertices,
+                               std::vector<unsigned int>& indices,
+                               const MeshOptimizeOptions& options = {});
+
+} // namespace pbr
+
+#endif
@@ -0,0 +1,400 @@
+#include <MeshSimplifier.h>
+
+#include <Geometry.h>
+#include <Hash.h>
+#include <MeshOptimizer.h>
+
+#include <queue>
+#include <unordered_map>
+
+using namespace pbr;
+using namespace pbr::math;
+
+namespace {
+
+// Collapses that turn a triangle's normal by more than about 75 degrees, or that make it
+// face away from where its original triangle did, are rejected
+constexpr float MinNormalCos = 0.25f;
+
+// A level that can't be simplified to its target is still kept if it saves this much
+constexpr float MinLastReduction = 0.9f;
+
+// Area weighted sum of squared distances to a set of planes, as the symmetric matrix
+//   | a2 ab ac ad |
+//   |    b2 bc bd |
+//   |       c2 cd |
+//   |          d2 |
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0;
+    double b2 = 0, bc = 0, bd = 0;
+    double c2 = 0, cd = 0;
+    double d2 = 0;
+    double weight = 0;
+
+    static Quadric FromPlane(const Vec3& n, float d, float weight) {
+        const double a = n.x, b = n.y, c = n.z;
+
+        Quadric q;
+        q.a2 = weight * a * a;
+        q.ab = weight * a * b;
+        q.ac = weight * a * c;
+        q.ad = weight * a * d;
+        q.b2 = weight * b * b;
+        q.bc = weight * b * c;
+        q.bd = weight * b * d;
+        q.c2 = weight * c * c;
+        q.cd = weight * c * d;
+        q.d2 = weight * d * d;
+        q.weight = weight;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& q) {
+        a2 += q.a2, ab += q.ab, ac += q.ac, ad += q.ad;
+        b2 += q.b2, bc += q.bc, bd += q.bd;
+        c2 += q.c2, cd += q.cd;
+        d2 += q.d2;
+        weight += q.weight;
+        return *this;
+    }
+
+    double error(const Vec3& p) const {
+        const double x = p.x, y = p.y, z = p.z;
+        const double e = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x +
+                         b2 * y * y + 2 * bc * y * z + 2 * bd * y + c2 * z * z +
+                         2 * cd * z + d2;
+        return std::max(e, 0.0);
+    }
+};
+
+struct Collapse {
+    double cost;
+    unsigned int from;
+    unsigned int to;
+
+    bool operator>(const Collapse& rhs) const { return cost > rhs.cost; }
+};
+
+std::uint64_t EdgeKey(unsigned int a, unsigned int b) {
+    if (a > b)
+        std::swap(a, b);
+    return (std::uint64_t(a) << 32) | b;
+}
+
+class Simplifier {
+public:
+    Simplifier(std::span<const Vertex> vertices, std::span<const unsigned int> indices,
+               float maxError);
+
+    // Collapses the cheapest edges until at most target triangles are left. Returns
+    // false when it ran out of collapses first.
+    bool simplify(std::size_t target);
+
+    void appendTriangles(std::vector<unsigned int>& indices) const;
+
+    std::size_t numTriangles() const { return _numTris; }
+
+    // Root mean square distance to the original planes of the worst collapse so far
+    float error() const { return static_cast<float>(std::sqrt(_maxError)); }
+
+private:
+    void lockBoundaries();
+    void computeQuadrics();
+
+    std::span<unsigned int> triangle(std::uint32_t t) { return {&_tris[3 * t], 3}; }
+    bool hasVertex(std::uint32_t t, unsigned int v) const;
+
+    double cost(unsigned int from, unsigned int to) const;
+    void pushCollapse(unsigned int from, unsigned int to);
+    void pushEdges(unsigned int v);
+
+    bool canCollapse(unsigned int from, unsigned int to);
+    void collapse(unsigned int from, unsigned int to);
+
+    std::span<const Vertex> _vertices;
+    std::vector<unsigned int> _tris;
+    std::size_t _numTris;
+
+    // First vertex with the same position, topology and quadrics are shared through it
+    std::vector<unsigned int> _welded;
+    std::vector<bool> _locked;
+    std::vector<bool> _removed;
+    std::vector<bool> _dead;
+    std::vector<Quadric> _quadrics;
+    std::vector<Vec3> _normals; // Of the original triangles
+
+    // Triangles around each vertex, may still hold dead ones
+    std::vector<std::vector<std::uint32_t>> _vertexTris;
+
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> _heap;
+    double _maxError = 0.0;
+    double _errorLimit;
+
+    std::vector<unsigned int> _fromRing, _toRing;
+};
+
+Simplifier::Simplifier(std::span<const Vertex> vertices,
+                       std::span<const unsigned int> indices, float maxError)
+    : _vertices(vertices), _tris(indices.begin(), indices.end()),
+      _numTris(indices.size() / 3), _welded(vertices.size()),
+      _locked(vertices.size(), false), _removed(vertices.size(), false),
+      _dead(_numTris, false), _quadrics(vertices.size()), _normals(_numTris, Vec3{0.0f}),
+      _vertexTris(vertices.size()), _errorLimit(double{maxError} * maxError) {
+
+    std::unordered_map<Vec3, unsigned int> firstAt;
+    firstAt.reserve(vertices.size());
+    for (unsigned int v = 0; v < vertices.size(); ++v)
+        _welded[v] = firstAt.try_emplace(vertices[v].position, v).first->second;
+
+    for (std::uint32_t t = 0; t < _numTris; ++t)
+        for (unsigned int v : triangle(t))
+            _vertexTris[v].push_back(t);
+
+    lockBoundaries();
+    computeQuadrics();
+
+    for (std::uint32_t t = 0; t < _numTris; ++t) {
+        const auto tri = triangle(t);
+        for (int k = 0; k < 3; ++k)
+            pushCollapse(tri[k], tri[(k + 1) % 3]);
+    }
+}
+
+void Simplifier::lockBoundaries() {
+    // Seams, where vertices with different attributes share a position
+    for (unsigned int v = 0; v < _welded.size(); ++v) {
+        if (_welded[v] != v) {
+            _locked[v] = true;
+            _locked[_welded[v]] = true;
+        }
+    }
+
+    // Borders and non-manifold edges of the welded surface
+    std::unordered_map<std::uint64_t, std::uint32_t> edgeUses;
+    edgeUses.reserve(_tris.size());
+    for (std::uint32_t t = 0; t < _numTris; ++t) {
+        const auto tri = triangle(t);
+        for (int k = 0; k < 3; ++k)
+            ++edgeUses[EdgeKey(_welded[tri[k]], _welded[tri[(k + 1) % 3]])];
+    }
+
+    for (const auto& [edge, uses] : edgeUses) {
+        if (uses != 2) {
+            _locked[edge >> 32] = true;
+            _locked[edge & 0xFFFFFFFF] = true;
+        }
+    }
+
+    for (unsigned int v = 0; v < _welded.size(); ++v)
+        if (_locked[_welded[v]])
+            _locked[v] = true;
+}
+
+void Simplifier::computeQuadrics() {
+    for (std::uint32_t t = 0; t < _numTris; ++t) {
+        const auto tri = triangle(t);
+        const Vec3& p0 = _vertices[tri[0]].position;
+        const Vec3 n =
+            Cross(_vertices[tri[1]].position - p0, _vertices[tri[2]].position - p0);
+
+        const float length = n.length();
+        if (length == 0.0f)
+            continue;
+
+        const Vec3 normal = n / length;
+        _normals[t] = normal;
+
+        const auto q = Quadric::FromPlane(normal, -Dot(normal, p0), 0.5f * length);
+        for (unsigned int v : tri)
+            _quadrics[_welded[v]] += q;
+    }
+}
+
+bool Simplifier::hasVertex(std::uint32_t t, unsigned int v) const {
+    return _tris[3 * t] == v || _tris[3 * t + 1] == v || _tris[3 * t + 2] == v;
+}
+
+double Simplifier::cost(unsigned int from, unsigned int to) const {
+    Quadric q = _quadrics[_welded[from]];
+    q += _quadrics[_welded[to]];
+    return q.error(_vertices[to].position);
+}
+
+void Simplifier::pushCollapse(unsigned int from, unsigned int to) {
+    if (!_locked[from])
+        _heap.push({cost(from, to), from, to});
+}
+
+void Simplifier::pushEdges(unsigned int v) {
+    // An edge inside the surface follows v in one of its triangles and precedes it in the
+    // other, so this pushes both directions of every edge once
+    for (std::uint32_t t : _vertexTris[v]) {
+        const auto tri = triangle(t);
+        const int k = tri[0] == v ? 0 : (tri[1] == v ? 1 : 2);
+
+        pushCollapse(v, tri[(k + 1) % 3]);
+        pushCollapse(tri[(k + 2) % 3], v);
+    }
+}
+
+bool Simplifier::canCollapse(unsigned int from, unsigned int to) {
+    auto gatherRing = [&](unsigned int v, std::vector<unsigned int>& ring) {
+        ring.clear();
+        for (std::uint32_t t : _vertexTris[v]) {
+            if (_dead[t])
+                continue;
+            for (unsigned int w : triangle(t))
+                if (w != v)
+                    ring.push_back(w);
+        }
+        std::sort(ring.begin(), ring.end());
+        ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+    };
+
+    gatherRing(from, _fromRing);
+    if (!std::binary_search(_fromRing.begin(), _fromRing.end(), to))
+        return false;
+
+    // Link condition, the edge's two triangles must be the only ones both ends share
+    gatherRing(to, _toRing);
+    std::size_t common = 0;
+    for (unsigned int w : _fromRing)
+        common += std::binary_search(_toRing.begin(), _toRing.end(), w);
+    if (common != 2)
+        return false;
+
+    const Vec3& target = _vertices[to].position;
+    for (std::uint32_t t : _vertexTris[from]) {
+        if (_dead[t] || hasVertex(t, to))
+            continue;
+
+        std::array<Vec3, 3> p;
+        for (int k = 0; k < 3; ++k)
+            p[k] = _vertices[_tris[3 * t + k]].position;
+        const Vec3 before = Cross(p[1] - p[0], p[2] - p[0]);
+
+        for (int k = 0; k < 3; ++k)
+            if (_tris[3 * t + k] == from)
+                p[k] = target;
+        const Vec3 after = Cross(p[1] - p[0], p[2] - p[0]);
+
+        const float lengths = before.length() * after.length();
+        if (lengths == 0.0f || Dot(before, after) < MinNormalCos * lengths ||
+            Dot(_normals[t], after) <= 0.0f)
+            return false;
+    }
+
+    return true;
+}
+
+void Simplifier::collapse(unsigned int from, unsigned int to) {
+    for (std::uint32_t t : _vertexTris[from]) {
+        if (_dead[t])
+            continue;
+
+        if (hasVertex(t, to)) {
+            _dead[t] = true;
+            --_numTris;
+            continue;
+        }
+
+        for (unsigned int& v : triangle(t))
+            if (v == from)
+                v = to;
+        _vertexTris[to].push_back(t);
+    }
+
+    _vertexTris[from].clear();
+    _removed[from] = true;
+    _quadrics[_welded[to]] += _quadrics[from];
+
+    std::erase_if(_vertexTris[to], [&](std::uint32_t t) { return _dead[t]; });
+    pushEdges(to);
+}
+
+bool Simplifier::simplify(std::size_t target) {
+    while (_numTris > target) {
+        if (_heap.empty())
+            return false;
+
+        const Collapse c = _heap.top();
+        _heap.pop();
+
+        if (_removed[c.from] || _removed[c.to])
+            continue;
+
+        // Quadrics only grow, so a stale cost is a lower bound and the edge goes back in
+        // with its current one
+        const double current = cost(c.from, c.to);
+        if (current > c.cost) {
+            _heap.push({current, c.from, c.to});
+            continue;
+        }
+
+        const double weight =
+            _quadrics[_welded[c.from]].weight + _quadrics[_welded[c.to]].weight;
+        const double error = weight > 0.0 ? current / weight : 0.0;
+        if (error > _errorLimit || !canCollapse(c.from, c.to))
+            continue;
+
+        collapse(c.from, c.to);
+        _maxError = std::max(_maxError, error);
+    }
+
+    return true;
+}
+
+void Simplifier::appendTriangles(std::vector<unsigned int>& indices) const {
+    // Kept in their current order, which is already close to cache friendly
+    for (std::uint32_t t = 0; t < _dead.size(); ++t)
+        if (!_dead[t])
+            indices.insert(indices.end(), &_tris[3 * t], &_tris[3 * t] + 3);
+}
+
+} // namespace
+
+std::vector<MeshLod> pbr::BuildLodChain(std::span<const Vertex> vertices,
+                                        std::vector<unsigned int>& indices,
+                                        const LodOptions& options) {
+    DCHECK_LE(options.maxLods, 8u);
+
+    std::vector<MeshLod> lods;
+    lods.push_back({.firstIndex = 0,
+                    .numIndices = static_cast<std::uint32_t>(indices.size()),
+                    .error = 0.0f});
+
+    if (indices.size() / 3 <= options.minTriangles)
+        return lods;
+
+    BBox3 bbox{{FLOAT_INFINITY}, {-FLOAT_INFINITY}};
+    for (const Vertex& v : vertices)
+        bbox.expand(v.position);
+
+    Simplifier simplifier{vertices, indices, options.maxError * bbox.sphere().radius()};
+    while (lods.size() < options.maxLods) {
+        const std::size_t lastTris = lods.back().numIndices / 3;
+        const auto target = std::max<std::size_t>(
+            options.minTriangles, static_cast<std::size_t>(lastTris * options.reduction));
+        if (target >= lastTris)
+            break;
+
+        const bool reached = simplifier.simplify(target);
+        if (!reached && simplifier.numTriangles() > MinLastReduction * lastTris)
+            break;
+
+        const auto first = static_cast<std::uint32_t>(indices.size());
+        simplifier.appendTriangles(indices);
+
+        std::span lod{indices.begin() + first, indices.end()};
+        OptimizeVertexCache(lod, vertices.size(), MeshOptimizeOptions{}.cacheSize);
+
+        lods.push_back({.firstIndex = first,
+                        .numIndices = static_cast<std::uint32_t>(lod.size()),
+                        .error = simplifier.error()});
+
+        if (!reached)
+            break;
+    }
+
+    return lods;
+}
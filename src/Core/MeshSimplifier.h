@@ -0,0 +1,43 @@
+#ifndef PBR_MESHSIMPLIFIER_H
+#define PBR_MESHSIMPLIFIER_H
+
+#include <PBR.h>
+
+namespace pbr {
+
+struct Vertex;
+
+// A level of detail is a range of a geometry's index buffer. Its error is how far, in
+// object space units, its surface strays from the full detail one.
+struct MeshLod {
+    std::uint32_t firstIndex = 0;
+    std::uint32_t numIndices = 0;
+    float error = 0.0f;
+};
+
+static_assert(std::is_trivially_copyable_v<MeshLod>);
+
+struct LodOptions {
+    float reduction = 0.5f;          // Triangles each level keeps from the previous one
+    std::uint32_t minTriangles = 64; // No level is simplified below this
+    std::uint32_t maxLods = 8;       // Including the full detail level
+
+    // Largest error of a collapse, relative to the radius of the bounding sphere
+    float maxError = 0.05f;
+};
+
+// Quadric error metric simplification [Garland and Heckbert 1997], "Surface
+// Simplification Using Quadric Error Metrics". Edges collapse into one of their vertices,
+// so every level indexes the same vertices. Vertices on borders and on UV or normal seams
+// never move, and collapses that flip or degenerate triangles are rejected.
+//
+// The coarser levels are appended to indices, each ordered for the vertex cache. Returns
+// every level, the first being the given indices. Stops early when no more collapses are
+// possible within the error bound.
+std::vector<MeshLod> BuildLodChain(std::span<const Vertex> vertices,
+                                   std::vector<unsigned int>& indices,
+                                   const LodOptions& options = {});
+
+} // namespace pbr
+
+#endif
@@ -0,0 +1,103 @@
+#include <Meshlets.h>
+
+#include <Geometry.h>
+
+using namespace pbr;
+using namespace pbr::math;
+
+namespace {
+
+// Sine that makes the cone test always fail
+constexpr float NoCone = 2.0f;
+
+Meshlet Bound(std::span<const Vertex> vertices, std::span<const unsigned int> indices,
+              std::uint32_t first, std::uint32_t last) {
+    BBox3 bbox{{FLOAT_INFINITY}, {-FLOAT_INFINITY}};
+    for (std::uint32_t i = first; i < last; ++i)
+        bbox.expand(vertices[indices[i]].position);
+
+    const Vec3 center = bbox.center();
+    float radius = 0.0f;
+    for (std::uint32_t i = first; i < last; ++i)
+        radius = std::max(radius, (vertices[indices[i]].position - center).length());
+
+    // Unit normals so large triangles don't hide how much small ones turn away
+    std::vector<Vec3> normals;
+    normals.reserve((last - first) / 3);
+    for (std::uint32_t i = first; i < last; i += 3) {
+        const Vec3& p0 = vertices[indices[i]].position;
+        const Vec3 n = Cross(vertices[indices[i + 1]].position - p0,
+                             vertices[indices[i + 2]].position - p0);
+
+        const float length = n.length();
+        if (length > 0.0f)
+            normals.push_back(n / length);
+    }
+
+    Vec3 axis{0.0f};
+    for (const Vec3& n : normals)
+        axis += n;
+
+    float sine = NoCone;
+    const float length = axis.length();
+    if (length > 0.0f) {
+        axis = axis / length;
+
+        float minCos = 1.0f;
+        for (const Vec3& n : normals)
+            minCos = std::min(minCos, Dot(axis, n));
+
+        // Cones of half a sphere or wider face the camera from every side
+        if (minCos > 0.0f)
+            sine = std::sqrt(1.0f - minCos * minCos);
+    }
+
+    return {.sphere = {center, radius},
+            .cone = {axis, sine},
+            .firstIndex = first,
+            .numIndices = last - first,
+            .padding = {}};
+}
+
+} // namespace
+
+std::vector<Meshlet> pbr::BuildMeshlets(std::span<const Vertex> vertices,
+                                        std::span<const unsigned int> indices,
+                                        std::uint32_t firstIndex) {
+    std::vector<Meshlet> meshlets;
+
+    // Meshlet that last used each vertex, to count unique ones without clearing a set
+    std::vector<std::uint32_t> usedBy(vertices.size(), ~std::uint32_t(0));
+    std::uint32_t numMeshlets = 0, numVerts = 0, start = 0;
+
+    for (std::uint32_t i = 0; i < indices.size(); i += 3) {
+        unsigned int added = 0;
+        for (int k = 0; k < 3; ++k)
+            added += usedBy[indices[i + k]] != numMeshlets;
+
+        const std::uint32_t numTris = (i - start) / 3;
+        if (numVerts + added > MeshletMaxVertices || numTris == MeshletMaxTriangles) {
+            meshlets.push_back(Bound(vertices, indices, start, i));
+            ++numMeshlets;
+            numVerts = 0;
+            start = i;
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            auto& user = usedBy[indices[i + k]];
+            if (user != numMeshlets) {
+                user = numMeshlets;
+                ++numVerts;
+            }
+        }
+    }
+
+    if (start < indices.size())
+        meshlets.push_back(
+            Bound(vertices, indices, start, static_cast<std::uint32_t>(indices.size())));
+
+    for (auto& meshlet : meshlets)
+        meshlet.firstIndex += firstIndex;
+
+    return meshlets;
+}
@@ -0,0 +1,37 @@
+#ifndef PBR_MESHLETS_H
+#define PBR_MESHLETS_H
+
+#include <PBR.h>
+#include <PBRMath.h>
+
+namespace pbr {
+
+struct Vertex;
+
+constexpr unsigned int MeshletMaxVertices = 64;
+constexpr unsigned int MeshletMaxTriangles = 124;
+
+// A run of a geometry's triangles small enough to be culled as one. The normal cone
+// bounds the directions its triangles face, in object space.
+// CARE: matches the std430 Meshlet struct in meshletCull.comp, do not change
+struct Meshlet {
+    math::Vec4 sphere;    // Center and radius
+    math::Vec4 cone;      // Axis, and the sine of its half angle. Above 1 it never culls.
+    std::uint32_t firstIndex;
+    std::uint32_t numIndices;
+    std::array<std::uint32_t, 2> padding;
+};
+
+static_assert(sizeof(Meshlet) == 48);
+
+// Splits the triangles, in their current order, into meshlets of at most
+// MeshletMaxVertices unique vertices and MeshletMaxTriangles triangles. Indices ordered
+// for the vertex cache keep neighbouring triangles together, so the meshlets come out
+// compact without reordering anything. Index ranges are offset by firstIndex.
+std::vector<Meshlet> BuildMeshlets(std::span<const Vertex> vertices,
+                                   std::span<const unsigned int> indices,
+                                   std::uint32_t firstIndex = 0);
+
+} // namespace pbr
+
+#endif
@@ -0,0 +1,136 @@
+#include <PackedVertex.h>
+
+#include <Geometry.h>
+#include <JobSystem.h>
+
+#include <bit>
+
+#include <half/half.hpp>
+
+using namespace pbr;
+using namespace pbr::math;
+
+namespace {
+
+// Vertices per job while packing
+constexpr std::size_t GrainVertices = 1 << 14;
+
+std::int16_t ToSnorm16(float v) {
+    return static_cast<std::int16_t>(std::round(std::clamp(v, -1.0f, 1.0f) * 32767.0f));
+}
+
+std::uint16_t ToUnorm16(float v) {
+    return static_cast<std::uint16_t>(std::clamp(v, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+std::uint16_t ToHalf(float v) {
+    return std::bit_cast<std::uint16_t>(half_float::half(v));
+}
+
+Vec2 Octahedral(const Vec3& n) {
+    const float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (l1 == 0.0f)
+        return {0.0f, 0.0f};
+
+    const Vec2 p{n.x / l1, n.y / l1};
+    if (n.z >= 0.0f)
+        return p;
+
+    // The lower half folds over the diagonals
+    auto signNotZero = [](float v) { return v >= 0.0f ? 1.0f : -1.0f; };
+    return {(1.0f - std::abs(p.y)) * signNotZero(p.x),
+            (1.0f - std::abs(p.x)) * signNotZero(p.y)};
+}
+
+template<typename Packed>
+void PackAttributes(const Vertex& vertex, Packed& packed) {
+    packed.normal = EncodeOctahedral(vertex.normal);
+    packed.tangent = EncodeTangent(vertex.tangent);
+    packed.uv = {ToHalf(vertex.uv.x), ToHalf(vertex.uv.y)};
+}
+
+} // namespace
+
+std::size_t pbr::VertexStride(VertexFormat format) {
+    switch (format) {
+    case VertexFormat::Compact:
+        return sizeof(CompactVertex);
+    case VertexFormat::Quantized:
+        return sizeof(QuantizedVertex);
+    default:
+        return sizeof(Vertex);
+    }
+}
+
+std::array<std::int16_t, 2> pbr::EncodeOctahedral(const Vec3& n) {
+    const Vec2 e = Octahedral(n);
+    return {ToSnorm16(e.x), ToSnorm16(e.y)};
+}
+
+std::array<std::int16_t, 2> pbr::EncodeTangent(const Vec4& tangent) {
+    const Vec2 e = Octahedral({tangent.x, tangent.y, tangent.z});
+
+    // Never 0, so the sign survives
+    const auto y = std::max<std::int16_t>(ToSnorm16(e.y * 0.5f + 0.5f), 1);
+    return {ToSnorm16(e.x), static_cast<std::int16_t>(tangent.w < 0.0f ? -y : y)};
+}
+
+std::vector<std::byte> pbr::PackVertices(std::span<const Vertex> vertices,
+                                         VertexFormat format, const BBox3& bbox) {
+    const std::size_t stride = VertexStride(format);
+    std::vector<std::byte> packed(vertices.size() * stride);
+
+    if (format == VertexFormat::Full) {
+        std::memcpy(packed.data(), vertices.data(), packed.size());
+        return packed;
+    }
+
+    // Flat axes quantize to 0
+    const Vec3 sizes = bbox.sizes();
+    const Vec3 invSizes{sizes.x > 0.0f ? 1.0f / sizes.x : 0.0f,
+                        sizes.y > 0.0f ? 1.0f / sizes.y : 0.0f,
+                        sizes.z > 0.0f ? 1.0f / sizes.z : 0.0f};
+
+    auto pack = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t v = begin; v < end; ++v) {
+            const Vertex& vertex = vertices[v];
+            std::byte* out = packed.data() + v * stride;
+
+            if (format == VertexFormat::Compact) {
+                CompactVertex cv;
+                cv.position = vertex.position;
+                PackAttributes(vertex, cv);
+                std::memcpy(out, &cv, sizeof(cv));
+            } else {
+                const Vec3 p = vertex.position - bbox.min();
+
+                QuantizedVertex qv;
+                qv.position = {ToUnorm16(p.x * invSizes.x), ToUnorm16(p.y * invSizes.y),
+                               ToUnorm16(p.z * invSizes.z), 0};
+                PackAttributes(vertex, qv);
+                std::memcpy(out, &qv, sizeof(qv));
+            }
+        }
+    };
+    JobSystem::get().parallelFor(vertices.size(), GrainVertices, pack);
+
+    return packed;
+}
+
+Vec4 pbr::PositionScale(VertexFormat format, const BBox3& bbox) {
+    switch (format) {
+    case VertexFormat::Compact:
+        return {1.0f, 1.0f, 1.0f, 1.0f};
+    case VertexFormat::Quantized:
+        return {bbox.sizes(), 1.0f};
+    default:
+        return {1.0f, 1.0f, 1.0f, 0.0f};
+    }
+}
+
+Vec4 pbr::PositionOffset(VertexFormat format, const BBox3& bbox) {
+    if (format == VertexFormat::Quantized)
+        return {bbox.min(), 0.0f};
+
+    return {0.0f, 0.0f, 0.0f, 0.0f};
+}
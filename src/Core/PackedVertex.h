@@ -0,0 +1,55 @@
+#ifndef PBR_PACKEDVERTEX_H
+#define PBR_PACKEDVERTEX_H
+
+#include <PBR.h>
+#include <PBRMath.h>
+#include <BBox.h>
+
+namespace pbr {
+
+struct Vertex;
+
+// Layout of the vertices a geometry uploads. Full uploads Vertex as it is, 48 bytes.
+// Compact keeps float positions, stores normals and tangents octahedral encoded in two
+// snorm16 each and uvs as halves, 24 bytes. Quantized also stores positions as unorm16
+// over the bounding box of the geometry, 20 bytes.
+enum class VertexFormat : std::uint32_t { Full, Compact, Quantized };
+
+struct CompactVertex {
+    math::Vec3 position;
+    std::array<std::int16_t, 2> normal;
+    std::array<std::int16_t, 2> tangent;
+    std::array<std::uint16_t, 2> uv;
+};
+
+struct QuantizedVertex {
+    std::array<std::uint16_t, 4> position; // w is padding
+    std::array<std::int16_t, 2> normal;
+    std::array<std::int16_t, 2> tangent;
+    std::array<std::uint16_t, 2> uv;
+};
+
+static_assert(sizeof(CompactVertex) == 24);
+static_assert(sizeof(QuantizedVertex) == 20);
+
+std::size_t VertexStride(VertexFormat format);
+
+// Unit vector folded onto an octahedron and unwrapped to the [-1, 1] square
+std::array<std::int16_t, 2> EncodeOctahedral(const math::Vec3& n);
+
+// Tangents also carry the sign of their bitangent: y is remapped to [0, 1] and takes the
+// sign, at the cost of one bit of precision
+std::array<std::int16_t, 2> EncodeTangent(const math::Vec4& tangent);
+
+// Vertices in the given format, ready to upload. Positions are quantized over bbox.
+std::vector<std::byte> PackVertices(std::span<const Vertex> vertices, VertexFormat format,
+                                    const math::BBox3& bbox);
+
+// Maps stored positions back to object space as position * scale + offset. The w of the
+// scale is 1 when normals and tangents are octahedral encoded.
+math::Vec4 PositionScale(VertexFormat format, const math::BBox3& bbox);
+math::Vec4 PositionOffset(VertexFormat format, const math::BBox3& bbox);
+
+} // namespace pbr
+
+#endif
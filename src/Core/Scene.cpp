@@ -1,32 +1,39 @@
 #include <Scene.h>
 
+#include <JobSystem.h>
 #include <Shape.h>
 #include <Skybox.h>
 #include <Ray.h>
 
 using namespace pbr;
 
-std::optional<Shape*> Scene::intersect(const Ray& ray) {
-    std::optional<Shape*> obj = std::nullopt;
+std::optional<SceneHit> Scene::intersect(const Ray& ray) {
+    updateShapeBVH();
+
+    std::optional<SceneHit> sceneHit = std::nullopt;
+
+    auto intersectShape = [&](std::uint32_t s, float tMax) -> std::optional<float> {
+        auto hit = _shapes[s]->intersect(ray, tMax);
+        if (!hit)
+            return std::nullopt;
+
+        sceneHit = SceneHit{_shapes[s].get(), *hit};
+        return hit->t;
+    };
 
     float tMax = FLOAT_INFINITY;
-    for (const auto& shape : _shapes) {
-        if (auto t = shape->intersect(ray, tMax)) {
-            tMax = std::min(tMax, *t);
-            obj = shape.get();
-        }
-    }
-
-    return obj;
+    _shapeBVH.traverse(ray, tMax, intersectShape);
+
+    return sceneHit;
 }
 
-void Scene::sortShapes(const Vec3& pos) {
-    std::sort(_shapes.begin(), _shapes.end(),
-              [&pos](const sref<Shape>& a, const sref<Shape>& b) -> bool {
-                  float distA = (a->position() - pos).lengthSqr();
-                  float distB = (b->position() - pos).lengthSqr();
-                  return distA < distB;
-              });
+void Scene::updateShapeBVH() {
+    if (_shapesAdded)
+        _shapeBVH.build(_shapeBounds);
+    else if (_shapesMoved)
+        _shapeBVH.refit(_shapeBounds);
+
+    _shapesAdded = _shapesMoved = false;
 }
 
 void Scene::addCamera(const sref<Camera>& camera) {
@@ -34,8 +41,30 @@ void Scene::addCamera(const sref<Camera>& camera) {
 }
 
 void Scene::addShape(const sref<Shape>& shape) {
-    _bbox.expand(shape->bbox());
+    shape->attach(*_transforms);
     _shapes.push_back(shape);
+    _shapeBounds.push_back(shape->bbox());
+    _bbox.expand(_shapeBounds.back());
+
+    _shapesAdded = true;
+    ++_boundsVersion;
+}
+
+std::size_t Scene::updateTransforms() {
+    const std::size_t numUpdated = _transforms->update();
+    if (numUpdated == 0)
+        return 0;
+
+    auto& jobs = JobSystem::get();
+    jobs.parallelFor(_shapes.size(), 1024, [this](std::size_t begin, std::size_t end) {
+        for (std::size_t s = begin; s < end; ++s)
+            _shapeBounds[s] = _shapes[s]->bbox();
+    });
+
+    _shapesMoved = true;
+    ++_boundsVersion;
+
+    return numUpdated;
 }
 
 void Scene::addLight(const sref<Light>& light) {
@@ -58,6 +87,18 @@ const std::vector<sref<Light>>& Scene::lights() const {
     return _lights;
 }
 
+std::span<const BBox3> Scene::shapeBounds() const {
+    return _shapeBounds;
+}
+
+std::uint64_t Scene::boundsVersion() const {
+    return _boundsVersion;
+}
+
+const BBox3& Scene::bbox() const {
+    return _bbox;
+}
+
 const Skybox& Scene::skybox() const {
     return *_skybox;
 }
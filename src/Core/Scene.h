@@ -3,25 +3,28 @@
 
 #include <PBR.h>
 #include <BBox.h>
+#include <BVH.h>
+#include <Ray.h>
+#include <TransformGraph.h>
 #include <optional>
 
 using namespace pbr::math;
 
 namespace pbr {
-namespace math {
-
-class Ray;
-
-}
 
 class Camera;
 class Shape;
 class Light;
 class Skybox;
 
+struct SceneHit {
+    Shape* shape;
+    TriangleHit hit;
+};
+
 class Scene {
 public:
-    std::optional<Shape*> intersect(const Ray& ray);
+    std::optional<SceneHit> intersect(const Ray& ray);
 
     void addCamera(const sref<Camera>& camera);
     void addShape(const sref<Shape>& shape);
@@ -29,18 +32,39 @@ public:
 
     void setEnvironment(const Skybox& skybox);
 
+    // Propagates transform changes made since the last call
+    std::size_t updateTransforms();
+
     const std::vector<sref<Camera>>& cameras() const;
     const std::vector<sref<Shape>>& shapes() const;
     const std::vector<sref<Light>>& lights() const;
 
+    // World bounds of each shape, refreshed by updateTransforms(). The version changes
+    // whenever any of them does.
+    std::span<const BBox3> shapeBounds() const;
+    std::uint64_t boundsVersion() const;
+
+    const BBox3& bbox() const;
+
     bool hasSkybox() const;
     const Skybox& skybox() const;
 
-    void sortShapes(const Vec3& pos);
-
 private:
     BBox3 _bbox{Vec3{0}};
 
+    // Heap allocated so attached shapes stay valid when the scene is moved
+    std::unique_ptr<TransformGraph> _transforms = std::make_unique<TransformGraph>();
+
+    // Top level BVH over shape world bounds. Rebuilt when shapes are added and refit
+    // when transforms change.
+    void updateShapeBVH();
+
+    BVH _shapeBVH;
+    std::vector<BBox3> _shapeBounds;
+    std::uint64_t _boundsVersion = 0;
+    bool _shapesAdded = false;
+    bool _shapesMoved = false;
+
     std::vector<sref<Camera>> _cameras;
     std::vector<sref<Shape>> _shapes;
     std::vector<sref<Light>> _lights;
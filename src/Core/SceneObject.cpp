@@ -26,6 +26,8 @@ const Quat& SceneObject::orientation() const {
 }
 
 const Mat4& SceneObject::objToWorld() const {
+    if (_graph)
+        return _graph->world(_node);
     return _objToWorld;
 }
 
@@ -33,25 +35,56 @@ sref<SceneObject> SceneObject::parent() const {
     return _parent;
 }
 
+void SceneObject::setParent(const sref<SceneObject>& parent) {
+    DCHECK(!isAttached());
+    _parent = parent;
+}
+
+Mat4 SceneObject::localMatrix() const {
+    return Translation(_position) * Mat4(_orientation) * Scale(_scale);
+}
+
 void SceneObject::updateMatrix() {
-    _objToWorld = Translation(_position) * Mat4(_orientation) * Scale(_scale);
+    _objToWorld = localMatrix();
+}
+
+void SceneObject::attach(TransformGraph& graph) {
+    DCHECK(!isAttached());
+
+    TransformNode parentNode = NullNode;
+    if (_parent) {
+        CHECK(_parent->_graph == &graph);
+        parentNode = _parent->_node;
+    }
+
+    _node = graph.add(*this, _objToWorld, parentNode);
+    _graph = &graph;
+}
+
+void SceneObject::markDirty() {
+    if (_graph)
+        _graph->markDirty(_node);
 }
 
 void SceneObject::setPosition(const Vec3& position) {
     _position = position;
+    markDirty();
 }
 
 void SceneObject::setScale(float x, float y, float z) {
     _scale = {x, y, z};
+    markDirty();
 }
 
 void SceneObject::setOrientation(const Quat& quat) {
     _orientation = quat;
+    markDirty();
 }
 
 void SceneObject::setObjToWorld(const Matrix4x4& mat) {
     _objToWorld = mat;
     decomposeTransform();
+    markDirty();
 }
 
 void SceneObject::decomposeTransform() {
@@ -3,6 +3,7 @@
 
 #include <PBR.h>
 #include <PBRMath.h>
+#include <TransformGraph.h>
 
 using namespace pbr::math;
 
@@ -21,17 +22,32 @@ public:
     const Mat4& objToWorld() const;
 
     sref<SceneObject> parent() const;
+    void setParent(const sref<SceneObject>& parent);
 
     void setPosition(const Vec3& position);
     void setScale(float x, float y, float z);
     void setOrientation(const Quat& quat);
     void setObjToWorld(const Matrix4x4& mat);
 
+    // Transform relative to the parent, built from position, orientation and scale
+    Mat4 localMatrix() const;
+
+    // Objects that are not part of a graph must call this after changing transforms
     virtual void updateMatrix();
 
+    // Hands the world matrix over to the graph, which recomputes it only when this
+    // object or one of its ancestors changes. The parent must already be attached.
+    void attach(TransformGraph& graph);
+    bool isAttached() const { return _graph != nullptr; }
+
 protected:
+    void markDirty();
+
     sref<SceneObject> _parent = nullptr;
-    
+
+    TransformGraph* _graph = nullptr;
+    TransformNode _node = NullNode;
+
     Quat _orientation;
     Vec3 _scale{1};
     Vec3 _position;
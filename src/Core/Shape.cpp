@@ -1,11 +1,25 @@
 #include <Shape.h>
 
-#include <RenderInterface.h>
 #include <Geometry.h>
 #include <Material.h>
 
 using namespace pbr;
 
+namespace {
+
+// Fraction of the pixel error threshold a coarser level must fit under to be picked
+constexpr float LodHysteresis = 0.75f;
+
+// Largest scale along the axes of a transform
+float MaxScale(const Mat4& m) {
+    float scale = 0.0f;
+    for (unsigned int c = 0; c < 3; ++c)
+        scale = std::max(scale, Vec3{m(0, c), m(1, c), m(2, c)}.length());
+    return scale;
+}
+
+} // namespace
+
 Shape::Shape(const Vec3& position) : SceneObject(position) {
     updateMatrix();
 }
@@ -27,6 +41,8 @@ void Shape::updateMatrix() {
 }
 
 const Mat3& Shape::normalMatrix() const {
+    if (_graph)
+        return _graph->normal(_node);
     return _normalMatrix;
 }
 
@@ -34,14 +50,30 @@ void Shape::setMaterial(const sref<Material>& mat) {
     _material = mat;
 }
 
-void Shape::draw() {
-    updateMatrix();
+unsigned int Shape::selectLod(const Vec3& eye, float pixelsPerUnit, float maxPixelError) {
+    const unsigned int current = std::exchange(_lod, 0);
+    if (_geometry->numLods() <= 1 || maxPixelError <= 0.0f)
+        return _lod;
+
+    // Bounds are in object space
+    const Mat4& toWorld = objToWorld();
+    const BSphere sphere = bSphere();
+    const float scale = MaxScale(toWorld);
+    const Vec3 center{toWorld * Vec4(sphere.center(), 1.0f)};
 
-    _material->use();
+    const float dist = (center - eye).length() - sphere.radius() * scale;
+    if (dist <= 0.0f)
+        return _lod;
 
-    RHI.setMatrix4(MODEL_MATRIX, objToWorld());
-    RHI.setMatrix3(NORMAL_MATRIX, normalMatrix());
+    const float pixelsPerError = pixelsPerUnit * scale / dist;
+    for (unsigned int l = 1; l < _geometry->numLods(); ++l) {
+        const float threshold =
+            l > current ? maxPixelError * LodHysteresis : maxPixelError;
+        if (_geometry->lod(l).error * pixelsPerError > threshold)
+            break;
 
-    _material->uploadData();
-    _geometry->draw();
-}
\ No newline at end of file
+        _lod = l;
+    }
+
+    return _lod;
+}
@@ -2,22 +2,16 @@
 #define PBR_SHAPE_H
 
 #include <BBox.h>
+#include <Ray.h>
 #include <SceneObject.h>
 
 using namespace pbr::math;
 
 namespace pbr {
-namespace math {
-
-class Ray;
-
-} // namespace math
 
 class Material;
 class Geometry;
 
-enum ShapeUniform : unsigned int { MODEL_MATRIX = 20, NORMAL_MATRIX = 21 };
-
 class Shape : public SceneObject {
 public:
     Shape() = default;
@@ -27,7 +21,6 @@ public:
     virtual ~Shape() = default;
 
     virtual void prepare(){};
-    virtual void draw();
 
     const sref<Material>& material() const;
     const sref<Geometry>& geometry() const;
@@ -37,17 +30,27 @@ public:
     virtual BBox3 bbox() const = 0;
     virtual BSphere bSphere() const = 0;
 
-    virtual std::optional<float> intersect(const Ray& ray, float tMax) const = 0;
+    // Closest hit along a world space ray, t is measured in units of the ray direction
+    virtual std::optional<TriangleHit> intersect(const Ray& ray, float tMax) const = 0;
 
     void updateMatrix() override;
 
     void setMaterial(const sref<Material>& mat);
 
+    // Picks the coarsest level of detail of the geometry whose error, projected at the
+    // bounding sphere's closest point, spans at most maxPixelError pixels. pixelsPerUnit
+    // is the projected size of one unit at unit distance. A coarser level than the
+    // current one must fit under a lower threshold, so shapes hovering around a switching
+    // distance don't alternate between two levels every frame.
+    unsigned int selectLod(const Vec3& eye, float pixelsPerUnit, float maxPixelError);
+    unsigned int lod() const { return _lod; }
+
 protected:
     sref<Geometry> _geometry = nullptr;
     sref<Material> _material = nullptr;
 
     Mat3 _normalMatrix;
+    unsigned int _lod = 0;
 };
 
 } // namespace pbr
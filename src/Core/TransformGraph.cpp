@@ -0,0 +1,61 @@
+#include <TransformGraph.h>
+
+#include <SceneObject.h>
+
+using namespace pbr;
+
+namespace {
+
+Mat3 NormalMatrix(const Mat4& world) {
+    return Transpose(Inverse(Mat3(world)));
+}
+
+} // namespace
+
+TransformNode TransformGraph::add(SceneObject& object, const Mat4& local,
+                                  TransformNode parent) {
+    DCHECK(parent == NullNode || parent < _objects.size());
+
+    const Mat4 world = parent != NullNode ? _world[parent] * local : local;
+
+    _objects.push_back(&object);
+    _parents.push_back(parent);
+    _world.push_back(world);
+    _normal.push_back(NormalMatrix(world));
+    _dirty.push_back(0);
+
+    return _objects.size() - 1;
+}
+
+void TransformGraph::markDirty(TransformNode node) {
+    DCHECK_LT(node, _dirty.size());
+    _dirty[node] = 1;
+    _anyDirty = true;
+}
+
+std::size_t TransformGraph::update() {
+    if (!_anyDirty)
+        return 0;
+
+    std::size_t numUpdated = 0;
+    for (std::size_t n = 0; n < _objects.size(); ++n) {
+        const auto parent = _parents[n];
+
+        // Parents come first, so their flag is final by the time children are visited
+        if (parent != NullNode && _dirty[parent])
+            _dirty[n] = 1;
+
+        if (!_dirty[n])
+            continue;
+
+        const Mat4 local = _objects[n]->localMatrix();
+        _world[n] = parent != NullNode ? _world[parent] * local : local;
+        _normal[n] = NormalMatrix(_world[n]);
+        ++numUpdated;
+    }
+
+    std::fill(_dirty.begin(), _dirty.end(), 0);
+    _anyDirty = false;
+
+    return numUpdated;
+}
@@ -0,0 +1,48 @@
+#ifndef PBR_TRANSFORMGRAPH_H
+#define PBR_TRANSFORMGRAPH_H
+
+#include <PBR.h>
+#include <PBRMath.h>
+
+using namespace pbr::math;
+
+namespace pbr {
+
+class SceneObject;
+
+using TransformNode = std::uint32_t;
+constexpr TransformNode NullNode = ~TransformNode(0);
+
+// Cached world and normal matrices of a transform hierarchy, stored as parallel arrays.
+// Nodes are appended after their parent, so a single forward pass over the arrays
+// propagates changes from parents to children. Only dirty nodes and their descendants
+// are recomputed.
+class TransformGraph {
+public:
+    TransformNode add(SceneObject& object, const Mat4& local,
+                      TransformNode parent = NullNode);
+
+    void markDirty(TransformNode node);
+
+    // Returns the number of nodes that were recomputed
+    std::size_t update();
+
+    const Mat4& world(TransformNode node) const { return _world[node]; }
+    const Mat3& normal(TransformNode node) const { return _normal[node]; }
+    TransformNode parent(TransformNode node) const { return _parents[node]; }
+
+    std::size_t size() const { return _objects.size(); }
+
+private:
+    std::vector<SceneObject*> _objects;
+    std::vector<TransformNode> _parents;
+    std::vector<Mat4> _world;
+    std::vector<Mat3> _normal;
+    std::vector<std::uint8_t> _dirty;
+
+    bool _anyDirty = false;
+};
+
+} // namespace pbr
+
+#endif
@@ -8,7 +8,8 @@ using namespace std::chrono_literals;
 
 namespace {
 const std::array OglBufferTarget = {GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER,
-                                    GL_UNIFORM_BUFFER};
+                                    GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER,
+                                    GL_PIXEL_UNPACK_BUFFER, GL_PIXEL_PACK_BUFFER};
 
 constexpr nanoseconds FenceTimeout = 33ms;
 } // namespace
@@ -48,9 +49,15 @@ void Buffer::create(BufferType type, std::size_t pSize, BufferFlag pFlags,
     glCreateBuffers(1, &handle);
     glNamedBufferStorage(handle, size, data, static_cast<GLbitfield>(flags));
 
-    if (HasFlag(flags, BufferFlag::Persistent))
+    if (HasFlag(flags, BufferFlag::Persistent)) {
+        // Storage only bits like Dynamic and ClientStorage aren't valid for mapping
+        const auto access = flags & (BufferFlag::Read | BufferFlag::Write |
+                                     BufferFlag::Persistent | BufferFlag::Coherent);
         ptr = reinterpret_cast<std::byte*>(
-            glMapNamedBufferRange(handle, 0, size, static_cast<GLbitfield>(flags)));
+            glMapNamedBufferRange(handle, 0, size, static_cast<GLbitfield>(access)));
+        if (!ptr)
+            LOG_ERROR("Failed to map buffer storage.");
+    }
 }
 
 void Buffer::bindRange(unsigned int index, std::size_t offset, std::size_t bSize) const {
@@ -58,11 +65,23 @@ void Buffer::bindRange(unsigned int index, std::size_t offset, std::size_t bSize
 }
 
 void SyncedBuffer::wait(GLsync* pSync) {
-    GLenum res = glClientWaitSync(*pSync, 0, FenceTimeout.count());
-    if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED)
-        glDeleteSync(*pSync);
-    else
+    // Ranges are reused as soon as this returns, so keep waiting past the timeout
+    GLbitfield waitFlags = 0;
+    for (;;) {
+        GLenum res = glClientWaitSync(*pSync, waitFlags, FenceTimeout.count());
+        if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED)
+            break;
+
+        if (res == GL_WAIT_FAILED) {
+            LOG_ERROR("Failed waiting on buffer fence.");
+            break;
+        }
+
         LOGD("Fence timeout expired.");
+        waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    }
+
+    glDeleteSync(*pSync);
 }
 
 void SyncedBuffer::waitRange(std::size_t start, std::size_t pSize) {
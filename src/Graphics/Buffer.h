@@ -7,7 +7,14 @@
 
 namespace pbr {
 
-enum class BufferType : unsigned int { Array = 0, Element = 1, Uniform = 2 };
+enum class BufferType : unsigned int {
+    Array = 0,
+    Element = 1,
+    Uniform = 2,
+    ShaderStorage = 3,
+    PixelUnpack = 4,
+    PixelPack = 5
+};
 consteval bool EnableConversion(BufferType);
 
 enum class BufferFlag : unsigned int {
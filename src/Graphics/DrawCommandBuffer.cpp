@@ -0,0 +1,69 @@
+#include <DrawCommandBuffer.h>
+
+#include <Geometry.h>
+#include <Renderer.h>
+
+using namespace pbr;
+
+namespace {
+
+constexpr std::size_t MinCommands = 4096;
+constexpr std::size_t MinCounts = 64;
+
+} // namespace
+
+void DrawCommandBuffer::clear() {
+    _numCommands = 0;
+    _numCounts = 0;
+    _numCleared = 0;
+}
+
+DrawRange DrawCommandBuffer::allocate(std::size_t maxCommands) {
+    const DrawRange range{.firstCommand = _numCommands,
+                          .maxCommands = static_cast<std::uint32_t>(maxCommands),
+                          .countSlot = _numCounts++};
+    _numCommands += maxCommands;
+
+    return range;
+}
+
+void DrawCommandBuffer::prepare() {
+    if (_numCommands > _commandCapacity) {
+        _commandCapacity = std::max({_numCommands, 2 * _commandCapacity, MinCommands});
+        _commands = std::make_unique<Buffer>(BufferType::ShaderStorage,
+                                             _commandCapacity * sizeof(DrawCommand));
+    }
+
+    // Ranges of earlier passes were already drawn, their counts aren't needed anymore
+    if (_numCounts > _countCapacity) {
+        _countCapacity =
+            std::max<std::size_t>({_numCounts, 2 * _countCapacity, MinCounts});
+        _counts = std::make_unique<Buffer>(BufferType::ShaderStorage,
+                                           _countCapacity * sizeof(std::uint32_t));
+    }
+
+    if (_numCounts > _numCleared) {
+        glClearNamedBufferSubData(_counts->id(), GL_R32UI,
+                                  _numCleared * sizeof(std::uint32_t),
+                                  (_numCounts - _numCleared) * sizeof(std::uint32_t),
+                                  GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        _numCleared = _numCounts;
+    }
+
+    if (_numCommands > 0)
+        _commands->bindRange(DRAW_COMMAND_BUFFER, 0, _numCommands * sizeof(DrawCommand));
+    if (_numCounts > 0)
+        _counts->bindRange(DRAW_COUNT_BUFFER, 0, _numCounts * sizeof(std::uint32_t));
+}
+
+void DrawCommandBuffer::bind() const {
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commands ? _commands->id() : 0);
+    glBindBuffer(GL_PARAMETER_BUFFER, _counts ? _counts->id() : 0);
+}
+
+void DrawCommandBuffer::draw(const Geometry& geometry, const DrawRange& range) const {
+    geometry.submitIndirect(range.firstCommand * sizeof(DrawCommand),
+                            range.countSlot * sizeof(std::uint32_t), range.maxCommands);
+}
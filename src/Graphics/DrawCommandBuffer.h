@@ -0,0 +1,70 @@
+#ifndef PBR_DRAWCOMMANDBUFFER_H
+#define PBR_DRAWCOMMANDBUFFER_H
+
+#include <PBR.h>
+#include <Buffer.h>
+
+namespace pbr {
+
+class Geometry;
+
+// Matches DrawElementsIndirectCommand, and the DrawCommand struct of the cull shaders
+struct DrawCommand {
+    std::uint32_t count;
+    std::uint32_t instanceCount;
+    std::uint32_t firstIndex;
+    std::int32_t baseVertex;
+    std::uint32_t baseInstance;
+};
+
+// Commands a cull pass may append for one draw, and the slot of their count
+struct DrawRange {
+    std::size_t firstCommand;
+    std::uint32_t maxCommands;
+    std::uint32_t countSlot;
+};
+
+// State of each instance through the occlusion passes, see OcclusionCuller. Cull passes
+// gated on a state only look at the instances in it, Any looks at all.
+enum class Visibility : std::uint32_t {
+    Any = 0,
+    Early = 1,    // Drawn by the first pass
+    Occluded = 2, // Left for the second pass
+    Late = 3,     // Drawn by the second pass
+    Hidden = 4
+};
+consteval bool EnableConversion(Visibility);
+
+// Indirect draw commands written by cull passes on the GPU. Ranges are sized on the CPU
+// for the most commands a pass could write, and the pass appends to them through a count
+// the draw then reads its length from, so nothing is read back. Storage is grown on
+// demand, the GPU orders later writes after the draws that read them.
+class DrawCommandBuffer {
+public:
+    void clear();
+    DrawRange allocate(std::size_t maxCommands);
+
+    // Grows the storage for the ranges allocated so far, zeroes the counts of the ones
+    // allocated since the last call, and binds both for the cull shaders
+    void prepare();
+
+    // Waits for the cull passes and binds the commands and counts for the draws
+    void bind() const;
+
+    // The geometry must be bound
+    void draw(const Geometry& geometry, const DrawRange& range) const;
+
+private:
+    std::size_t _numCommands = 0;
+    std::uint32_t _numCounts = 0;
+    std::uint32_t _numCleared = 0;
+
+    std::unique_ptr<Buffer> _commands = nullptr;
+    std::unique_ptr<Buffer> _counts = nullptr;
+    std::size_t _commandCapacity = 0;
+    std::size_t _countCapacity = 0;
+};
+
+} // namespace pbr
+
+#endif
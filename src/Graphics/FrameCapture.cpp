@@ -0,0 +1,230 @@
+#include <FrameCapture.h>
+
+#include <Image.h>
+#include <Utils.h>
+
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+using namespace pbr;
+using namespace pbr::util;
+
+namespace {
+
+// Frames waiting on the encoder before the render thread helps encoding
+constexpr std::uint32_t MaxPendingEncodes = 8;
+
+constexpr int CaptureChannels = 3;
+
+std::size_t FrameSize(int width, int height) {
+    return static_cast<std::size_t>(width) * height * CaptureChannels;
+}
+
+} // namespace
+
+// Frames may finish encoding out of order, each one is written at its own offset
+struct FrameCapture::RawStream {
+    std::mutex mutex;
+    std::ofstream file;
+    std::size_t frameSize = 0;
+};
+
+FrameCapture::~FrameCapture() {
+    JobSystem::get().wait(encodeJobs, JobPriority::Background);
+}
+
+void FrameCapture::snapshot(const fs::path& path) {
+    snapshots.push_back(path);
+}
+
+void FrameCapture::startSequence(const fs::path& path) {
+    stopSequence();
+
+    sequence = {};
+    sequence.active = true;
+    sequence.path = path;
+    if (path.extension() != ".raw") {
+        std::error_code error;
+        fs::create_directories(path, error);
+        if (error) {
+            LOG_ERROR("Couldn't create capture directory {}: {}", path.string(),
+                      error.message());
+            sequence.active = false;
+            return;
+        }
+    }
+
+    LOGI("Capturing frames to {}", path.string());
+}
+
+void FrameCapture::stopSequence() {
+    if (!sequence.active)
+        return;
+
+    LOGI("Captured {} frames to {}", sequence.frame, sequence.path.string());
+    sequence = {};
+}
+
+void FrameCapture::update(int width, int height) {
+    if (!slots.empty() && (width != slotWidth || height != slotHeight)) {
+        // Frames in flight have the old size
+        while (retire(true)) {}
+        slots.clear();
+        slotWidth = slotHeight = 0;
+
+        if (sequence.raw) {
+            LOGW("Framebuffer resized, raw capture stopped");
+            stopSequence();
+        }
+    }
+
+    while (retire(false)) {}
+
+    if (snapshots.empty() && !sequence.active)
+        return;
+
+    if (slots.empty())
+        allocate(width, height);
+
+    for (auto& path : snapshots) {
+        Request request;
+        request.path = std::move(path);
+        readback(std::move(request));
+    }
+    snapshots.clear();
+
+    if (sequence.active) {
+        Request request;
+        request.frame = sequence.frame++;
+        if (sequence.path.extension() == ".raw") {
+            if (!sequence.raw) {
+                sequence.raw = std::make_shared<RawStream>();
+                sequence.raw->file.open(sequence.path, std::ios::binary);
+                sequence.raw->frameSize = FrameSize(width, height);
+                if (sequence.raw->file.fail()) {
+                    LOG_ERROR("Couldn't open capture output {}.", sequence.path.string());
+                    stopSequence();
+                    return;
+                }
+
+                LOGI("Raw capture is {}x{} rgb24", width, height);
+            }
+
+            request.raw = sequence.raw;
+        } else {
+            request.path = sequence.path / std::format("frame_{:05}.png", request.frame);
+        }
+
+        readback(std::move(request));
+    }
+}
+
+void FrameCapture::finish() {
+    while (retire(true)) {}
+    JobSystem::get().wait(encodeJobs, JobPriority::Background);
+}
+
+void FrameCapture::allocate(int width, int height) {
+    const BufferFlag flags = BufferFlag::Read | BufferFlag::Persistent |
+                             BufferFlag::Coherent | BufferFlag::ClientStorage;
+
+    slots.resize(NumSlots);
+    for (Slot& slot : slots)
+        slot.pbo.create(BufferType::PixelPack, FrameSize(width, height), flags, nullptr);
+
+    slotWidth = width;
+    slotHeight = height;
+    next = 0;
+    inFlight = 0;
+}
+
+void FrameCapture::readback(Request request) {
+    // Only waits if the oldest readback, NumSlots frames back, hasn't finished yet
+    if (inFlight == slots.size())
+        retire(true);
+
+    GLint readFbo = 0, sampleBuffers = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFbo);
+    glGetNamedFramebufferParameteriv(readFbo, GL_SAMPLE_BUFFERS, &sampleBuffers);
+
+    if (sampleBuffers > 0) {
+        if (resolveTarget.width() != slotWidth || resolveTarget.height() != slotHeight)
+            resolveTarget.create(slotWidth, slotHeight);
+
+        glBlitNamedFramebuffer(readFbo, resolveTarget.id(), 0, 0, slotWidth, slotHeight,
+                               0, 0, slotWidth, slotHeight, GL_COLOR_BUFFER_BIT,
+                               GL_NEAREST);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, resolveTarget.id());
+    }
+
+    Slot& slot = slots[next];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo.id());
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, slotWidth, slotHeight, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (sampleBuffers > 0)
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, readFbo);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.request = std::move(request);
+
+    next = (next + 1) % slots.size();
+    ++inFlight;
+}
+
+bool FrameCapture::retire(bool block) {
+    if (inFlight == 0)
+        return false;
+
+    Slot& slot = slots[(next + slots.size() - inFlight) % slots.size()];
+
+    const GLuint64 timeout = block ? GL_TIMEOUT_IGNORED : 0;
+    const GLbitfield flags = block ? GL_SYNC_FLUSH_COMMANDS_BIT : 0;
+    const GLenum res = glClientWaitSync(slot.fence, flags, timeout);
+    if (res == GL_TIMEOUT_EXPIRED)
+        return false;
+
+    if (res == GL_WAIT_FAILED)
+        LOG_ERROR("Failed waiting on frame capture fence.");
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    --inFlight;
+
+    // GL rows start at the bottom
+    Image image{{PixelFormat::U8, slotWidth, slotHeight, CaptureChannels}, 1};
+    const std::size_t rowSize = FrameSize(slotWidth, 1);
+    const auto* src = slot.pbo.get<const std::byte>();
+    std::byte* dst = image.data();
+    for (int y = 0; y < slotHeight; ++y)
+        std::memcpy(dst + y * rowSize, src + (slotHeight - 1 - y) * rowSize, rowSize);
+
+    // The render thread helps out when the encoder can't keep up
+    if (pendingEncodes.load(std::memory_order_relaxed) >= MaxPendingEncodes)
+        JobSystem::get().wait(encodeJobs, JobPriority::Background);
+
+    pendingEncodes.fetch_add(1, std::memory_order_relaxed);
+    JobSystem::get().submit(
+        [this, request = std::move(slot.request), image = std::move(image)]() mutable {
+            encode(std::move(request), std::move(image));
+            pendingEncodes.fetch_sub(1, std::memory_order_relaxed);
+        },
+        &encodeJobs, JobPriority::Background);
+
+    return true;
+}
+
+void FrameCapture::encode(Request request, Image image) {
+    if (!request.raw) {
+        SaveImage(request.path, image);
+        return;
+    }
+
+    RawStream& raw = *request.raw;
+    std::scoped_lock lock{raw.mutex};
+    raw.file.seekp(static_cast<std::streamoff>(request.frame * raw.frameSize));
+    raw.file.write(reinterpret_cast<const char*>(image.data()), image.size());
+}
@@ -0,0 +1,93 @@
+#ifndef PBR_FRAMECAPTURE_H
+#define PBR_FRAMECAPTURE_H
+
+#include <PBR.h>
+#include <Buffer.h>
+#include <Framebuffer.h>
+#include <JobSystem.h>
+
+#include <atomic>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace pbr {
+
+class Image;
+
+// Reads the framebuffer back without stalling. Frames are copied into a ring of
+// persistently mapped pixel pack buffers and fenced, and are only read a few frames
+// later once the fence has signaled. The rows are flipped into an image that a job
+// encodes, so the render thread never waits on the GPU or the encoder unless
+// encoding falls behind.
+class FrameCapture {
+public:
+    FrameCapture() = default;
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Saves the next frame as PNG
+    void snapshot(const fs::path& path);
+
+    // Captures every frame until stopped. A .raw path is written as one headerless
+    // RGB24 video stream, anything else is a directory of numbered PNG files.
+    void startSequence(const fs::path& path);
+    void stopSequence();
+    bool recording() const { return sequence.active; }
+
+    // Called once per frame after drawing, on the thread owning the context
+    void update(int width, int height);
+
+    // Blocks until every captured frame has been written
+    void finish();
+
+    static constexpr std::size_t NumSlots = 3;
+
+private:
+    struct RawStream;
+
+    struct Request {
+        fs::path path;
+        std::shared_ptr<RawStream> raw;
+        std::uint64_t frame = 0;
+    };
+
+    struct Slot {
+        Buffer pbo;
+        GLsync fence = nullptr;
+        Request request;
+    };
+
+    struct Sequence {
+        bool active = false;
+        fs::path path;
+        std::shared_ptr<RawStream> raw;
+        std::uint64_t frame = 0;
+    };
+
+    void allocate(int width, int height);
+    void readback(Request request);
+    bool retire(bool block);
+    void encode(Request request, Image image);
+
+    std::vector<Slot> slots;
+    std::size_t next = 0;
+    std::size_t inFlight = 0;
+    int slotWidth = 0;
+    int slotHeight = 0;
+
+    // Multisampled framebuffers are resolved into this one before reading
+    Framebuffer resolveTarget;
+
+    std::vector<fs::path> snapshots;
+    Sequence sequence;
+
+    JobCounter encodeJobs;
+    std::atomic<std::uint32_t> pendingEncodes = 0;
+};
+
+} // namespace pbr
+
+#endif
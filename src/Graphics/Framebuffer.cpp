@@ -0,0 +1,74 @@
+#include <Framebuffer.h>
+
+#include <glad/glad.h>
+
+using namespace pbr;
+
+Framebuffer::Framebuffer(int width, int height, int samples) {
+    create(width, height, samples);
+}
+
+Framebuffer::~Framebuffer() {
+    release();
+}
+
+Framebuffer::Framebuffer(Framebuffer&& rhs)
+    : handle(std::exchange(rhs.handle, 0)), colorHandle(std::exchange(rhs.colorHandle, 0)),
+      depthHandle(std::exchange(rhs.depthHandle, 0)), fbWidth(rhs.fbWidth),
+      fbHeight(rhs.fbHeight) {}
+
+Framebuffer& Framebuffer::operator=(Framebuffer&& rhs) {
+    release();
+    handle = std::exchange(rhs.handle, 0);
+    colorHandle = std::exchange(rhs.colorHandle, 0);
+    depthHandle = std::exchange(rhs.depthHandle, 0);
+    fbWidth = rhs.fbWidth;
+    fbHeight = rhs.fbHeight;
+    return *this;
+}
+
+void Framebuffer::create(int width, int height, int samples) {
+    release();
+
+    fbWidth = width;
+    fbHeight = height;
+
+    glCreateRenderbuffers(1, &colorHandle);
+    glCreateRenderbuffers(1, &depthHandle);
+    if (samples > 1) {
+        glNamedRenderbufferStorageMultisample(colorHandle, samples, GL_RGBA8, width,
+                                              height);
+        glNamedRenderbufferStorageMultisample(depthHandle, samples, GL_DEPTH_COMPONENT24,
+                                              width, height);
+    } else {
+        glNamedRenderbufferStorage(colorHandle, GL_RGBA8, width, height);
+        glNamedRenderbufferStorage(depthHandle, GL_DEPTH_COMPONENT24, width, height);
+    }
+
+    glCreateFramebuffers(1, &handle);
+    glNamedFramebufferRenderbuffer(handle, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                                   colorHandle);
+    glNamedFramebufferRenderbuffer(handle, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER,
+                                   depthHandle);
+
+    GLenum status = glCheckNamedFramebufferStatus(handle, GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+        FATAL("Incomplete framebuffer (status 0x{:x}).", status);
+}
+
+void Framebuffer::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, handle);
+}
+
+void Framebuffer::release() {
+    if (handle != 0)
+        glDeleteFramebuffers(1, &handle);
+
+    if (colorHandle != 0)
+        glDeleteRenderbuffers(1, &colorHandle);
+
+    if (depthHandle != 0)
+        glDeleteRenderbuffers(1, &depthHandle);
+
+    handle = colorHandle = depthHandle = 0;
+}
@@ -0,0 +1,41 @@
+#ifndef PBR_FRAMEBUFFER_H
+#define PBR_FRAMEBUFFER_H
+
+#include <PBR.h>
+
+namespace pbr {
+
+// Offscreen render target with a color and a depth renderbuffer
+class Framebuffer {
+public:
+    Framebuffer() = default;
+    Framebuffer(int width, int height, int samples = 0);
+    ~Framebuffer();
+
+    Framebuffer(Framebuffer&& rhs);
+    Framebuffer& operator=(Framebuffer&& rhs);
+
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator=(const Framebuffer&) = delete;
+
+    unsigned int id() const { return handle; }
+    int width() const { return fbWidth; }
+    int height() const { return fbHeight; }
+
+    void create(int width, int height, int samples = 0);
+    void bind() const;
+
+private:
+    void release();
+
+    unsigned int handle = 0;
+    unsigned int colorHandle = 0;
+    unsigned int depthHandle = 0;
+
+    int fbWidth = 0;
+    int fbHeight = 0;
+};
+
+} // namespace pbr
+
+#endif
@@ -0,0 +1,145 @@
+#include <FrustumCuller.h>
+
+#include <Camera.h>
+#include <Frustum.h>
+#include <JobSystem.h>
+#include <Scene.h>
+
+#include <bit>
+
+using namespace pbr;
+using namespace pbr::math;
+
+namespace {
+
+#ifdef PBR_SIMD_AVX2
+constexpr std::size_t BatchSize = 8;
+#elif defined(PBR_SIMD_SSE)
+constexpr std::size_t BatchSize = 4;
+#else
+constexpr std::size_t BatchSize = 1;
+#endif
+
+// Boxes culled per job, a whole number of batches
+constexpr std::size_t BlockSize = 4096;
+static_assert(BlockSize % BatchSize == 0);
+
+// Per plane pointers to the box corner furthest along its normal. A box is outside
+// when that corner is behind any of the planes.
+struct PlaneTest {
+    Vec4 plane;
+    std::array<const float*, 3> corner;
+};
+
+// Bit i set if box first + i is outside the frustum
+unsigned int OutsideMask(std::span<const PlaneTest, 6> tests, std::size_t first) {
+#ifdef PBR_SIMD_AVX2
+    __m256 outside = _mm256_setzero_ps();
+    for (const PlaneTest& t : tests) {
+        __m256 dist = _mm256_set1_ps(t.plane.w);
+        dist = _mm256_fmadd_ps(_mm256_set1_ps(t.plane.x),
+                               _mm256_loadu_ps(t.corner[0] + first), dist);
+        dist = _mm256_fmadd_ps(_mm256_set1_ps(t.plane.y),
+                               _mm256_loadu_ps(t.corner[1] + first), dist);
+        dist = _mm256_fmadd_ps(_mm256_set1_ps(t.plane.z),
+                               _mm256_loadu_ps(t.corner[2] + first), dist);
+        outside = _mm256_or_ps(outside,
+                               _mm256_cmp_ps(dist, _mm256_setzero_ps(), _CMP_LT_OQ));
+    }
+    return _mm256_movemask_ps(outside);
+#elif defined(PBR_SIMD_SSE)
+    __m128 outside = _mm_setzero_ps();
+    for (const PlaneTest& t : tests) {
+        __m128 dist = _mm_set1_ps(t.plane.w);
+        dist = simd::MulAdd(_mm_set1_ps(t.plane.x), simd::Load(t.corner[0] + first), dist);
+        dist = simd::MulAdd(_mm_set1_ps(t.plane.y), simd::Load(t.corner[1] + first), dist);
+        dist = simd::MulAdd(_mm_set1_ps(t.plane.z), simd::Load(t.corner[2] + first), dist);
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_setzero_ps()));
+    }
+    return _mm_movemask_ps(outside);
+#else
+    for (const PlaneTest& t : tests) {
+        const float dist = t.plane.x * t.corner[0][first] + t.plane.y * t.corner[1][first] +
+                           t.plane.z * t.corner[2][first] + t.plane.w;
+        if (dist < 0)
+            return 1;
+    }
+    return 0;
+#endif
+}
+
+// Appends the indices in [first, last) of the boxes that may be visible
+void CullRange(std::span<const PlaneTest, 6> tests, std::size_t first, std::size_t last,
+               std::vector<std::uint32_t>& visible) {
+    for (std::size_t batch = first; batch < last; batch += BatchSize) {
+        const std::size_t count = std::min(BatchSize, last - batch);
+
+        unsigned int inside = ~OutsideMask(tests, batch) & ((1u << count) - 1);
+        while (inside != 0) {
+            const auto index = batch + std::countr_zero(inside);
+            visible.push_back(static_cast<std::uint32_t>(index));
+            inside &= inside - 1;
+        }
+    }
+}
+
+} // namespace
+
+void FrustumCuller::updateBounds(const Scene& scene) {
+    if (_boundsVersion == scene.boundsVersion())
+        return;
+
+    const auto bounds = scene.shapeBounds();
+    _numBounds = bounds.size();
+
+    // Padding lanes hold empty boxes at the origin and are masked out when culling
+    const std::size_t padded = (_numBounds + BatchSize - 1) / BatchSize * BatchSize;
+    for (auto& component : _bounds)
+        component.assign(padded, 0.0f);
+
+    for (std::size_t i = 0; i < _numBounds; ++i) {
+        for (unsigned int c = 0; c < 3; ++c) {
+            _bounds[c][i] = bounds[i].min()[c];
+            _bounds[3 + c][i] = bounds[i].max()[c];
+        }
+    }
+
+    _boundsVersion = scene.boundsVersion();
+}
+
+std::span<const std::uint32_t> FrustumCuller::cull(const Scene& scene,
+                                                   const Camera& camera) {
+    updateBounds(scene);
+
+    const Frustum frustum{camera.viewProjMatrix()};
+
+    std::array<PlaneTest, 6> tests;
+    for (unsigned int p = 0; p < 6; ++p) {
+        const Vec4& plane = frustum.plane(p);
+        tests[p].plane = plane;
+        for (unsigned int c = 0; c < 3; ++c)
+            tests[p].corner[c] = _bounds[plane[c] >= 0 ? 3 + c : c].data();
+    }
+
+    // Blocks are culled by separate jobs and concatenated, keeping the scene order
+    const std::size_t numBlocks = (_numBounds + BlockSize - 1) / BlockSize;
+    _blocks.resize(numBlocks);
+
+    JobSystem::get().parallelFor(numBlocks, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; ++b) {
+            _blocks[b].clear();
+            CullRange(tests, b * BlockSize, std::min((b + 1) * BlockSize, _numBounds),
+                      _blocks[b]);
+        }
+    });
+
+    _visible.clear();
+    for (const auto& block : _blocks)
+        _visible.insert(_visible.end(), block.begin(), block.end());
+
+    _stats.tested = _numBounds;
+    _stats.visible = _visible.size();
+    _stats.culled = _stats.tested - _stats.visible;
+
+    return _visible;
+}
@@ -0,0 +1,46 @@
+#ifndef PBR_FRUSTUMCULLER_H
+#define PBR_FRUSTUMCULLER_H
+
+#include <PBR.h>
+#include <PBRMath.h>
+
+#include <span>
+
+namespace pbr {
+
+class Scene;
+class Camera;
+
+struct CullStats {
+    unsigned int tested = 0;
+    unsigned int culled = 0;
+    unsigned int visible = 0;
+};
+
+// Tests shape world bounds against the camera frustum. Bounds are mirrored from the
+// scene into a structure of arrays padded to whole batches, so each plane is tested
+// against 8 boxes per AVX2 iteration (4 with SSE). The copy is only refreshed when the
+// scene bounds change. Large scenes are culled in blocks on the job system.
+class FrustumCuller {
+public:
+    // Indices into scene.shapes() of the shapes that may be visible, in scene order
+    std::span<const std::uint32_t> cull(const Scene& scene, const Camera& camera);
+
+    const CullStats& stats() const { return _stats; }
+
+private:
+    void updateBounds(const Scene& scene);
+
+    // Component c of the box min and max corners are at _bounds[c] and _bounds[3 + c]
+    std::array<std::vector<float>, 6> _bounds;
+    std::size_t _numBounds = 0;
+    std::optional<std::uint64_t> _boundsVersion = std::nullopt;
+
+    std::vector<std::vector<std::uint32_t>> _blocks;
+    std::vector<std::uint32_t> _visible;
+    CullStats _stats;
+};
+
+} // namespace pbr
+
+#endif
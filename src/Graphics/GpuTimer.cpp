@@ -0,0 +1,31 @@
+#include <GpuTimer.h>
+
+#include <glad/glad.h>
+
+using namespace pbr;
+
+GpuTimer::GpuTimer(unsigned int numQueries) : queries(numQueries) {
+    glCreateQueries(GL_TIME_ELAPSED, numQueries, queries.data());
+}
+
+GpuTimer::~GpuTimer() {
+    if (!queries.empty())
+        glDeleteQueries(queries.size(), queries.data());
+}
+
+void GpuTimer::begin(unsigned int idx) const {
+    DCHECK_LT(idx, queries.size());
+    glBeginQuery(GL_TIME_ELAPSED, queries[idx]);
+}
+
+void GpuTimer::end() const {
+    glEndQuery(GL_TIME_ELAPSED);
+}
+
+double GpuTimer::elapsedMs(unsigned int idx) const {
+    DCHECK_LT(idx, queries.size());
+
+    GLuint64 elapsedNs = 0;
+    glGetQueryObjectui64v(queries[idx], GL_QUERY_RESULT, &elapsedNs);
+    return static_cast<double>(elapsedNs) * 1e-6;
+}
@@ -0,0 +1,33 @@
+#ifndef PBR_GPUTIMER_H
+#define PBR_GPUTIMER_H
+
+#include <PBR.h>
+
+namespace pbr {
+
+// Set of GL_TIME_ELAPSED queries. Results are only read back through elapsedMs(),
+// so recording a long run of frames never stalls the pipeline.
+class GpuTimer {
+public:
+    GpuTimer() = default;
+    explicit GpuTimer(unsigned int numQueries);
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin(unsigned int idx) const;
+    void end() const;
+
+    // Blocks until the query result is available
+    double elapsedMs(unsigned int idx) const;
+
+    std::size_t size() const { return queries.size(); }
+
+private:
+    std::vector<unsigned int> queries;
+};
+
+} // namespace pbr
+
+#endif
@@ -0,0 +1,140 @@
+#include <HiZBuffer.h>
+
+#include <glad/glad.h>
+#include <Resources.h>
+#include <Shader.h>
+
+using namespace pbr;
+using namespace pbr::math;
+
+namespace {
+
+enum HiZBuildUniform { DEPTH_MAP = 0, LEVEL = 1 };
+
+constexpr unsigned int DepthUnit = 11;
+constexpr unsigned int GroupSize = 8; // local_size of hizBuild.comp
+
+GLint AttachmentParameter(GLuint fbo, GLenum attachment, GLenum pname) {
+    GLint type = GL_NONE;
+    glGetNamedFramebufferAttachmentParameteriv(
+        fbo, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+    if (type == GL_NONE)
+        return 0;
+
+    GLint value = 0;
+    glGetNamedFramebufferAttachmentParameteriv(fbo, attachment, pname, &value);
+    return value;
+}
+
+// Blits need the exact depth and stencil format of the source
+GLenum DepthFormat(GLuint fbo) {
+    const GLenum depth = fbo == 0 ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+    const GLenum stencil = fbo == 0 ? GL_STENCIL : GL_STENCIL_ATTACHMENT;
+
+    const auto depthBits =
+        AttachmentParameter(fbo, depth, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE);
+    const auto stencilBits =
+        AttachmentParameter(fbo, stencil, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE);
+    const auto type =
+        AttachmentParameter(fbo, depth, GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE);
+
+    if (type == GL_FLOAT)
+        return stencilBits > 0 ? GL_DEPTH32F_STENCIL8 : GL_DEPTH_COMPONENT32F;
+    if (stencilBits > 0)
+        return GL_DEPTH24_STENCIL8;
+    if (depthBits > 24)
+        return GL_DEPTH_COMPONENT32;
+
+    return depthBits > 16 ? GL_DEPTH_COMPONENT24 : GL_DEPTH_COMPONENT16;
+}
+
+} // namespace
+
+HiZBuffer::~HiZBuffer() {
+    release();
+}
+
+void HiZBuffer::release() {
+    if (_depthFbo != 0)
+        glDeleteFramebuffers(1, &_depthFbo);
+    if (_depth != 0)
+        glDeleteTextures(1, &_depth);
+    if (_pyramid != 0)
+        glDeleteTextures(1, &_pyramid);
+
+    _depthFbo = _depth = _pyramid = 0;
+    _built = false;
+}
+
+void HiZBuffer::create(int width, int height, unsigned int depthFormat) {
+    release();
+
+    _width = width;
+    _height = height;
+    _depthFormat = depthFormat;
+    _levels = static_cast<int>(std::log2(std::max(width, height))) + 1;
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &_depth);
+    glTextureStorage2D(_depth, 1, depthFormat, width, height);
+    glTextureParameteri(_depth, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(_depth, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glCreateFramebuffers(1, &_depthFbo);
+    const bool hasStencil =
+        depthFormat == GL_DEPTH24_STENCIL8 || depthFormat == GL_DEPTH32F_STENCIL8;
+    const GLenum attachment =
+        hasStencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+    glNamedFramebufferTexture(_depthFbo, attachment, _depth, 0);
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &_pyramid);
+    glTextureStorage2D(_pyramid, _levels, GL_R32F, width, height);
+    glTextureParameteri(_pyramid, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTextureParameteri(_pyramid, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+void HiZBuffer::build(const Mat4& viewProj) {
+    std::array<GLint, 4> viewport;
+    glGetIntegerv(GL_VIEWPORT, viewport.data());
+    const auto [x, y, width, height] = viewport;
+
+    GLint source = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &source);
+
+    const auto format = DepthFormat(source);
+    if (width != _width || height != _height || format != _depthFormat)
+        create(width, height, format);
+
+    glBlitNamedFramebuffer(source, _depthFbo, x, y, x + width, y + height, 0, 0, width,
+                           height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    if (!_program) {
+        _program = Resource.get<Program>("hizBuild");
+        _program->setSampler(DEPTH_MAP, DepthUnit);
+    }
+
+    _program->use();
+    glBindTextureUnit(DepthUnit, _depth);
+
+    // Level 0 copies the depth, every other one reduces the one before
+    for (int level = 0; level < _levels; ++level) {
+        glBindImageTexture(0, _pyramid, std::max(level - 1, 0), GL_FALSE, 0, GL_READ_ONLY,
+                           GL_R32F);
+        glBindImageTexture(1, _pyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        _program->setUInt(LEVEL, level);
+
+        const auto levelWidth = static_cast<unsigned int>(std::max(width >> level, 1));
+        const auto levelHeight = static_cast<unsigned int>(std::max(height >> level, 1));
+        glDispatchCompute((levelWidth + GroupSize - 1) / GroupSize,
+                          (levelHeight + GroupSize - 1) / GroupSize, 1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    _viewProj = viewProj;
+    _built = true;
+}
+
+void HiZBuffer::bind(unsigned int unit) const {
+    glBindTextureUnit(unit, _pyramid);
+}
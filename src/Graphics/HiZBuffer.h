@@ -0,0 +1,53 @@
+#ifndef PBR_HIZBUFFER_H
+#define PBR_HIZBUFFER_H
+
+#include <PBR.h>
+#include <PBRMath.h>
+
+namespace pbr {
+
+class Program;
+
+// Mip pyramid of the farthest depth under each texel, built from the depth buffer of the
+// bound draw framebuffer. Levels round down, and their last row and column also cover
+// what an odd size leaves over, so a box of pixels is always under the texels its corners
+// fall in.
+class HiZBuffer {
+public:
+    HiZBuffer() = default;
+    ~HiZBuffer();
+
+    HiZBuffer(const HiZBuffer&) = delete;
+    HiZBuffer& operator=(const HiZBuffer&) = delete;
+
+    // Copies the depth of the current viewport, drawn with the given view projection
+    void build(const math::Mat4& viewProj);
+
+    bool valid() const { return _built; }
+    void bind(unsigned int unit) const;
+
+    // View projection the depth was drawn with
+    const math::Mat4& viewProj() const { return _viewProj; }
+
+private:
+    void create(int width, int height, unsigned int depthFormat);
+    void release();
+
+    unsigned int _depth = 0; // Single sampled copy of the depth buffer
+    unsigned int _depthFbo = 0;
+    unsigned int _pyramid = 0;
+    unsigned int _depthFormat = 0;
+
+    int _width = 0;
+    int _height = 0;
+    int _levels = 0;
+
+    bool _built = false;
+    math::Mat4 _viewProj;
+
+    sref<Program> _program = nullptr;
+};
+
+} // namespace pbr
+
+#endif
@@ -0,0 +1,160 @@
+#include <LightClusters.h>
+
+#include <Camera.h>
+#include <BBox.h>
+
+using namespace pbr;
+
+namespace {
+
+constexpr std::array<unsigned int, 3> ClusterDims{16, 9, 24};
+
+// Sphere bounding the region a light can affect
+std::optional<BSphere> InfluenceSphere(const LightData& light) {
+    using enum LightType;
+
+    switch (static_cast<LightType>(light.type)) {
+    case Point:
+    case Spot:
+    case Sphere:
+        return BSphere{light.position, light.range};
+    case Tube:
+        {
+            const Vec3 center = 0.5f * (light.position + light.auxB);
+            const float halfLength = 0.5f * (light.auxB - light.position).length();
+            return BSphere{center, halfLength + light.auxA + light.range};
+        }
+    default:
+        return std::nullopt;
+    }
+}
+
+unsigned int ToTile(float ndc, unsigned int dim) {
+    const float t = (ndc * 0.5f + 0.5f) * dim;
+    return static_cast<unsigned int>(std::clamp(t, 0.0f, dim - 1.0f));
+}
+
+} // namespace
+
+LightClusters::LightClusters() {
+    _data.dims = ClusterDims;
+    _clusters.resize(numClusters());
+}
+
+std::size_t LightClusters::numClusters() {
+    return ClusterDims[0] * ClusterDims[1] * ClusterDims[2];
+}
+
+std::optional<LightClusters::LightBounds>
+LightClusters::bin(const LightData& light, const Camera& camera) const {
+    auto sphere = InfluenceSphere(light);
+    if (!sphere)
+        return std::nullopt;
+
+    const Vec3 center = camera.viewMatrix() * sphere->center();
+    const float radius = sphere->radius();
+
+    // View space depth range, clipped to the frustum
+    float minDepth = -center.z - radius;
+    float maxDepth = -center.z + radius;
+    if (maxDepth < camera.near() || minDepth > camera.far())
+        return std::nullopt;
+
+    minDepth = std::max(minDepth, camera.near());
+    maxDepth = std::min(maxDepth, camera.far());
+
+    // Project the view space box at both depth ends. Using the clipped near depth keeps
+    // the result conservative for lights that straddle the near plane.
+    const Mat4& proj = camera.projMatrix();
+    auto project = [&](float lo, float hi, float scale, float offset) {
+        float ndcMin = scale * std::min(lo / minDepth, lo / maxDepth) - offset;
+        float ndcMax = scale * std::max(hi / minDepth, hi / maxDepth) - offset;
+        return std::pair{ndcMin, ndcMax};
+    };
+
+    auto [minX, maxX] = project(center.x - radius, center.x + radius, proj(0, 0),
+                                proj(0, 2));
+    auto [minY, maxY] = project(center.y - radius, center.y + radius, proj(1, 1),
+                                proj(1, 2));
+    if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+        return std::nullopt;
+
+    auto slice = [this](float depth) {
+        const float s = std::log(depth) * _data.depthScale - _data.depthBias;
+        return static_cast<unsigned int>(
+            std::clamp(s, 0.0f, static_cast<float>(ClusterDims[2] - 1)));
+    };
+
+    return LightBounds{
+        .light = 0,
+        .min = {ToTile(minX, ClusterDims[0]), ToTile(minY, ClusterDims[1]),
+                slice(minDepth)},
+        .max = {ToTile(maxX, ClusterDims[0]), ToTile(maxY, ClusterDims[1]),
+                slice(maxDepth)}
+    };
+}
+
+void LightClusters::build(const std::vector<sref<Light>>& lights, const Camera& camera) {
+    const float logDepthRatio = std::log(camera.far() / camera.near());
+
+    _data.depthScale = ClusterDims[2] / logDepthRatio;
+    _data.depthBias = ClusterDims[2] * std::log(camera.near()) / logDepthRatio;
+    _data.tileScale = {static_cast<float>(ClusterDims[0]) / camera.width(),
+                       static_cast<float>(ClusterDims[1]) / camera.height()};
+
+    _lights.clear();
+    _bounds.clear();
+
+    // Global lights go first, local ones are only kept if they touch the frustum
+    std::vector<LightData> local;
+    local.reserve(lights.size());
+    for (const auto& light : lights) {
+        if (!light->isOn())
+            continue;
+
+        LightData data;
+        light->toData(data);
+        if (light->type() == LightType::Directional)
+            _lights.push_back(data);
+        else
+            local.push_back(data);
+    }
+
+    _data.numGlobalLights = _lights.size();
+
+    for (const auto& data : local) {
+        if (auto bounds = bin(data, camera)) {
+            bounds->light = _lights.size();
+            _bounds.push_back(*bounds);
+            _lights.push_back(data);
+        }
+    }
+
+    auto clusterIndex = [](unsigned int x, unsigned int y, unsigned int z) {
+        return x + ClusterDims[0] * (y + ClusterDims[1] * z);
+    };
+
+    auto forEachCluster = [&](const LightBounds& b, auto&& func) {
+        for (unsigned int z = b.min[2]; z <= b.max[2]; ++z)
+            for (unsigned int y = b.min[1]; y <= b.max[1]; ++y)
+                for (unsigned int x = b.min[0]; x <= b.max[0]; ++x)
+                    func(_clusters[clusterIndex(x, y, z)]);
+    };
+
+    // Count, prefix sum into offsets, then scatter the light indices
+    std::fill(_clusters.begin(), _clusters.end(), ClusterRange{0, 0});
+    for (const auto& b : _bounds)
+        forEachCluster(b, [](ClusterRange& c) { ++c.count; });
+
+    unsigned int offset = 0;
+    for (auto& c : _clusters) {
+        c.offset = offset;
+        offset += std::exchange(c.count, 0);
+    }
+
+    _indices.resize(offset);
+    for (const auto& b : _bounds)
+        forEachCluster(b, [&](ClusterRange& c) {
+            _indices[c.offset + c.count++] = b.light;
+        });
+}
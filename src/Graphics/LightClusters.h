@@ -0,0 +1,67 @@
+#ifndef PBR_LIGHTCLUSTERS_H
+#define PBR_LIGHTCLUSTERS_H
+
+#include <PBR.h>
+#include <PBRMath.h>
+#include <Light.h>
+
+#include <span>
+
+using namespace pbr::math;
+
+namespace pbr {
+
+class Camera;
+
+// Cluster grid parameters for shader blocks
+// CARE: data is properly aligned to std140, do not change
+struct ClusterData {
+    alignas(16) std::array<unsigned int, 3> dims;
+    unsigned int numGlobalLights;
+    alignas(16) Vec2 tileScale; // Clusters per pixel
+    float depthScale;
+    float depthBias;
+};
+
+struct ClusterRange {
+    unsigned int offset;
+    unsigned int count;
+};
+
+// Bins lights into view space froxels on the CPU. Depth slices are exponential, so
+// clusters keep a similar aspect ratio along the view. Lights without a finite range
+// (directional) are placed first in the light list and shaded everywhere.
+class LightClusters {
+public:
+    LightClusters();
+
+    void build(const std::vector<sref<Light>>& lights, const Camera& camera);
+
+    const ClusterData& data() const { return _data; }
+
+    std::span<const LightData> lights() const { return _lights; }
+    std::span<const ClusterRange> clusters() const { return _clusters; }
+    std::span<const unsigned int> indices() const { return _indices; }
+
+    static std::size_t numClusters();
+
+private:
+    struct LightBounds {
+        unsigned int light;
+        std::array<unsigned int, 3> min;
+        std::array<unsigned int, 3> max;
+    };
+
+    std::optional<LightBounds> bin(const LightData& light, const Camera& camera) const;
+
+    ClusterData _data;
+
+    std::vector<LightData> _lights;
+    std::vector<LightBounds> _bounds;
+    std::vector<ClusterRange> _clusters;
+    std::vector<unsigned int> _indices;
+};
+
+} // namespace pbr
+
+#endif
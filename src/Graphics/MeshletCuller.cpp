@@ -0,0 +1,78 @@
+#include <MeshletCuller.h>
+
+#include <Geometry.h>
+#include <Renderer.h>
+#include <Resources.h>
+#include <Shader.h>
+
+using namespace pbr;
+
+namespace {
+
+enum MeshletCullUniform {
+    NUM_MESHLETS = 0,
+    FIRST_INSTANCE = 1,
+    NUM_INSTANCES = 2,
+    FIRST_COMMAND = 3,
+    DRAW_SLOT = 4,
+    GATE = 5
+};
+
+constexpr unsigned int GroupSize = 64; // local_size_x of meshletCull.comp
+constexpr unsigned int MaxGroups = 65535;
+
+} // namespace
+
+void MeshletCuller::clear() {
+    _draws.clear();
+    _numDispatched = 0;
+    _numTested = 0;
+}
+
+DrawRange MeshletCuller::add(DrawCommandBuffer& commands, const Geometry& geometry,
+                             unsigned int firstInstance, unsigned int numInstances,
+                             Visibility gate) {
+    DCHECK(geometry.hasMeshlets());
+
+    const auto numCommands = geometry.meshlets().size() * numInstances;
+    const auto range = commands.allocate(numCommands);
+    _numTested += numCommands;
+
+    _draws.push_back({.geometry = &geometry,
+                      .firstInstance = firstInstance,
+                      .numInstances = numInstances,
+                      .range = range,
+                      .gate = gate});
+
+    return range;
+}
+
+void MeshletCuller::dispatch() {
+    if (_numDispatched == _draws.size())
+        return;
+
+    if (!_program)
+        _program = Resource.get<Program>("meshletCull");
+
+    _program->use();
+
+    for (; _numDispatched < _draws.size(); ++_numDispatched) {
+        const auto& draw = _draws[_numDispatched];
+        const auto numMeshlets =
+            static_cast<unsigned int>(draw.geometry->meshlets().size());
+
+        draw.geometry->bindMeshlets(MESHLET_BUFFER);
+        _program->setUInt(NUM_MESHLETS, numMeshlets);
+        _program->setUInt(FIRST_INSTANCE, draw.firstInstance);
+        _program->setUInt(NUM_INSTANCES, draw.numInstances);
+        _program->setUInt(FIRST_COMMAND,
+                          static_cast<unsigned int>(draw.range.firstCommand));
+        _program->setUInt(DRAW_SLOT, draw.range.countSlot);
+        _program->setUInt(GATE, ToUnderlying(draw.gate));
+
+        // Rows of groups past the dispatch limit
+        const auto groups = (numMeshlets * draw.numInstances + GroupSize - 1) / GroupSize;
+        const auto groupsX = std::min(groups, MaxGroups);
+        glDispatchCompute(groupsX, (groups + groupsX - 1) / groupsX, 1);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef PBR_MESHLETCULLER_H
+#define PBR_MESHLETCULLER_H
+
+#include <PBR.h>
+#include <DrawCommandBuffer.h>
+
+namespace pbr {
+
+class Geometry;
+class Program;
+
+// Culls the meshlets of instanced draws against the frustum and their normal cones in a
+// compute pass. The survivors are appended to the draw's range, one command per meshlet
+// and instance. Culling reads the instance transforms, so it runs after they are written.
+class MeshletCuller {
+public:
+    void clear();
+
+    // Only the instances in the given state are culled, the rest draw nothing
+    DrawRange add(DrawCommandBuffer& commands, const Geometry& geometry,
+                  unsigned int firstInstance, unsigned int numInstances,
+                  Visibility gate = Visibility::Any);
+
+    // Culls the draws added since the last dispatch. The command buffer must be prepared.
+    void dispatch();
+
+    std::size_t size() const { return _draws.size(); }
+
+    // Meshlets tested for all instances
+    std::size_t numTested() const { return _numTested; }
+
+private:
+    struct CullDraw {
+        const Geometry* geometry;
+        unsigned int firstInstance;
+        unsigned int numInstances;
+        DrawRange range;
+        Visibility gate;
+    };
+
+    std::vector<CullDraw> _draws;
+    std::size_t _numDispatched = 0;
+    std::size_t _numTested = 0;
+
+    sref<Program> _program = nullptr;
+};
+
+} // namespace pbr
+
+#endif
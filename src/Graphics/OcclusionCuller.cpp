@@ -0,0 +1,121 @@
+#include <OcclusionCuller.h>
+
+#include <Geometry.h>
+#include <Renderer.h>
+#include <Resources.h>
+#include <Shader.h>
+
+using namespace pbr;
+
+namespace {
+
+enum InstanceCullUniform {
+    FIRST_INSTANCE = 0,
+    NUM_INSTANCES = 1,
+    FIRST_COMMAND = 2,
+    DRAW_SLOT = 3,
+    FIRST_INDEX = 4,
+    NUM_INDICES = 5,
+    BBOX_MIN = 6,
+    BBOX_MAX = 7,
+    LATE = 8,
+    HAS_PYRAMID = 9,
+    PYRAMID_VIEW_PROJ = 10,
+    PYRAMID = 11
+};
+
+constexpr unsigned int PyramidUnit = 12;
+constexpr unsigned int GroupSize = 64; // local_size_x of instanceCull.comp
+
+constexpr std::size_t MinInstances = 1024;
+
+} // namespace
+
+void OcclusionCuller::clear(std::size_t numInstances) {
+    _batches.clear();
+    _numDispatched = 0;
+    _numTested = 0;
+    _numInstances = numInstances;
+
+    if (numInstances > _capacity) {
+        _capacity = std::max({numInstances, 2 * _capacity, MinInstances});
+        _visibility = std::make_unique<Buffer>(BufferType::ShaderStorage,
+                                               _capacity * sizeof(std::uint32_t));
+    }
+}
+
+std::optional<DrawRange>
+OcclusionCuller::add(DrawCommandBuffer& commands, const Geometry& geometry,
+                     unsigned int level, unsigned int firstInstance,
+                     unsigned int numInstances, bool late, bool meshlets) {
+    DCHECK_LE(firstInstance + numInstances, _numInstances);
+
+    std::optional<DrawRange> range = std::nullopt;
+    if (!meshlets)
+        range = commands.allocate(numInstances);
+
+    if (!late)
+        _numTested += numInstances;
+
+    _batches.push_back({.geometry = &geometry,
+                        .level = level,
+                        .firstInstance = firstInstance,
+                        .numInstances = numInstances,
+                        .range = range,
+                        .late = late});
+
+    return range;
+}
+
+void OcclusionCuller::dispatch() {
+    if (_numDispatched == _batches.size())
+        return;
+
+    if (!_program) {
+        _program = Resource.get<Program>("instanceCull");
+        _program->setSampler(PYRAMID, PyramidUnit);
+    }
+
+    _visibility->bindRange(VISIBILITY_BUFFER, 0, _numInstances * sizeof(std::uint32_t));
+
+    // The late pass only runs after the pyramid was rebuilt, so both passes of a frame
+    // test against the one built last
+    _program->use();
+    _program->setUInt(HAS_PYRAMID, _pyramid.valid());
+    if (_pyramid.valid()) {
+        _program->setMatrix4(PYRAMID_VIEW_PROJ, _pyramid.viewProj());
+        _pyramid.bind(PyramidUnit);
+    }
+
+    for (; _numDispatched < _batches.size(); ++_numDispatched) {
+        const auto& batch = _batches[_numDispatched];
+        const auto lod = batch.geometry->lod(batch.level);
+        const auto& bbox = batch.geometry->bbox();
+
+        _program->setUInt(FIRST_INSTANCE, batch.firstInstance);
+        _program->setUInt(NUM_INSTANCES, batch.numInstances);
+        _program->setUInt(LATE, batch.late);
+        _program->setVector3(BBOX_MIN, bbox.min());
+        _program->setVector3(BBOX_MAX, bbox.max());
+
+        if (batch.range) {
+            const auto& range = *batch.range;
+            _program->setUInt(FIRST_COMMAND,
+                              static_cast<unsigned int>(range.firstCommand));
+            _program->setUInt(DRAW_SLOT, range.countSlot);
+            _program->setUInt(FIRST_INDEX, lod.firstIndex);
+            _program->setUInt(NUM_INDICES, lod.numIndices);
+        } else {
+            _program->setUInt(NUM_INDICES, 0);
+        }
+
+        glDispatchCompute((batch.numInstances + GroupSize - 1) / GroupSize, 1, 1);
+    }
+
+    // Meshlet culling reads the visibility next
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void OcclusionCuller::buildPyramid(const Mat4& viewProj) {
+    _pyramid.build(viewProj);
+}
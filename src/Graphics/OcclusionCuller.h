@@ -0,0 +1,68 @@
+#ifndef PBR_OCCLUSIONCULLER_H
+#define PBR_OCCLUSIONCULLER_H
+
+#include <PBR.h>
+#include <PBRMath.h>
+#include <Buffer.h>
+#include <DrawCommandBuffer.h>
+#include <HiZBuffer.h>
+
+namespace pbr {
+
+class Geometry;
+class Program;
+
+// Two pass occlusion culling against a depth pyramid [Haar and Aaltonen 2015],
+// "GPU-Driven Rendering Pipelines". The early pass tests every instance's bounding box
+// against the pyramid of the previous frame and draws the visible ones. The pyramid is
+// then rebuilt from that depth, and the late pass retests only what the early pass
+// occluded, drawing what turned out visible. Objects that appear from behind an occluder
+// are drawn on the frame they appear, and the pyramid is reused by the early pass of the
+// next frame.
+class OcclusionCuller {
+public:
+    // Sized for the instances of the frame
+    void clear(std::size_t numInstances);
+
+    // Returns the range the instances are drawn from. Batches whose meshlets are culled
+    // afterwards only get their visibility written, and no range.
+    std::optional<DrawRange> add(DrawCommandBuffer& commands, const Geometry& geometry,
+                                 unsigned int level, unsigned int firstInstance,
+                                 unsigned int numInstances, bool late, bool meshlets);
+
+    // Culls the batches added since the last dispatch. The command buffer must be
+    // prepared.
+    void dispatch();
+
+    // Rebuilds the pyramid from the depth drawn so far, before the late pass
+    void buildPyramid(const math::Mat4& viewProj);
+
+    // Instances tested by the early pass
+    std::size_t numTested() const { return _numTested; }
+
+private:
+    struct CullBatch {
+        const Geometry* geometry;
+        unsigned int level;
+        unsigned int firstInstance;
+        unsigned int numInstances;
+        std::optional<DrawRange> range;
+        bool late;
+    };
+
+    std::vector<CullBatch> _batches;
+    std::size_t _numDispatched = 0;
+    std::size_t _numTested = 0;
+
+    // Visibility of every instance through the passes, grown on demand
+    std::unique_ptr<Buffer> _visibility = nullptr;
+    std::size_t _numInstances = 0;
+    std::size_t _capacity = 0;
+
+    HiZBuffer _pyramid;
+    sref<Program> _program = nullptr;
+};
+
+} // namespace pbr
+
+#endif
@@ -0,0 +1,250 @@
+#include <Profiler.h>
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+using namespace pbr;
+
+namespace {
+
+// Frames recorded before a slot is read back again
+constexpr std::size_t FrameLatency = 4;
+constexpr std::size_t MinQueries = 32;
+
+// Around 100MB of JSON, a few minutes of frames
+constexpr std::size_t MaxTraceEvents = 1 << 20;
+
+double ToUs(Profiler::Clock::duration time) {
+    return std::chrono::duration<double, std::micro>(time).count();
+}
+
+float Percentile(std::vector<float> samples, float p) {
+    const auto n = static_cast<std::size_t>(std::ceil(p * samples.size()));
+    const auto nth = samples.begin() + std::clamp<std::size_t>(n, 1, samples.size()) - 1;
+    std::nth_element(samples.begin(), nth, samples.end());
+    return *nth;
+}
+
+} // namespace
+
+Profiler::~Profiler() {
+    for (auto& frame : _frames)
+        if (!frame.queries.empty())
+            glDeleteQueries(frame.queries.size(), frame.queries.data());
+}
+
+void Profiler::beginFrame() {
+    DCHECK(_current == nullptr);
+
+    if (_frames.empty()) {
+        _frames.resize(FrameLatency);
+        calibrate();
+    }
+
+    Frame& frame = _frames[_frameIndex++ % _frames.size()];
+    if (frame.pending) {
+        // The end of the frame marker is the last timestamp written by that frame
+        GLint available = 0;
+        glGetQueryObjectiv(frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+            resolve(frame);
+        else if (_dropped++ == 0)
+            LOGW("GPU is more than {} frames behind, dropping timings", FrameLatency);
+
+        frame.pending = false;
+    }
+
+    frame.markers.clear();
+    _current = &frame;
+
+    beginMarker("Frame");
+}
+
+void Profiler::endFrame() {
+    if (!_current)
+        return;
+
+    // Closes the frame marker, and any other left open
+    while (!_open.empty())
+        endMarker(_open.back());
+
+    _current->pending = true;
+    _current = nullptr;
+}
+
+std::uint32_t Profiler::beginMarker(const char* name) {
+    if (!_current)
+        return NoMarker;
+
+    Frame& frame = *_current;
+    const auto marker = static_cast<std::uint32_t>(frame.markers.size());
+
+    if (frame.queries.size() < 2 * (marker + 1)) {
+        const std::size_t first = frame.queries.size();
+        frame.queries.resize(std::max(2 * first, MinQueries));
+        glCreateQueries(GL_TIMESTAMP, frame.queries.size() - first,
+                        frame.queries.data() + first);
+    }
+
+    const auto depth = static_cast<std::uint32_t>(_open.size());
+    frame.markers.push_back({name, depth, Clock::now(), {}});
+    glQueryCounter(frame.queries[2 * marker], GL_TIMESTAMP);
+
+    _open.push_back(marker);
+    return marker;
+}
+
+void Profiler::endMarker(std::uint32_t marker) {
+    if (marker == NoMarker || !_current)
+        return;
+
+    // Markers nest
+    DCHECK(!_open.empty() && _open.back() == marker);
+    _open.pop_back();
+
+    glQueryCounter(_current->queries[2 * marker + 1], GL_TIMESTAMP);
+    _current->markers[marker].cpuEnd = Clock::now();
+}
+
+void Profiler::flush() {
+    // Oldest first, so series and trace stay in frame order
+    for (std::size_t f = 0; f < _frames.size(); ++f) {
+        Frame& frame = _frames[(_frameIndex + f) % _frames.size()];
+        if (frame.pending) {
+            resolve(frame);
+            frame.pending = false;
+        }
+    }
+}
+
+void Profiler::resolve(Frame& frame) {
+    const std::size_t numQueries = 2 * frame.markers.size();
+
+    std::vector<GLuint64> timestamps(numQueries);
+    for (std::size_t q = 0; q < numQueries; ++q)
+        glGetQueryObjectui64v(frame.queries[q], GL_QUERY_RESULT, &timestamps[q]);
+
+    for (std::size_t m = 0; m < frame.markers.size(); ++m) {
+        const Marker& marker = frame.markers[m];
+        const GLuint64 gpuBegin = timestamps[2 * m];
+        const GLuint64 gpuEnd = std::max(timestamps[2 * m + 1], gpuBegin);
+
+        const auto cpuTime = marker.cpuEnd - marker.cpuBegin;
+        const float cpuMs = static_cast<float>(ToUs(cpuTime) * 1e-3);
+        const float gpuMs = static_cast<float>((gpuEnd - gpuBegin) * 1e-6);
+        record(marker, cpuMs, gpuMs);
+
+        if (!_tracing || marker.cpuBegin < _traceStart)
+            continue;
+
+        if (_trace.size() + 2 > MaxTraceEvents) {
+            LOGW("Trace is full, stopped recording");
+            _tracing = false;
+            continue;
+        }
+
+        const auto sinceOrigin = static_cast<std::int64_t>(gpuBegin) - _gpuOriginNs;
+        const auto gpuStart =
+            _cpuOrigin + std::chrono::nanoseconds(sinceOrigin) - _traceStart;
+        _trace.push_back({marker.name, false, ToUs(marker.cpuBegin - _traceStart),
+                          ToUs(cpuTime)});
+        _trace.push_back({marker.name, true, ToUs(gpuStart), (gpuEnd - gpuBegin) * 1e-3});
+    }
+}
+
+void Profiler::record(const Marker& marker, float cpuMs, float gpuMs) {
+    auto it = std::ranges::find_if(_series, [&](const Series& series) {
+        return std::strcmp(series.name, marker.name) == 0;
+    });
+
+    if (it == _series.end()) {
+        Series& series = _series.emplace_back();
+        series.name = marker.name;
+        series.depth = marker.depth;
+        series.cpuMs.reserve(HistorySize);
+        series.gpuMs.reserve(HistorySize);
+        it = std::prev(_series.end());
+    }
+
+    if (it->cpuMs.size() < HistorySize) {
+        it->cpuMs.push_back(cpuMs);
+        it->gpuMs.push_back(gpuMs);
+    } else {
+        it->cpuMs[it->next] = cpuMs;
+        it->gpuMs[it->next] = gpuMs;
+    }
+
+    it->next = (it->next + 1) % HistorySize;
+}
+
+std::vector<MarkerStats> Profiler::stats() const {
+    std::vector<MarkerStats> stats;
+    stats.reserve(_series.size());
+
+    for (const Series& series : _series) {
+        MarkerStats& ms = stats.emplace_back();
+        ms.name = series.name;
+        ms.depth = series.depth;
+
+        const auto n = static_cast<float>(series.cpuMs.size());
+        ms.cpuMin = std::ranges::min(series.cpuMs);
+        ms.gpuMin = std::ranges::min(series.gpuMs);
+        ms.cpuAvg = std::accumulate(series.cpuMs.begin(), series.cpuMs.end(), 0.0f) / n;
+        ms.gpuAvg = std::accumulate(series.gpuMs.begin(), series.gpuMs.end(), 0.0f) / n;
+        ms.cpuP99 = Percentile(series.cpuMs, 0.99f);
+        ms.gpuP99 = Percentile(series.gpuMs, 0.99f);
+    }
+
+    return stats;
+}
+
+void Profiler::calibrate() {
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+
+    _gpuOriginNs = gpuNow;
+    _cpuOrigin = Clock::now();
+}
+
+void Profiler::setTracing(bool tracing) {
+    if (tracing && !_tracing) {
+        _trace.clear();
+        _traceStart = Clock::now();
+
+        // The clocks drift apart, so they are matched again for every trace
+        if (!_frames.empty())
+            calibrate();
+    }
+
+    _tracing = tracing;
+}
+
+bool Profiler::writeTrace(const fs::path& path) const {
+    std::ofstream file(path);
+    if (file.fail()) {
+        LOG_ERROR("Couldn't open trace output {}.", path.string());
+        return false;
+    }
+
+    file << "{\"traceEvents\":[\n";
+    file << R"({"name":"thread_name","ph":"M","pid":0,"tid":0,"args":{"name":"CPU"}},)"
+         << "\n";
+    file << R"({"name":"thread_name","ph":"M","pid":0,"tid":1,"args":{"name":"GPU"}})";
+
+    for (const TraceEvent& event : _trace) {
+        file << std::format(",\n{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"pid\":0,"
+                            "\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                            event.name, event.gpu ? "gpu" : "cpu", event.gpu ? 1 : 0,
+                            event.startUs, event.durationUs);
+    }
+
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    LOGI("Wrote {} trace events to {}", _trace.size(), path.string());
+    return true;
+}
@@ -0,0 +1,132 @@
+#ifndef PBR_PROFILER_H
+#define PBR_PROFILER_H
+
+#include <PBR.h>
+
+#include <chrono>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace pbr {
+
+// Timings of a marker over the last frames, in milliseconds
+struct MarkerStats {
+    std::string name;
+    std::uint32_t depth = 0;
+
+    float cpuMin = 0, cpuAvg = 0, cpuP99 = 0;
+    float gpuMin = 0, gpuAvg = 0, gpuP99 = 0;
+};
+
+// Frame profiler. Markers record CPU time with a steady clock and GPU time with
+// GL_TIMESTAMP queries. Every frame slot of a small ring owns its queries and is only
+// read back when it comes around again, by which time the GPU is done with it, so
+// reading never stalls. Markers are only recorded on the main thread, between
+// beginFrame() and endFrame().
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static Profiler& get() {
+        static Profiler _inst;
+        return _inst;
+    }
+
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // The whole frame is recorded as the "Frame" marker
+    void beginFrame();
+    void endFrame();
+
+    // Names must outlive the profiler, e.g. string literals. Returns the marker to
+    // end, or NoMarker outside of a frame.
+    std::uint32_t beginMarker(const char* name);
+    void endMarker(std::uint32_t marker);
+
+    // Waits for the frames still in flight and reads them back
+    void flush();
+
+    // Markers in the order they were first seen, over the last HistorySize frames
+    std::vector<MarkerStats> stats() const;
+
+    // Resolved markers are kept for a Chrome trace (chrome://tracing, Perfetto)
+    bool tracing() const { return _tracing; }
+    void setTracing(bool tracing);
+    bool writeTrace(const fs::path& path) const;
+
+    static constexpr std::uint32_t NoMarker = ~0u;
+    static constexpr std::size_t HistorySize = 240;
+
+private:
+    struct Marker {
+        const char* name;
+        std::uint32_t depth;
+        Clock::time_point cpuBegin;
+        Clock::time_point cpuEnd;
+    };
+
+    // Queries 2 * i and 2 * i + 1 hold the begin and end timestamps of marker i
+    struct Frame {
+        std::vector<Marker> markers;
+        std::vector<unsigned int> queries;
+        bool pending = false;
+    };
+
+    struct Series {
+        const char* name;
+        std::uint32_t depth;
+        std::vector<float> cpuMs;
+        std::vector<float> gpuMs;
+        std::size_t next = 0;
+    };
+
+    struct TraceEvent {
+        const char* name;
+        bool gpu;
+        double startUs;
+        double durationUs;
+    };
+
+    Profiler() = default;
+
+    void resolve(Frame& frame);
+    void record(const Marker& marker, float cpuMs, float gpuMs);
+    void calibrate();
+
+    std::vector<Frame> _frames;
+    std::uint64_t _frameIndex = 0;
+    Frame* _current = nullptr;
+    std::vector<std::uint32_t> _open;
+
+    std::vector<Series> _series;
+    std::uint64_t _dropped = 0;
+
+    bool _tracing = false;
+    std::vector<TraceEvent> _trace;
+
+    // A GL timestamp taken at a known CPU time, maps GPU times on the CPU timeline
+    std::int64_t _gpuOriginNs = 0;
+    Clock::time_point _cpuOrigin;
+    Clock::time_point _traceStart;
+};
+
+// Records a marker over its lifetime
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : marker(Profiler::get().beginMarker(name)) {}
+    ~ProfileScope() { Profiler::get().endMarker(marker); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    std::uint32_t marker;
+};
+
+} // namespace pbr
+
+#endif
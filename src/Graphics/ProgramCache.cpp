@@ -0,0 +1,135 @@
+#include <ProgramCache.h>
+
+#include <Hash.h>
+#include <MappedFile.h>
+#include <Shader.h>
+
+#include <glad/glad.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace pbr;
+using namespace pbr::math;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Beside the shader folder, which is replaced with a copy of the sources on every build
+const fs::path CacheFolder = "./cache/programs";
+
+constexpr std::array<char, 8> Magic{'P', 'B', 'R', 'P', 'R', 'O', 'G', '\0'};
+constexpr std::uint32_t Version = 1;
+
+struct ProgramBinaryHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t format;
+    std::uint64_t key;
+    std::uint64_t size;
+};
+
+static_assert(std::is_trivially_copyable_v<ProgramBinaryHeader>);
+
+bool BinariesSupported() {
+    GLint numFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+    return numFormats > 0;
+}
+
+fs::path CachePath(const std::string& name, std::uint64_t key) {
+    return CacheFolder / std::format("{}-{:016x}.bin", name, key);
+}
+
+std::uint64_t HashString(std::string_view str, std::uint64_t seed) {
+    return HashBytes(std::as_bytes(std::span{str}), seed);
+}
+
+} // namespace
+
+std::uint64_t pbr::ProgramCacheKey(std::span<const ShaderSource> sources) {
+    std::uint64_t key = Version;
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const auto* str = reinterpret_cast<const char*>(glGetString(name));
+        key = HashString(str ? str : "", key);
+    }
+
+    for (const auto& source : sources) {
+        const auto type = static_cast<unsigned int>(source.shaderType());
+        key = HashBytes(std::as_bytes(std::span{&type, 1}), key);
+        key = HashString(source.text(), key);
+    }
+
+    return key;
+}
+
+bool pbr::LoadProgramBinary(Program& program, const std::string& name,
+                            std::uint64_t key) {
+    const fs::path path = CachePath(name, key);
+    if (!fs::exists(path) || !BinariesSupported())
+        return false;
+
+    MappedFile file{path};
+    if (!file.isOpen() || file.size() < sizeof(ProgramBinaryHeader))
+        return false;
+
+    const auto& header = *file.as<ProgramBinaryHeader>();
+    if (header.magic != Magic || header.version != Version || header.key != key ||
+        header.size != file.size() - sizeof(ProgramBinaryHeader)) {
+        LOGW("Discarding invalid program binary {}.", path.string());
+        return false;
+    }
+
+    const auto binary = file.data().subspan(sizeof(ProgramBinaryHeader));
+    if (!program.loadBinary(header.format, binary)) {
+        LOGW("Program binary {} was rejected by the driver.", path.string());
+        return false;
+    }
+
+    return true;
+}
+
+bool pbr::WriteProgramBinary(const Program& program, const std::string& name,
+                             std::uint64_t key) {
+    if (!BinariesSupported())
+        return false;
+
+    unsigned int format = 0;
+    const auto binary = program.binary(format);
+    if (binary.empty())
+        return false;
+
+    std::error_code ec;
+    fs::create_directories(CacheFolder, ec);
+
+    const ProgramBinaryHeader header{.magic = Magic,
+                                     .version = Version,
+                                     .format = format,
+                                     .key = key,
+                                     .size = binary.size()};
+
+    // Write to a temporary first so an interrupted write never leaves a truncated binary
+    const fs::path path = CachePath(name, key);
+    fs::path tmpPath = path;
+    tmpPath += ".tmp";
+
+    {
+        std::ofstream file{tmpPath, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+
+        if (!file) {
+            LOGW("Failed to write program binary {}.", path.string());
+            return false;
+        }
+    }
+
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+
+    return true;
+}
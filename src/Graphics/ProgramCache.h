@@ -0,0 +1,25 @@
+#ifndef PBR_PROGRAMCACHE_H
+#define PBR_PROGRAMCACHE_H
+
+#include <PBR.h>
+
+#include <span>
+
+namespace pbr {
+
+class Program;
+class ShaderSource;
+
+// Linked programs are stored with glGetProgramBinary under cache/programs, one file per
+// program variant. The key hashes the preprocessed sources of every stage, defines
+// included, and the GL vendor, renderer and version strings, so edited shaders and
+// driver updates miss the cache and are compiled again.
+std::uint64_t ProgramCacheKey(std::span<const ShaderSource> sources);
+
+bool LoadProgramBinary(Program& program, const std::string& name, std::uint64_t key);
+bool WriteProgramBinary(const Program& program, const std::string& name,
+                        std::uint64_t key);
+
+} // namespace pbr
+
+#endif
@@ -7,6 +7,7 @@
 #include <VertexArrays.h>
 #include <Shader.h>
 #include <PBRMaterial.h>
+#include <TextureCache.h>
 #include <Utils.h>
 
 using namespace pbr;
@@ -18,6 +19,39 @@ namespace {
 
 enum SkyboxUniform { ENV_MAP = 1 };
 
+// Attribute locations match pbr.vs. Packed normals and tangents only fill the xy of
+// their attributes and are decoded there.
+std::vector<BufferLayoutEntry> VertexLayout(VertexFormat format) {
+    using enum AttribType;
+
+    if (format == VertexFormat::Compact) {
+        constexpr std::size_t Stride = sizeof(CompactVertex);
+        return {
+            {0, 3, Float, Stride, offsetof(CompactVertex, position), false},
+            {1, 2, Short, Stride, offsetof(CompactVertex, normal),   true },
+            {2, 2, Half,  Stride, offsetof(CompactVertex, uv),       false},
+            {3, 2, Short, Stride, offsetof(CompactVertex, tangent),  true }
+        };
+    }
+
+    if (format == VertexFormat::Quantized) {
+        constexpr std::size_t Stride = sizeof(QuantizedVertex);
+        return {
+            {0, 3, UShort, Stride, offsetof(QuantizedVertex, position), true },
+            {1, 2, Short,  Stride, offsetof(QuantizedVertex, normal),   true },
+            {2, 2, Half,   Stride, offsetof(QuantizedVertex, uv),       false},
+            {3, 2, Short,  Stride, offsetof(QuantizedVertex, tangent),  true }
+        };
+    }
+
+    return {
+        {0, 3, Float, sizeof(Vertex), offsetof(Vertex, position), false},
+        {1, 3, Float, sizeof(Vertex), offsetof(Vertex, normal),   false},
+        {2, 2, Float, sizeof(Vertex), offsetof(Vertex, uv),       false},
+        {3, 4, Float, sizeof(Vertex), offsetof(Vertex, tangent),  false}
+    };
+}
+
 void BindNamedTexture(const std::string& name, unsigned int texUnit) {
     glActiveTexture(GL_TEXTURE0 + texUnit);
     auto handle = Resource.get<Texture>(name)->id();
@@ -26,12 +60,16 @@ void BindNamedTexture(const std::string& name, unsigned int texUnit) {
 
 const std::array OglCullMode{GL_FRONT, GL_BACK};
 
+constexpr std::size_t StagingBufferSize = 64 * 1024 * 1024;
+
 } // namespace
 
 // clang-format off
 void RenderInterface::initialize() {
     initOpenGLState();
 
+    staging.create(StagingBufferSize);
+
     // Create auxiliary 1x1 textures
     ImageFormat fmt{.pFmt = PixelFormat::U8, .width = 1, .height = 1, .nChannels = 3};
     CreateNamedTexture("null", Image{fmt, {0, 0, 0}});
@@ -64,30 +102,35 @@ void RenderInterface::initOpenGLState() {
     glEnable(GL_MULTISAMPLE);
 
     glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferAlignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageBufferAlignment);
 }
 
 void RenderInterface::initMainShaders() {
-    // PBR shader
-    auto defines = std::vector{"MULTISCATTERING"s, "HAS_CLEARCOAT"s};
+    // PBR shader, variants are compiled when a material first needs them
     auto pbrSources = std::vector{"pbr.vs"s, "pbr.fs"s};
-    auto pbrProg = CompileAndLinkProgram("pbr", pbrSources, defines);
-
-    // Set fixed sampler uniforms
-    using pbr::PBRUniform;
-    pbrProg->setSampler(DIFFUSE_MAP, 1);
-    pbrProg->setSampler(NORMAL_MAP, 2);
-    pbrProg->setSampler(METALLIC_MAP, 3);
-    pbrProg->setSampler(ROUGHNESS_MAP, 4);
-    pbrProg->setSampler(OCCLUSION_MAP, 5);
-    pbrProg->setSampler(EMISSIVE_MAP, 6);
-    pbrProg->setSampler(CLEARCOAT_NORMAL_MAP, 7);
-    pbrProg->setSampler(ENV_IRRADIANCE_MAP, 8);
-    pbrProg->setSampler(ENV_GGX_MAP, 9);
-    pbrProg->setSampler(ENV_BRDF_MAP, 10);
+    auto initPbr = [](Program& prog, std::uint32_t features) {
+        // Set fixed sampler uniforms, maps a variant doesn't sample are compiled out
+        using pbr::PBRUniform;
+        auto setMap = [&](PBRFeature feature, PBRUniform map, int unit) {
+            if (features & ToUnderlying(feature))
+                prog.setSampler(map, unit);
+        };
+
+        setMap(PBRFeature::DiffuseMap, DIFFUSE_MAP, 1);
+        setMap(PBRFeature::NormalMap, NORMAL_MAP, 2);
+        setMap(PBRFeature::MetallicMap, METALLIC_MAP, 3);
+        setMap(PBRFeature::RoughnessMap, ROUGHNESS_MAP, 4);
+        setMap(PBRFeature::OcclusionMap, OCCLUSION_MAP, 5);
+        setMap(PBRFeature::EmissiveMap, EMISSIVE_MAP, 6);
+        setMap(PBRFeature::ClearCoatNormalMap, CLEARCOAT_NORMAL_MAP, 7);
+        prog.setSampler(ENV_IRRADIANCE_MAP, 8);
+        prog.setSampler(ENV_GGX_MAP, 9);
+        prog.setSampler(ENV_BRDF_MAP, 10);
+    };
+    pbrVariants = std::make_unique<ShaderPermutations>("pbr", pbrSources,
+                                                       PBRFeatureDefines(), initPbr);
     BindNamedTexture("brdf", 10);
 
-    Resource.add<Program>("pbr", std::move(pbrProg));
-
     // Skybox shader
     auto skyBoxSources = std::vector{"skybox.vs"s, "skybox.fs"s};
     auto skyProg = CompileAndLinkProgram("skybox", skyBoxSources);
@@ -95,6 +138,12 @@ void RenderInterface::initMainShaders() {
     skyProg->setSampler(ENV_MAP, 5);
 
     Resource.add<Program>("skybox", std::move(skyProg));
+
+    // GPU culling, see MeshletCuller and OcclusionCuller
+    for (const auto& name : {"meshletCull"s, "instanceCull"s, "hizBuild"s}) {
+        auto sources = std::vector{name + ".comp"};
+        Resource.add<Program>(name, CompileAndLinkProgram(name, sources));
+    }
 }
 
 void RenderInterface::setCullFace(CullMode mode) {
@@ -131,22 +180,30 @@ void RenderInterface::setSampler(int loc, unsigned int id) {
 }
 
 std::unique_ptr<VertexArrays> pbr::CreateVertexArrays(const Geometry& geo) {
-    auto& verts = geo.vertices();
-    auto& indices = geo.indices();
+    return CreateVertexArrays(geo.vertices(), geo.indices(), geo.vertexFormat(),
+                              geo.bbox());
+}
 
+std::unique_ptr<VertexArrays> pbr::CreateVertexArrays(std::span<const Vertex> verts,
+                                                      std::span<const unsigned int> indices,
+                                                      VertexFormat format,
+                                                      const BBox3& bbox) {
     auto vertexArrays = std::make_unique<VertexArrays>();
 
-    Buffer vertexBuffer{BufferType::Array, sizeof(Vertex) * verts.size(),
-                        BufferFlag::None, verts.data()};
+    // Full vertices are uploaded straight from the given memory
+    std::vector<std::byte> packed;
+    const void* vertexData = verts.data();
+    if (format != VertexFormat::Full) {
+        packed = PackVertices(verts, format, bbox);
+        vertexData = packed.data();
+    }
 
-    BufferLayoutEntry entries[] = {
-        {0, 3, AttribType::Float, sizeof(Vertex), offsetof(Vertex, position)},
-        {1, 3, AttribType::Float, sizeof(Vertex), offsetof(Vertex, normal)  },
-        {2, 2, AttribType::Float, sizeof(Vertex), offsetof(Vertex, uv)      },
-        {3, 4, AttribType::Float, sizeof(Vertex), offsetof(Vertex, tangent) }
-    };
+    const std::size_t stride = VertexStride(format);
+    Buffer vertexBuffer{BufferType::Array, stride * verts.size(), BufferFlag::None,
+                        vertexData};
 
-    vertexArrays->addVertexBuffer(std::move(vertexBuffer), entries, 0, sizeof(Vertex),
+    auto entries = VertexLayout(format);
+    vertexArrays->addVertexBuffer(std::move(vertexBuffer), entries, 0, stride,
                                   verts.size());
 
     if (indices.size() > 0) {
@@ -195,17 +252,8 @@ std::shared_ptr<Texture> pbr::CreateNamedTexture(const std::string& name,
 std::shared_ptr<Texture> pbr::CreateNamedCubemap(const std::string& name,
                                                  const fs::path& path,
                                                  const TexSampler& sampler) {
-    auto cube = LoadCubemap(path);
+    auto cube = LoadCubemap(ResolveCubemapPath(path));
     auto tex = std::make_shared<Texture>(*cube, sampler);
     Resource.add(name, tex);
     return tex;
 }
-
-Image pbr::ReadMainFramebuffer(int x, int y, int width, int height) {
-    Image img{
-        {PixelFormat::U8, width, height, 3},
-        1
-    };
-    glReadPixels(x, y, width, height, GL_RGB, GL_UNSIGNED_BYTE, img.data());
-    return img;
-}
\ No newline at end of file
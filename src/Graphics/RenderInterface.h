@@ -6,6 +6,9 @@
 #include <PBR.h>
 #include <PBRMath.h>
 #include <Texture.h>
+#include <StagingBuffer.h>
+#include <ShaderPermutations.h>
+#include <PackedVertex.h>
 
 #include <span>
 #include <filesystem>
@@ -19,6 +22,7 @@ namespace pbr {
 
 class VertexArrays;
 class Geometry;
+struct Vertex;
 class Image;
 
 enum class CullMode : int { Front = 0, Back  = 1};
@@ -53,6 +57,19 @@ public:
         return (structSize + uniformBufferAlignment - 1) & ~(uniformBufferAlignment - 1);
     }
 
+    std::size_t alignStorageBuffer(std::size_t size) {
+        return (size + storageBufferAlignment - 1) & ~(storageBufferAlignment - 1);
+    }
+
+    StagingBuffer& stagingBuffer() { return staging; }
+
+    // Variants of the PBR program, selected by PBRFeature bits
+    ShaderPermutations& pbrPrograms() { return *pbrVariants; }
+
+    // Vertex layout of the meshes loaded from files
+    VertexFormat meshVertexFormat() const { return meshFormat; }
+    void setMeshVertexFormat(VertexFormat format) { meshFormat = format; }
+
 private:
     RenderInterface() = default;
 
@@ -60,9 +77,19 @@ private:
     void initMainShaders();
 
     GLint uniformBufferAlignment;
+    GLint storageBufferAlignment;
+
+    // Shared by all texture uploads
+    StagingBuffer staging;
+
+    std::unique_ptr<ShaderPermutations> pbrVariants;
+    VertexFormat meshFormat = VertexFormat::Full;
 };
 
 std::unique_ptr<VertexArrays> CreateVertexArrays(const Geometry& geo);
+std::unique_ptr<VertexArrays> CreateVertexArrays(std::span<const Vertex> verts,
+                                                 std::span<const unsigned int> indices,
+                                                 VertexFormat format, const BBox3& bbox);
 
 std::shared_ptr<Texture> CreateNamedTexture(const std::string& name, const Image& img,
                                             const TexSampler& sampler = {});
@@ -71,8 +98,6 @@ std::shared_ptr<Texture> CreateNamedTexture(const std::string& name, const fs::p
 std::shared_ptr<Texture> CreateNamedCubemap(const std::string& name, const fs::path& path,
                                             const TexSampler& sampler = {});
 
-Image ReadMainFramebuffer(int x, int y, int width, int height);
-
 } // namespace pbr
 
 #endif
\ No newline at end of file
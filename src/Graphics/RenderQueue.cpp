@@ -0,0 +1,319 @@
+#include <RenderQueue.h>
+
+#include <Camera.h>
+#include <Perspective.h>
+#include <Shape.h>
+#include <Material.h>
+#include <Geometry.h>
+#include <JobSystem.h>
+#include <RenderInterface.h>
+
+using namespace pbr;
+
+namespace {
+
+constexpr unsigned int ProgramBits = 8;
+constexpr unsigned int TextureSetBits = 20;
+constexpr unsigned int GeometryBits = 17;
+constexpr unsigned int LodBits = 3;
+constexpr unsigned int DepthBits = 16;
+
+// Instances written per job
+constexpr std::size_t InstanceGrain = 1024;
+
+constexpr unsigned int DepthShift = 0;
+constexpr unsigned int LodShift = DepthShift + DepthBits;
+constexpr unsigned int GeometryShift = LodShift + LodBits;
+constexpr unsigned int TextureSetShift = GeometryShift + GeometryBits;
+constexpr unsigned int ProgramShift = TextureSetShift + TextureSetBits;
+
+static_assert(ProgramShift + ProgramBits == 64);
+
+constexpr std::uint64_t Mask(unsigned int bits) {
+    return (std::uint64_t(1) << bits) - 1;
+}
+
+constexpr std::uint64_t Field(std::uint64_t key, unsigned int shift, unsigned int bits) {
+    return (key >> shift) & Mask(bits);
+}
+
+// Pixels one unit spans at unit distance, 0 for cameras without a field of view
+float PixelsPerUnit(const Camera& camera) {
+    const auto* perspective = dynamic_cast<const Perspective*>(&camera);
+    if (!perspective)
+        return 0.0f;
+
+    return camera.height() / (2.0f * std::tan(Radians(perspective->fov()) / 2.0f));
+}
+
+std::uint64_t QuantizeDepth(float dist, float far) {
+    const float t = std::clamp(dist / far, 0.0f, 1.0f);
+    return static_cast<std::uint64_t>(t * Mask(DepthBits));
+}
+
+// LSD radix sort over the 8 key bytes. Histograms for every digit are gathered in a
+// single pass and digits where all keys agree are skipped, which is the common case
+// for the program byte and the unused high bits of each index.
+void RadixSort(std::vector<DrawItem>& items, std::vector<DrawItem>& scratch) {
+    constexpr unsigned int NumDigits = 8;
+    constexpr unsigned int Radix = 256;
+
+    std::array<std::array<std::uint32_t, Radix>, NumDigits> counts{};
+    for (const auto& item : items)
+        for (unsigned int d = 0; d < NumDigits; ++d)
+            ++counts[d][(item.key >> (d * 8)) & 0xFF];
+
+    scratch.resize(items.size());
+
+    for (unsigned int d = 0; d < NumDigits; ++d) {
+        auto& count = counts[d];
+
+        const auto firstKey = (items.front().key >> (d * 8)) & 0xFF;
+        if (count[firstKey] == items.size())
+            continue;
+
+        std::uint32_t offset = 0;
+        for (auto& c : count)
+            offset += std::exchange(c, offset);
+
+        for (const auto& item : items)
+            scratch[count[(item.key >> (d * 8)) & 0xFF]++] = item;
+
+        items.swap(scratch);
+    }
+}
+
+} // namespace
+
+std::uint32_t RenderQueue::programIndex(RRID program) {
+    auto [it, inserted] = _programs.try_emplace(program, _programs.size());
+    DCHECK_LE(it->second, Mask(ProgramBits));
+    return it->second;
+}
+
+std::uint32_t RenderQueue::textureSetIndex(const Material& material) {
+    auto texs = material.textures();
+    std::vector<RRID> set{texs.begin(), texs.end()};
+
+    auto [it, inserted] = _textureSets.try_emplace(std::move(set), _textureSets.size());
+    DCHECK_LE(it->second, Mask(TextureSetBits));
+    return it->second;
+}
+
+std::uint32_t RenderQueue::geometryIndex(const Geometry& geometry) {
+    auto [it, inserted] = _geometries.try_emplace(&geometry, _geometries.size());
+    DCHECK_LE(it->second, Mask(GeometryBits));
+    return it->second;
+}
+
+const RenderQueue::MaterialEntry& RenderQueue::materialEntry(const Material& material) {
+    auto it = _materials.find(&material);
+    if (it != _materials.end())
+        return it->second;
+
+    MaterialEntry entry{.textureSet = textureSetIndex(material),
+                        .slot = static_cast<std::uint32_t>(_materialSlots.size())};
+    _materialSlots.push_back(&material);
+
+    return _materials.emplace(&material, entry).first->second;
+}
+
+void RenderQueue::clearIndices() {
+    _programs.clear();
+    _textureSets.clear();
+    _geometries.clear();
+}
+
+void RenderQueue::build(const std::vector<sref<Shape>>& shapes,
+                        std::span<const std::uint32_t> visible, const Camera& camera) {
+    _items.clear();
+    _materials.clear();
+    _materialSlots.clear();
+
+    // Each shape adds at most one entry to each map, more means some belong to objects
+    // that are gone, whose addresses may have been reused
+    if (std::max({_programs.size(), _textureSets.size(), _geometries.size()}) >
+        shapes.size())
+        clearIndices();
+
+    const Vec3 eye = camera.position();
+    const float far = camera.far();
+    const float pixelsPerUnit = PixelsPerUnit(camera);
+    const float lodError = pixelsPerUnit > 0.0f ? _lodError : 0.0f;
+    _viewProj = camera.viewProjMatrix();
+
+    for (std::uint32_t s : visible) {
+        const auto& shape = shapes[s];
+        const auto& material = *shape->material();
+        const auto& geometry = *shape->geometry();
+
+        const auto& entry = materialEntry(material);
+        const auto lod = shape->selectLod(eye, pixelsPerUnit, lodError);
+
+        const Mat4& toWorld = shape->objToWorld();
+        const Vec3 position{toWorld(0, 3), toWorld(1, 3), toWorld(2, 3)};
+        const float dist = (position - eye).length();
+
+        std::uint64_t key = 0;
+        key |= std::uint64_t(programIndex(material.program())) << ProgramShift;
+        key |= std::uint64_t(entry.textureSet) << TextureSetShift;
+        key |= std::uint64_t(geometryIndex(geometry)) << GeometryShift;
+        key |= std::uint64_t(lod) << LodShift;
+        key |= QuantizeDepth(dist, far) << DepthShift;
+
+        _items.push_back({key, entry.slot, shape.get()});
+    }
+
+    if (!_items.empty())
+        RadixSort(_items, _scratch);
+}
+
+void RenderQueue::submit(std::span<InstanceData> instances,
+                         std::span<MaterialData> materials) {
+    DCHECK_LE(_items.size(), instances.size());
+    DCHECK_LE(_materialSlots.size(), materials.size());
+
+    _stats = {};
+
+    for (std::size_t m = 0; m < _materialSlots.size(); ++m)
+        _materialSlots[m]->toData(materials[m]);
+
+    auto writeInstances = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto& shape = *_items[i].shape;
+            const auto& geometry = *shape.geometry();
+            instances[i] = {.modelMatrix = shape.objToWorld(),
+                            .normalMatrix = Mat4(shape.normalMatrix()),
+                            .positionScale = geometry.positionScale(),
+                            .positionOffset = geometry.positionOffset(),
+                            .material = _items[i].material};
+        }
+    };
+    JobSystem::get().parallelFor(_items.size(), InstanceGrain, writeInstances);
+
+    // Runs of items that only differ in depth share all state and become one draw
+    _batches.clear();
+    for (std::size_t first = 0, last = 0; first < _items.size(); first = last) {
+        const auto batchKey = _items[first].key >> LodShift;
+
+        last = first + 1;
+        while (last < _items.size() && (_items[last].key >> LodShift) == batchKey)
+            ++last;
+
+        const auto& geometry = *_items[first].shape->geometry();
+        const auto lod = static_cast<unsigned int>(Field(batchKey, 0, LodBits));
+        const bool meshlets = _meshletCulling && lod == 0 && geometry.hasMeshlets();
+
+        _batches.push_back({.first = first,
+                            .last = last,
+                            .lod = lod,
+                            .meshlets = meshlets,
+                            .early = std::nullopt,
+                            .late = std::nullopt});
+        _stats.meshletDraws += meshlets;
+    }
+
+    _commands.clear();
+    _meshletCuller.clear();
+    if (_occlusionCulling)
+        _occlusionCuller.clear(_items.size());
+
+    cull(false);
+    drawBatches(false);
+
+    if (_occlusionCulling) {
+        _occlusionCuller.buildPyramid(_viewProj);
+        cull(true);
+        drawBatches(true);
+    }
+
+    _stats.meshletsTested = static_cast<unsigned int>(_meshletCuller.numTested());
+    _stats.occlusionTested =
+        _occlusionCulling ? static_cast<unsigned int>(_occlusionCuller.numTested()) : 0;
+
+    glBindVertexArray(0);
+}
+
+void RenderQueue::cull(bool late) {
+    bool culled = false;
+    for (auto& batch : _batches) {
+        if (!_occlusionCulling && !batch.meshlets)
+            continue;
+
+        const auto& geometry = *_items[batch.first].shape->geometry();
+        const auto first = static_cast<unsigned int>(batch.first);
+        const auto count = static_cast<unsigned int>(batch.last - batch.first);
+        auto& range = late ? batch.late : batch.early;
+
+        auto gate = Visibility::Any;
+        if (_occlusionCulling) {
+            range = _occlusionCuller.add(_commands, geometry, batch.lod, first, count,
+                                         late, batch.meshlets);
+            gate = late ? Visibility::Late : Visibility::Early;
+        }
+
+        if (batch.meshlets)
+            range = _meshletCuller.add(_commands, geometry, first, count, gate);
+
+        culled = true;
+    }
+
+    if (!culled)
+        return;
+
+    // Every dispatch is recorded before the first draw waits on them
+    _commands.prepare();
+    if (_occlusionCulling)
+        _occlusionCuller.dispatch();
+    _meshletCuller.dispatch();
+    _commands.bind();
+}
+
+void RenderQueue::drawBatches(bool late) {
+    RRID lastProgram = 0;
+    std::uint64_t lastTextureSet = ~std::uint64_t(0);
+    const Geometry* lastGeometry = nullptr;
+
+    for (const auto& batch : _batches) {
+        const auto& range = late ? batch.late : batch.early;
+        if (late && !range)
+            continue;
+
+        const auto batchKey = _items[batch.first].key >> LodShift;
+
+        const auto& material = *_items[batch.first].shape->material();
+        const auto& geometry = *_items[batch.first].shape->geometry();
+
+        if (material.program() != lastProgram) {
+            material.use();
+            lastProgram = material.program();
+            ++_stats.programBinds;
+        }
+
+        const auto textureSet =
+            Field(batchKey, TextureSetShift - LodShift, TextureSetBits);
+        if (textureSet != lastTextureSet) {
+            material.bindTextures();
+            lastTextureSet = textureSet;
+            ++_stats.textureBinds;
+        }
+
+        if (&geometry != lastGeometry) {
+            geometry.bind();
+            lastGeometry = &geometry;
+            ++_stats.vaoBinds;
+        }
+
+        const auto count = static_cast<unsigned int>(batch.last - batch.first);
+        if (range)
+            _commands.draw(geometry, *range);
+        else
+            geometry.submit(count, static_cast<unsigned int>(batch.first), batch.lod);
+
+        ++_stats.draws;
+        if (!late) {
+            _stats.instances += count;
+            _stats.triangles += count * (geometry.lod(batch.lod).numIndices / 3);
+        }
+    }
+}
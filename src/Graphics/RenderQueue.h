@@ -0,0 +1,136 @@
+#ifndef PBR_RENDERQUEUE_H
+#define PBR_RENDERQUEUE_H
+
+#include <PBR.h>
+#include <PBRMath.h>
+#include <DrawCommandBuffer.h>
+#include <MeshletCuller.h>
+#include <OcclusionCuller.h>
+
+#include <map>
+#include <span>
+#include <unordered_map>
+
+namespace pbr {
+
+class Camera;
+class Shape;
+class Material;
+class Geometry;
+struct MaterialData;
+
+using namespace pbr::math;
+
+// Matches the std430 Instance struct in pbr.vs
+struct InstanceData {
+    Mat4 modelMatrix;
+    Mat4 normalMatrix;
+    Vec4 positionScale; // Of the geometry's vertex format, see PositionScale()
+    Vec4 positionOffset;
+    alignas(16) unsigned int material;
+};
+
+struct DrawItem {
+    std::uint64_t key;
+    std::uint32_t material;
+    Shape* shape;
+};
+
+struct DrawStats {
+    unsigned int draws = 0;
+    unsigned int instances = 0;
+    unsigned int programBinds = 0;
+    unsigned int textureBinds = 0;
+    unsigned int vaoBinds = 0;
+    unsigned int triangles = 0; // Before meshlet culling
+    unsigned int meshletDraws = 0;
+    unsigned int meshletsTested = 0;
+    unsigned int occlusionTested = 0;
+};
+
+// Sorts shapes by a 64-bit state key so consecutive draws share as much GL state as
+// possible. From most to least significant bits:
+//   [63..56] program | [55..36] texture set | [35..19] geometry | [18..16] lod
+//   | [15..0] coarse depth
+// Runs of shapes whose keys only differ in depth are drawn as a single instanced call,
+// reading their transforms and material parameters from storage buffers. Full detail
+// draws of geometries with meshlets cull them on the GPU, and with occlusion culling
+// every instance is tested against a depth pyramid. Culled draws are drawn indirectly.
+class RenderQueue {
+public:
+    // Queues the shapes at the given indices, usually the ones that survived culling
+    void build(const std::vector<sref<Shape>>& shapes,
+               std::span<const std::uint32_t> visible, const Camera& camera);
+    void submit(std::span<InstanceData> instances, std::span<MaterialData> materials);
+
+    std::size_t size() const { return _items.size(); }
+
+    // Projected error, in pixels, shapes pick their level of detail by. 0 draws every
+    // shape at full detail.
+    float lodError() const { return _lodError; }
+    void setLodError(float pixels) { _lodError = pixels; }
+
+    bool meshletCulling() const { return _meshletCulling; }
+    void setMeshletCulling(bool state) { _meshletCulling = state; }
+
+    bool occlusionCulling() const { return _occlusionCulling; }
+    void setOcclusionCulling(bool state) { _occlusionCulling = state; }
+
+    const DrawStats& stats() const { return _stats; }
+
+private:
+    struct Batch {
+        std::size_t first;
+        std::size_t last;
+        unsigned int lod;
+        bool meshlets;
+        std::optional<DrawRange> early; // Indirect draws, if culled on the GPU
+        std::optional<DrawRange> late;  // What the early occlusion pass occluded
+    };
+
+    struct MaterialEntry {
+        std::uint32_t textureSet;
+        std::uint32_t slot;
+    };
+
+    void clearIndices();
+    std::uint32_t programIndex(RRID program);
+    std::uint32_t textureSetIndex(const Material& material);
+    std::uint32_t geometryIndex(const Geometry& geometry);
+    const MaterialEntry& materialEntry(const Material& material);
+
+    // Culls the batches for one occlusion pass on the GPU, all before their draws
+    void cull(bool late);
+    void drawBatches(bool late);
+
+    std::vector<DrawItem> _items;
+    std::vector<DrawItem> _scratch;
+    std::vector<Batch> _batches;
+
+    // Compact indices that keep the key fields small. They persist across frames so
+    // the sort order is stable while the scene doesn't change, and are keyed by address
+    // so they're cleared once they outnumber the shapes.
+    std::unordered_map<RRID, std::uint32_t> _programs;
+    std::map<std::vector<RRID>, std::uint32_t> _textureSets;
+    std::unordered_map<const Geometry*, std::uint32_t> _geometries;
+
+    // Texture set and storage buffer slot of each material, resolved once per build
+    std::unordered_map<const Material*, MaterialEntry> _materials;
+    std::vector<const Material*> _materialSlots;
+
+    DrawStats _stats;
+    float _lodError = 1.0f;
+
+    Mat4 _viewProj;
+    DrawCommandBuffer _commands;
+
+    MeshletCuller _meshletCuller;
+    bool _meshletCulling = true;
+
+    OcclusionCuller _occlusionCuller;
+    bool _occlusionCulling = true;
+};
+
+} // namespace pbr
+
+#endif
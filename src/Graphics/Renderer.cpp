@@ -5,15 +5,42 @@
 #include <Shape.h>
 #include <Scene.h>
 #include <Skybox.h>
+#include <Material.h>
+#include <PBRMaterial.h>
 
+#include <JobSystem.h>
+#include <Profiler.h>
 #include <RenderInterface.h>
 
 using namespace pbr;
 
 namespace {
-constexpr unsigned int NumLights = 5;
+constexpr std::size_t MinInstances = 256;
+constexpr std::size_t MinLights = 64;
+constexpr std::size_t MinLightIndices = 4096;
+
+// Light code the PBR variants need for the lights in the scene
+std::uint32_t LightFeatures(std::span<const sref<Light>> lights) {
+    PBRFeature features = PBRFeature::None;
+    for (const auto& light : lights) {
+        switch (light->type()) {
+            case LightType::Spot:
+                features = features | PBRFeature::SpotLights;
+                break;
+            case LightType::Sphere:
+            case LightType::Tube:
+                features = features | PBRFeature::AreaLights;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return ToUnderlying(features);
 }
 
+} // namespace
+
 void Renderer::setGamma(float gamma) {
     _gamma = gamma;
 }
@@ -42,7 +69,7 @@ void Renderer::setSkyboxDraw(bool state) {
     _drawSkybox = state;
 }
 
-void Renderer::uploadUniformBuffer(const Scene& scene, const Camera& camera) {
+void Renderer::uploadUniformBuffer(const Camera& camera) {
     // Renderer
     auto rd = _uniformBuffer.getBind<RendererData>(RENDERER_BUFFER);
     rd->gamma = _gamma;
@@ -64,18 +91,93 @@ void Renderer::uploadUniformBuffer(const Scene& scene, const Camera& camera) {
     cd->viewPos = camera.position();
     cd->viewProjMatrix = camera.viewProjMatrix();
 
-    // Lights
-    auto ld = _uniformBuffer.getBind<LightData>(LIGHTS_BUFFER);
-    const auto& lights = scene.lights();
+    // Light clusters
+    *_uniformBuffer.getBind<ClusterData>(CLUSTER_BUFFER) = _clusters.data();
+}
+
+void Renderer::reserveLights(std::size_t numLights, std::size_t numIndices) {
+    using enum BufferFlag;
+
+    if (_lightBuffer && numLights <= _lightCapacity && numIndices <= _indexCapacity)
+        return;
+
+    if (numLights > _lightCapacity)
+        _lightCapacity = std::max({numLights, 2 * _lightCapacity, MinLights});
+    if (numIndices > _indexCapacity)
+        _indexCapacity = std::max({numIndices, 2 * _indexCapacity, MinLightIndices});
+
+    auto ldSize = RHI.alignStorageBuffer(sizeof(LightData) * _lightCapacity);
+    auto cgSize =
+        RHI.alignStorageBuffer(sizeof(ClusterRange) * LightClusters::numClusters());
+    auto liSize = RHI.alignStorageBuffer(sizeof(unsigned int) * _indexCapacity);
+
+    auto cgOffset = ldSize;
+    auto liOffset = cgOffset + cgSize;
+
+    _lightBuffer = std::make_unique<RingBuffer>();
+    _lightBuffer->create(BufferType::ShaderStorage, 3, ldSize + cgSize + liSize,
+                         Write | Persistent | Coherent);
+
+    _lightBuffer->registerBind(LIGHT_BUFFER, 0, ldSize);
+    _lightBuffer->registerBind(CLUSTER_GRID_BUFFER, cgOffset, cgSize);
+    _lightBuffer->registerBind(LIGHT_INDEX_BUFFER, liOffset, liSize);
+}
+
+void Renderer::uploadLights() {
+    auto lights = _clusters.lights();
+    auto clusters = _clusters.clusters();
+    auto indices = _clusters.indices();
+
+    reserveLights(lights.size(), indices.size());
+
+    _lightBuffer->wait();
+    _lightBuffer->rebind();
+
+    std::copy(lights.begin(), lights.end(), _lightBuffer->getBind<LightData>(LIGHT_BUFFER));
+    std::copy(clusters.begin(), clusters.end(),
+              _lightBuffer->getBind<ClusterRange>(CLUSTER_GRID_BUFFER));
+    std::copy(indices.begin(), indices.end(),
+              _lightBuffer->getBind<unsigned int>(LIGHT_INDEX_BUFFER));
+}
+
+void Renderer::reserveInstances(std::size_t count) {
+    using enum BufferFlag;
+
+    if (count <= _instanceCapacity)
+        return;
+
+    _instanceCapacity = std::max({count, 2 * _instanceCapacity, MinInstances});
+
+    auto instSize = RHI.alignStorageBuffer(sizeof(InstanceData) * _instanceCapacity);
+    auto matSize = RHI.alignStorageBuffer(sizeof(MaterialData) * _instanceCapacity);
 
-    auto numLights = Min(NumLights, lights.size());
-    for (std::size_t l = 0; l < numLights; ++l)
-        lights[l]->toData(ld[l]);
+    // The old storage is deleted right away, GL defers freeing it until the commands of
+    // in-flight frames that read it have run
+    _instanceBuffer = std::make_unique<RingBuffer>();
+    _instanceBuffer->create(BufferType::ShaderStorage, 3, instSize + matSize,
+                            Write | Persistent | Coherent);
+
+    _instanceBuffer->registerBind(INSTANCE_BUFFER, 0, instSize);
+    _instanceBuffer->registerBind(MATERIAL_BUFFER, instSize, matSize);
 }
 
 void Renderer::drawShapes(const Scene& scene) {
-    for (const auto& shape : scene.shapes())
-        shape->draw();
+    if (scene.shapes().empty())
+        return;
+
+    // Sized for every shape so the storage isn't reallocated as visibility changes
+    reserveInstances(scene.shapes().size());
+
+    _instanceBuffer->wait();
+    _instanceBuffer->rebind();
+
+    std::span instances{_instanceBuffer->getBind<InstanceData>(INSTANCE_BUFFER),
+                        _instanceCapacity};
+    std::span materials{_instanceBuffer->getBind<MaterialData>(MATERIAL_BUFFER),
+                        _instanceCapacity};
+    _queue.submit(instances, materials);
+
+    _instanceBuffer->lockAndSwap();
 }
 
 void Renderer::drawSkybox(const Scene& scene) const {
@@ -90,30 +192,68 @@ void Renderer::prepare() {
     // put them all in a single contiguous buffer
     auto rdSize = RHI.alignUniformBuffer(sizeof(RendererData));
     auto cdSize = RHI.alignUniformBuffer(sizeof(CameraData));
-    auto ldSize = RHI.alignUniformBuffer(sizeof(LightData) * NumLights);
+    auto clSize = RHI.alignUniformBuffer(sizeof(ClusterData));
 
     auto cdOffset = rdSize;
-    auto ldOffset = cdOffset + cdSize;
+    auto clOffset = cdOffset + cdSize;
 
-    auto uboSize = RHI.alignUniformBuffer(rdSize + cdSize + ldSize);
+    auto uboSize = RHI.alignUniformBuffer(rdSize + cdSize + clSize);
     _uniformBuffer.create(BufferType::Uniform, 3, uboSize, Write | Persistent | Coherent);
 
     _uniformBuffer.registerBind(RENDERER_BUFFER, 0, rdSize);
     _uniformBuffer.registerBind(CAMERA_BUFFER, cdOffset, cdSize);
-    _uniformBuffer.registerBind(LIGHTS_BUFFER, ldOffset, ldSize);
+    _uniformBuffer.registerBind(CLUSTER_BUFFER, clOffset, clSize);
 }
 
 void Renderer::render(const Scene& scene, const Camera& camera) {
-    _uniformBuffer.wait();
-    _uniformBuffer.rebind();
+    {
+        // Variants are picked, and compiled on first use, here as it needs the context
+        ProfileScope scope{"Materials"};
+
+        auto& programs = RHI.pbrPrograms();
+        programs.setGlobalFeatures(
+            LightFeatures(scene.lights()),
+            ToUnderlying(PBRFeature::SpotLights | PBRFeature::AreaLights));
+
+        for (const auto& shape : scene.shapes())
+            shape->material()->prepare();
+    }
+
+    // Lights are binned while the shapes are culled and sorted
+    std::span<const std::uint32_t> visible;
+
+    {
+        ProfileScope scope{"Cull and sort"};
+
+        TaskGraph frame;
+        frame.add([&] { _clusters.build(scene.lights(), camera); });
+        const auto cull = frame.add([&] { visible = _culler.cull(scene, camera); });
+        frame.add([&] { _queue.build(scene.shapes(), visible, camera); }, {cull});
+        frame.run();
+    }
+
+    {
+        ProfileScope scope{"Uniform upload"};
+
+        _uniformBuffer.wait();
+        _uniformBuffer.rebind();
+
+        uploadUniformBuffer(camera);
+        uploadLights();
+    }
 
-    uploadUniformBuffer(scene, camera);
+    {
+        ProfileScope scope{"Shapes"};
 
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    drawShapes(scene);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawShapes(scene);
+    }
 
-    if (_drawSkybox)
+    if (_drawSkybox) {
+        ProfileScope scope{"Skybox"};
         drawSkybox(scene);
+    }
 
     _uniformBuffer.lockAndSwap();
+    _lightBuffer->lockAndSwap();
 }
@@ -7,6 +7,9 @@
 #include <Camera.h>
 #include <Light.h>
 #include <RingBuffer.h>
+#include <RenderQueue.h>
+#include <FrustumCuller.h>
+#include <LightClusters.h>
 
 namespace pbr {
 
@@ -15,7 +18,16 @@ class Scene;
 enum BufferIndices : int {
     RENDERER_BUFFER = 0,
     CAMERA_BUFFER = 1,
-    LIGHTS_BUFFER = 2
+    CLUSTER_BUFFER = 2,
+    INSTANCE_BUFFER = 3,
+    MATERIAL_BUFFER = 4,
+    LIGHT_BUFFER = 5,
+    CLUSTER_GRID_BUFFER = 6,
+    LIGHT_INDEX_BUFFER = 7,
+    MESHLET_BUFFER = 8,
+    DRAW_COMMAND_BUFFER = 9,
+    DRAW_COUNT_BUFFER = 10,
+    VISIBILITY_BUFFER = 11
 };
 
 enum class ToneMap : int { Parametric = 0, Aces = 1, BoostedAces = 2, FastAces = 3 };
@@ -51,9 +63,24 @@ public:
     void setSkyboxDraw(bool state);
     void setEnvIntensity(float val) { _envIntensity = val; }
 
+    float lodError() const { return _queue.lodError(); }
+    void setLodError(float pixels) { _queue.setLodError(pixels); }
+
+    bool meshletCulling() const { return _queue.meshletCulling(); }
+    void setMeshletCulling(bool state) { _queue.setMeshletCulling(state); }
+
+    bool occlusionCulling() const { return _queue.occlusionCulling(); }
+    void setOcclusionCulling(bool state) { _queue.setOcclusionCulling(state); }
+
+    const DrawStats& drawStats() const { return _queue.stats(); }
+    const CullStats& cullStats() const { return _culler.stats(); }
+
 private:
     void bindBufferRanges();
-    void uploadUniformBuffer(const Scene& scene, const Camera& camera);
+    void uploadUniformBuffer(const Camera& camera);
+    void reserveInstances(std::size_t count);
+    void reserveLights(std::size_t numLights, std::size_t numIndices);
+    void uploadLights();
 
     void drawShapes(const Scene& scene);
     void drawSkybox(const Scene& scene) const;
@@ -67,6 +94,18 @@ private:
     float _envIntensity = 1.0f;
 
     RingBuffer _uniformBuffer{};
+    FrustumCuller _culler;
+    RenderQueue _queue;
+
+    // Per-instance transforms and material parameters, grown on demand
+    std::unique_ptr<RingBuffer> _instanceBuffer = nullptr;
+    std::size_t _instanceCapacity = 0;
+
+    // Visible lights and their per cluster lists, grown on demand
+    LightClusters _clusters;
+    std::unique_ptr<RingBuffer> _lightBuffer = nullptr;
+    std::size_t _lightCapacity = 0;
+    std::size_t _indexCapacity = 0;
 };
 
 } // namespace pbr
@@ -24,10 +24,11 @@ public:
 
     template<typename T>
     T* getBind(unsigned int idx) const {
-        DCHECK_LT(idx, binds.size());
+        auto it = std::find_if(binds.begin(), binds.end(),
+                               [idx](const BufferBind& b) { return b.bindIdx == idx; });
+        DCHECK(it != binds.end());
 
-        std::size_t offset = binds[idx].offset;
-        return Buffer::get<T>(currIdx * baseSize + offset);
+        return Buffer::get<T>(currIdx * baseSize + it->offset);
     }
 
     void lock();
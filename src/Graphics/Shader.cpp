@@ -1,7 +1,10 @@
 #include <Shader.h>
 
 #include <glad/glad.h>
+#include <ProgramCache.h>
 #include <Utils.h>
+
+#include <chrono>
 #include <regex>
 
 using namespace pbr;
@@ -123,6 +126,7 @@ void Program::link() {
     for (GLuint sid : sourceHandles)
         glAttachShader(handle, sid);
 
+    glProgramParameteri(handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(handle);
 
     for (GLuint sid : sourceHandles)
@@ -134,6 +138,38 @@ void Program::link() {
         FATAL(GetProgramError(handle));
 }
 
+bool Program::loadBinary(unsigned int format, std::span<const std::byte> binary) {
+    handle = glCreateProgram();
+    if (handle == 0)
+        FATAL("Could not create program {}", name);
+
+    glProgramBinary(handle, format, binary.data(), binary.size());
+
+    // Binaries from another driver version or GPU are rejected here
+    GLint res;
+    glGetProgramiv(handle, GL_LINK_STATUS, &res);
+    if (res != GL_TRUE) {
+        glDeleteProgram(handle);
+        handle = 0;
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<std::byte> Program::binary(unsigned int& format) const {
+    GLint length = 0;
+    glGetProgramiv(handle, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    std::vector<std::byte> data(length);
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(handle, length, &length, &binaryFormat, data.data());
+
+    data.resize(length);
+    format = binaryFormat;
+    return data;
+}
+
 void Program::cleanShaders() {
     for (auto sid : sourceHandles)
         if (glIsShader(sid) == GL_TRUE)
@@ -144,10 +180,18 @@ void Program::setFloat(int loc, float val) const {
     glProgramUniform1f(handle, loc, val);
 }
 
+void Program::setUInt(int loc, unsigned int val) const {
+    glProgramUniform1ui(handle, loc, val);
+}
+
 void Program::setVector3(int loc, const Vec3& val) const {
     glProgramUniform3f(handle, loc, val.x, val.y, val.z);
 }
 
+void Program::setMatrix4(int loc, const Mat4& val) const {
+    glProgramUniformMatrix4fv(handle, loc, 1, GL_FALSE, val.data());
+}
+
 void Program::setSampler(int loc, int val) const {
     glProgramUniform1i(handle, loc, val);
 }
@@ -182,6 +226,8 @@ ShaderSource pbr::LoadShaderFile(const fs::path& filePath) {
         type = Fragment;
     else if (ext == ".vert" || ext == ".vs")
         type = Vertex;
+    else if (ext == ".comp" || ext == ".cs")
+        type = Compute;
     else
         FATAL("Couldn't deduce type for shader: {}", filePath.string());
 
@@ -209,16 +255,36 @@ std::unique_ptr<Program> pbr::CompileAndLinkProgram(const std::string& name,
                                                     std::span<std::string> sourceNames,
                                                     std::span<std::string> definesList) {
 
+    using namespace std::chrono;
+    const auto start = steady_clock::now();
+
     auto program = std::make_unique<Program>(name);
     auto defines = BuildDefinesBlock(definesList);
 
+    std::vector<ShaderSource> sources;
     for (const auto& fname : sourceNames) {
-        ShaderSource s = LoadShaderFile(ShaderFolder / fname);
-        s.compile(defines);
+        auto& s = sources.emplace_back(LoadShaderFile(ShaderFolder / fname));
+        s.include(defines);
+    }
+
+    const auto key = ProgramCacheKey(sources);
+    if (LoadProgramBinary(*program, name, key)) {
+        LOGD("Loaded program {} from cache in {:.1f} ms", name,
+             duration<double, std::milli>(steady_clock::now() - start).count());
+        return program;
+    }
+
+    for (auto& s : sources) {
+        s.compile();
         program->addShader(s);
     }
 
     program->link();
     program->cleanShaders();
+
+    LOGD("Compiled program {} in {:.1f} ms", name,
+         duration<double, std::milli>(steady_clock::now() - start).count());
+
+    WriteProgramBinary(*program, name, key);
     return program;
 }
\ No newline at end of file
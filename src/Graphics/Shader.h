@@ -23,6 +23,10 @@ public:
     unsigned int id() const;
     void compile(const std::string& defines = "");
 
+    // Source with includes expanded, and defines once included
+    const std::string& text() const { return source; }
+    ShaderType shaderType() const { return type; }
+
 private:
     std::string getVersion();
     bool hasVersionDir();
@@ -44,11 +48,17 @@ public:
     void use() const;
     void link();
 
+    // Driver specific program binary, see ProgramCache.h
+    bool loadBinary(unsigned int format, std::span<const std::byte> binary);
+    std::vector<std::byte> binary(unsigned int& format) const;
+
     void addShader(const ShaderSource& src);
     void cleanShaders();
 
     void setFloat(int loc, float val) const;
+    void setUInt(int loc, unsigned int val) const;
     void setVector3(int loc, const math::Vec3& val) const;
+    void setMatrix4(int loc, const math::Mat4& val) const;
     void setSampler(int loc, int val) const;
 
 private:
@@ -0,0 +1,42 @@
+#include <ShaderPermutations.h>
+
+#include <Shader.h>
+
+#include <bit>
+
+using namespace pbr;
+
+ShaderPermutations::ShaderPermutations(std::string name, std::vector<std::string> sources,
+                                       std::vector<std::string> defines, InitFunc init)
+    : _name(std::move(name)), _sources(std::move(sources)), _defines(std::move(defines)),
+      _init(std::move(init)) {
+    CHECK_LE(_defines.size(), 32u);
+}
+
+const sref<Program>& ShaderPermutations::get(std::uint32_t features) {
+    features |= _global;
+
+    auto it = _variants.find(features);
+    if (it != _variants.end())
+        return it->second;
+
+    std::vector<std::string> defines;
+    for (auto bits = features; bits != 0; bits &= bits - 1) {
+        const auto bit = static_cast<std::size_t>(std::countr_zero(bits));
+        CHECK_LT(bit, _defines.size());
+        defines.push_back(_defines[bit]);
+    }
+
+    auto program = CompileAndLinkProgram(std::format("{}_{:x}", _name, features),
+                                         _sources, defines);
+    if (_init)
+        _init(*program, features);
+
+    LOGD("Created {} variant {:#x}, {} in total", _name, features, _variants.size() + 1);
+
+    return _variants.emplace(features, std::move(program)).first->second;
+}
+
+void ShaderPermutations::setGlobalFeatures(std::uint32_t features, std::uint32_t mask) {
+    _global = (_global & ~mask) | (features & mask);
+}
@@ -0,0 +1,46 @@
+#ifndef PBR_SHADERPERMUTATIONS_H
+#define PBR_SHADERPERMUTATIONS_H
+
+#include <PBR.h>
+
+#include <functional>
+
+namespace pbr {
+
+class Program;
+
+// Programs built from the same sources with different sets of defines. A variant is
+// selected by a feature bitmask, bit i enabling defines[i], and is compiled the first
+// time it is requested. Global features are added to every request, for options that
+// apply to the whole scene.
+class ShaderPermutations {
+public:
+    // Called once per compiled variant, with its features
+    using InitFunc = std::function<void(Program&, std::uint32_t)>;
+
+    ShaderPermutations(std::string name, std::vector<std::string> sources,
+                       std::vector<std::string> defines, InitFunc init = {});
+
+    // Compiles missing variants, so only on the thread owning the context
+    const sref<Program>& get(std::uint32_t features);
+
+    std::uint32_t globalFeatures() const { return _global; }
+
+    // Only the bits in mask are changed
+    void setGlobalFeatures(std::uint32_t features, std::uint32_t mask = ~0u);
+
+    std::size_t size() const { return _variants.size(); }
+
+private:
+    std::string _name;
+    std::vector<std::string> _sources;
+    std::vector<std::string> _defines;
+    InitFunc _init;
+
+    std::uint32_t _global = 0;
+    std::unordered_map<std::uint32_t, sref<Program>> _variants;
+};
+
+} // namespace pbr
+
+#endif
@@ -0,0 +1,42 @@
+#include <StagingBuffer.h>
+
+using namespace pbr;
+
+namespace {
+// Keeps offsets valid for any pixel type
+constexpr std::size_t RangeAlignment = 16;
+} // namespace
+
+void StagingBuffer::create(std::size_t pSize) {
+    using enum BufferFlag;
+
+    ringSize = pSize;
+    head = 0;
+    Buffer::create(BufferType::PixelUnpack, ringSize, Write | Persistent | Coherent,
+                   nullptr);
+}
+
+StagingRange StagingBuffer::allocate(std::size_t allocSize) {
+    CHECK_LE(allocSize, ringSize);
+
+    std::size_t start = (head + RangeAlignment - 1) & ~(RangeAlignment - 1);
+    if (start + allocSize > ringSize)
+        start = 0;
+
+    waitRange(start, allocSize);
+    head = start + allocSize;
+
+    return {Buffer::get<std::byte>(start), start, allocSize};
+}
+
+void StagingBuffer::submit(const StagingRange& range) {
+    lockRange(range.offset, range.size);
+}
+
+void StagingBuffer::bind() const {
+    glBindBuffer(target, handle);
+}
+
+void StagingBuffer::unbind() const {
+    glBindBuffer(target, 0);
+}
@@ -0,0 +1,38 @@
+#ifndef PBR_STAGINGBUFFER_H
+#define PBR_STAGINGBUFFER_H
+
+#include <Buffer.h>
+
+namespace pbr {
+
+struct StagingRange {
+    std::byte* ptr = nullptr;
+    std::size_t offset = 0; // Offset to pass as the pixel pointer while bound
+    std::size_t size = 0;
+};
+
+// Persistently mapped pixel unpack buffer used as a ring for texture uploads. Ranges are
+// fenced once their copies are issued and only reused after the GPU has consumed them.
+class StagingBuffer : private SyncedBuffer {
+public:
+    void create(std::size_t bufferSize);
+
+    std::size_t capacity() const { return ringSize; }
+
+    // Blocks while the range is still in use by previous uploads
+    StagingRange allocate(std::size_t allocSize);
+
+    // Fences the range after the commands reading from it were issued
+    void submit(const StagingRange& range);
+
+    void bind() const;
+    void unbind() const;
+
+private:
+    std::size_t ringSize = 0;
+    std::size_t head = 0;
+};
+
+} // namespace pbr
+
+#endif
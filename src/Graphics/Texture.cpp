@@ -2,6 +2,8 @@
 
 #include <glad/glad.h>
 
+#include <RenderInterface.h>
+
 #include <map>
 
 using namespace pbr;
@@ -16,20 +18,29 @@ struct pbr::FormatInfo {
 
 namespace {
 
+// From EXT_texture_compression_s3tc, supported everywhere but not core
+constexpr GLuint CompressedRgbDxt1 = 0x83F0;
+
+// Block compressed formats have no pixel format or type to upload with
 using enum PixelFormat;
 const std::map<std::tuple<PixelFormat, int>, FormatInfo> TexFormatMap{
-    {{U8, 1},  {1, U8, GL_R8, GL_RED, GL_UNSIGNED_BYTE}    },
-    {{U8, 2},  {2, U8, GL_RG8, GL_RG, GL_UNSIGNED_BYTE}    },
-    {{U8, 3},  {3, U8, GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE}  },
-    {{U8, 4},  {4, U8, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE}},
-    {{F16, 1}, {1, F16, GL_R16F, GL_RED, GL_HALF_FLOAT}    },
-    {{F16, 2}, {2, F16, GL_RG16F, GL_RG, GL_HALF_FLOAT}    },
-    {{F16, 3}, {3, F16, GL_RGB16F, GL_RGB, GL_HALF_FLOAT}  },
-    {{F16, 4}, {4, F16, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT}},
-    {{F32, 1}, {1, F32, GL_R32F, GL_RED, GL_FLOAT}         },
-    {{F32, 2}, {2, F32, GL_RG32F, GL_RG, GL_FLOAT}         },
-    {{F32, 3}, {3, F32, GL_RGB32F, GL_RGB, GL_FLOAT}       },
-    {{F32, 4}, {4, F32, GL_RGBA32F, GL_RGBA, GL_FLOAT}     },
+    {{U8, 1},   {1, U8, GL_R8, GL_RED, GL_UNSIGNED_BYTE}              },
+    {{U8, 2},   {2, U8, GL_RG8, GL_RG, GL_UNSIGNED_BYTE}              },
+    {{U8, 3},   {3, U8, GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE}            },
+    {{U8, 4},   {4, U8, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE}          },
+    {{F16, 1},  {1, F16, GL_R16F, GL_RED, GL_HALF_FLOAT}              },
+    {{F16, 2},  {2, F16, GL_RG16F, GL_RG, GL_HALF_FLOAT}              },
+    {{F16, 3},  {3, F16, GL_RGB16F, GL_RGB, GL_HALF_FLOAT}            },
+    {{F16, 4},  {4, F16, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT}          },
+    {{F32, 1},  {1, F32, GL_R32F, GL_RED, GL_FLOAT}                   },
+    {{F32, 2},  {2, F32, GL_RG32F, GL_RG, GL_FLOAT}                   },
+    {{F32, 3},  {3, F32, GL_RGB32F, GL_RGB, GL_FLOAT}                 },
+    {{F32, 4},  {4, F32, GL_RGBA32F, GL_RGBA, GL_FLOAT}               },
+    {{BC1, 3},  {3, BC1, CompressedRgbDxt1, 0, 0}                     },
+    {{BC4, 1},  {1, BC4, GL_COMPRESSED_RED_RGTC1, 0, 0}               },
+    {{BC5, 2},  {2, BC5, GL_COMPRESSED_RG_RGTC2, 0, 0}                },
+    {{BC6H, 3}, {3, BC6H, GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 0, 0}},
+    {{BC7, 4},  {4, BC7, GL_COMPRESSED_RGBA_BPTC_UNORM, 0, 0}         },
 };
 
 const std::unordered_map<Wrap, GLenum> OglTexWrap{
@@ -135,7 +146,10 @@ void Texture::setSampler(TexSampler sampler) const {
 std::unique_ptr<std::byte[]> Texture::data(int level) const {
     auto size = sizeBytes(level);
     auto dataPtr = std::make_unique<std::byte[]>(size);
-    glGetTextureImage(handle, level, info->format, info->type, size, dataPtr.get());
+    if (IsCompressed(info->pxFmt))
+        glGetCompressedTextureImage(handle, level, size, dataPtr.get());
+    else
+        glGetTextureImage(handle, level, info->format, info->type, size, dataPtr.get());
     return dataPtr;
 }
 
@@ -143,6 +157,12 @@ std::unique_ptr<std::byte[]> Texture::data(int face, int level) const {
     auto size = sizeBytesFace(level);
     auto dataPtr = std::make_unique<std::byte[]>(size);
 
+    if (IsCompressed(info->pxFmt)) {
+        glGetCompressedTextureSubImage(handle, level, 0, 0, face, ResizeLvl(width, level),
+                                       ResizeLvl(height, level), 1, size, dataPtr.get());
+        return dataPtr;
+    }
+
     auto oglTarget = OglTargets.at(target);
     glBindTexture(oglTarget, handle);
     glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, info->format, info->type,
@@ -152,20 +172,63 @@ std::unique_ptr<std::byte[]> Texture::data(int face, int level) const {
     return dataPtr;
 }
 
+// Level pixels are copied to the staging ring in row bands, so a few of them fit at once.
+// Bands of compressed levels are whole rows of blocks.
+void Texture::uploadRows(const std::byte* pixels, int lvl, int face, int firstRow,
+                         int numRows) const {
+    auto& staging = RHI.stagingBuffer();
+
+    const int w = ResizeLvl(width, lvl);
+    const int bandRows = RowsPerBand(info->pxFmt);
+    const std::size_t bandSize = ImageSize({info->pxFmt, w, bandRows, info->numChannels});
+    DCHECK(firstRow % bandRows == 0);
+
+    const int numBands = (numRows + bandRows - 1) / bandRows;
+    const auto maxRows = bandRows * static_cast<int>(std::clamp<std::size_t>(
+                                        staging.capacity() / 4 / bandSize, 1, numBands));
+
+    staging.bind();
+
+    const int endRow = firstRow + numRows;
+    for (int y = firstRow; y < endRow; y += maxRows) {
+        const int rows = std::min(maxRows, endRow - y);
+
+        auto range = staging.allocate((rows + bandRows - 1) / bandRows * bandSize);
+        std::memcpy(range.ptr, pixels + y / bandRows * bandSize, range.size);
+
+        const auto* offset = reinterpret_cast<const void*>(range.offset);
+        const auto size = static_cast<GLsizei>(range.size);
+        if (IsCompressed(info->pxFmt) && target == Type::Cube)
+            glCompressedTextureSubImage3D(handle, lvl, 0, y, face, w, rows, 1,
+                                          info->intFormat, size, offset);
+        else if (IsCompressed(info->pxFmt))
+            glCompressedTextureSubImage2D(handle, lvl, 0, y, w, rows, info->intFormat,
+                                          size, offset);
+        else if (target == Type::Cube)
+            glTextureSubImage3D(handle, lvl, 0, y, face, w, rows, 1, info->format,
+                                info->type, offset);
+        else
+            glTextureSubImage2D(handle, lvl, 0, y, w, rows, info->format, info->type,
+                                offset);
+
+        staging.submit(range);
+    }
+
+    staging.unbind();
+}
+
 void Texture::upload(const Image& image, int lvl) const {
-    auto imgFmt = image.format(lvl);
-    glTextureSubImage2D(handle, lvl, 0, 0, imgFmt.width, imgFmt.height, info->format,
-                        info->type, image.data());
+    upload(image, lvl, 0, image.format(lvl).height);
+}
+
+void Texture::upload(const Image& image, int lvl, int firstRow, int numRows) const {
+    uploadRows(image.data(lvl), lvl, 0, firstRow, numRows);
 }
 
 void Texture::upload(const CubeImage& cubemap) const {
-    for (int lvl = 0; lvl < cubemap.numLevels(); ++lvl) {
-        for (int face = 0; face < 6; ++face) {
-            glTextureSubImage3D(handle, lvl, 0, 0, face, ResizeLvl(width, lvl),
-                                ResizeLvl(height, lvl), 1, info->format, info->type,
-                                cubemap[face].data(lvl));
-        }
-    }
+    for (int lvl = 0; lvl < cubemap.numLevels(); ++lvl)
+        for (int face = 0; face < 6; ++face)
+            uploadRows(cubemap[face].data(lvl), lvl, face, 0, ResizeLvl(height, lvl));
 }
 
 std::unique_ptr<Image> Texture::image(int level) const {
@@ -194,9 +257,7 @@ std::size_t Texture::sizeBytes(unsigned int level) const {
 }
 
 std::size_t Texture::sizeBytesFace(unsigned int level) const {
-    int w = ResizeLvl(width, level);
-    int h = ResizeLvl(height, level);
-    return ComponentSize(info->pxFmt) * info->numChannels * w * h;
+    return ImageSize(format(level));
 }
 
 ImageFormat Texture::format(int lvl) const {
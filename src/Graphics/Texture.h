@@ -45,6 +45,9 @@ public:
     void upload(const Image& image, int lvl = 0) const;
     void upload(const CubeImage& cubemap) const;
 
+    // Uploads numRows rows of a level, starting at firstRow
+    void upload(const Image& image, int lvl, int firstRow, int numRows) const;
+
     ImageFormat format(int level = 0) const;
 
     std::unique_ptr<Image> image(int level = 0) const;
@@ -56,6 +59,8 @@ public:
 
 private:
     void init(ImageFormat format);
+    void uploadRows(const std::byte* pixels, int lvl, int face, int firstRow,
+                    int numRows) const;
 
     std::size_t sizeBytes(unsigned int level = 0) const;
     std::size_t sizeBytesFace(unsigned int level = 0) const;
@@ -0,0 +1,160 @@
+#include <TextureStreamer.h>
+
+#include <Resources.h>
+#include <Texture.h>
+#include <TextureCache.h>
+#include <Utils.h>
+
+#include <glad/glad.h>
+
+using namespace pbr;
+using namespace std::chrono;
+
+// The job system is created first so it outlives the streamer
+TextureStreamer::TextureStreamer() {
+    JobSystem::get();
+}
+
+// Decodes that haven't started yet are skipped
+TextureStreamer::~TextureStreamer() {
+    cancelled = true;
+    JobSystem::get().wait(decodeJobs, JobPriority::Background);
+}
+
+namespace {
+
+// The same file can be streamed with different mip encodings
+std::string StreamedName(const fs::path& path, MipEncoding encoding) {
+    if (encoding == MipEncoding::Linear)
+        return path.string();
+
+    const char* suffix = encoding == MipEncoding::SRGB ? "srgb" : "normal";
+    return std::format("{}#{}", path.string(), suffix);
+}
+
+} // namespace
+
+void TextureStreamer::request(const fs::path& path, MipEncoding encoding,
+                              ReadyFunc onReady) {
+    auto name = StreamedName(path, encoding);
+
+    if (auto tex = Resource.get<Texture>(name)) {
+        onReady(tex->id());
+        return;
+    }
+
+    if (!fs::exists(path)) {
+        LOG_ERROR("Couldn't find texture {}. Assigning 'unset' texture.", name);
+        onReady(Resource.get<Texture>("null")->id());
+        return;
+    }
+
+    // Already in flight
+    auto [it, added] = waiting.try_emplace(name);
+    it->second.push_back(std::move(onReady));
+    if (!added)
+        return;
+
+    if (numStreamed == 0 && waiting.size() == 1)
+        streamStart = steady_clock::now();
+
+    MipOptions options;
+    options.filter = filter;
+    options.encoding = encoding;
+
+    JobSystem::get().submit(
+        [this, name = std::move(name), path, options]() mutable {
+            decode(std::move(name), std::move(path), options);
+        },
+        &decodeJobs, JobPriority::Background);
+}
+
+void TextureStreamer::decode(std::string name, fs::path path, MipOptions options) {
+    if (cancelled)
+        return;
+
+    auto image = LoadMippedImage(path, options);
+
+    std::scoped_lock lock{mutex};
+    decoded.push_back({std::move(name), std::move(image)});
+}
+
+void TextureStreamer::update() {
+    if (waiting.empty())
+        return;
+
+    std::size_t uploaded = 0;
+    while (uploaded < budget) {
+        if (!current) {
+            std::unique_lock lock{mutex};
+            if (decoded.empty())
+                break;
+
+            auto [name, image] = std::move(decoded.front());
+            decoded.pop_front();
+            lock.unlock();
+
+            const auto fmt = image->format();
+            auto texture =
+                std::make_shared<Texture>(Texture::Type::Tex2D, fmt, image->numLevels());
+            if (image->numLevels() > 1) {
+                TexSampler sampler;
+                sampler.min = Filter::LinearMipLinear;
+                texture->setSampler(sampler);
+            }
+            current = Upload{std::move(name), std::move(image), std::move(texture)};
+        }
+
+        // Whole bands of rows, one row or one row of blocks, but never less than one
+        const auto fmt = current->image->format(current->level);
+        const int bandRows = RowsPerBand(fmt.pFmt);
+        const std::size_t bandSize =
+            ImageSize({fmt.pFmt, fmt.width, bandRows, fmt.nChannels});
+        const int bandsLeft = (fmt.height - current->row + bandRows - 1) / bandRows;
+        const auto bands = static_cast<int>(
+            std::clamp<std::size_t>((budget - uploaded) / bandSize, 1, bandsLeft));
+        const int rows = std::min(bands * bandRows, fmt.height - current->row);
+
+        current->texture->upload(*current->image, current->level, current->row, rows);
+        uploaded += bands * bandSize;
+
+        current->row += rows;
+        if (current->row < fmt.height)
+            continue;
+
+        current->row = 0;
+        if (++current->level < current->image->numLevels())
+            continue;
+
+        Resource.add(current->name, current->texture);
+        resolve(current->name, current->texture->id());
+        current.reset();
+    }
+}
+
+void TextureStreamer::resolve(const std::string& name, RRID texture) {
+    auto it = waiting.find(name);
+    for (auto& onReady : it->second)
+        onReady(texture);
+    waiting.erase(it);
+
+    ++numStreamed;
+    if (waiting.empty()) {
+        const auto secs = duration<double>(steady_clock::now() - streamStart).count();
+        LOGI("Streamed {} textures in {:.2f} s", numStreamed, secs);
+        numStreamed = 0;
+    }
+}
+
+void TextureStreamer::finish() {
+    const auto prevBudget = budget;
+    budget = std::numeric_limits<std::size_t>::max();
+
+    while (!idle()) {
+        update();
+        if (!idle())
+            JobSystem::get().wait(decodeJobs, JobPriority::Background);
+    }
+
+    budget = prevBudget;
+}
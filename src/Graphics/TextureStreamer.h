@@ -0,0 +1,97 @@
+#ifndef PBR_TEXTURESTREAMER_H
+#define PBR_TEXTURESTREAMER_H
+
+#include <PBR.h>
+#include <Image.h>
+#include <JobSystem.h>
+#include <MipChain.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+
+namespace fs = std::filesystem;
+
+namespace pbr {
+
+class Texture;
+
+// Loads textures in the background. Images are decoded by jobs, along with their mip
+// chain or its cache, and uploaded from the main thread by update(), through the staging
+// ring and at most uploadBudget bytes per call, so big scenes render right away with
+// placeholder textures.
+class TextureStreamer {
+public:
+    using ReadyFunc = std::function<void(RRID)>;
+
+    static TextureStreamer& get() {
+        static TextureStreamer _inst;
+        return _inst;
+    }
+
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // onReady is called from update() once the texture is resident, or right away if it
+    // already is. Missing files resolve to the 'null' texture. The encoding says how
+    // the mips of the texture are filtered.
+    void request(const fs::path& path, MipEncoding encoding, ReadyFunc onReady);
+
+    // Uploads decoded images, called once per frame on the thread owning the context
+    void update();
+
+    // Blocks until every requested texture is resident
+    void finish();
+
+    bool idle() const { return waiting.empty(); }
+
+    std::size_t uploadBudget() const { return budget; }
+    void setUploadBudget(std::size_t bytes) { budget = std::max<std::size_t>(bytes, 1); }
+
+    MipFilter mipFilter() const { return filter; }
+    void setMipFilter(MipFilter mipFilter) { filter = mipFilter; }
+
+private:
+    struct Decoded {
+        std::string name;
+        std::unique_ptr<Image> image;
+    };
+
+    struct Upload {
+        std::string name;
+        std::unique_ptr<Image> image;
+        sref<Texture> texture;
+        int level = 0;
+        int row = 0;
+    };
+
+    TextureStreamer();
+
+    void decode(std::string name, fs::path path, MipOptions options);
+    void resolve(const std::string& name, RRID texture);
+
+    // Shared with the decode jobs
+    std::mutex mutex;
+    std::deque<Decoded> decoded;
+
+    JobCounter decodeJobs;
+    std::atomic<bool> cancelled = false;
+
+    // Main thread only
+    std::unordered_map<std::string, std::vector<ReadyFunc>> waiting;
+    std::optional<Upload> current = std::nullopt;
+    std::size_t budget = 32 * 1024 * 1024;
+    MipFilter filter = MipFilter::Kaiser;
+
+    std::size_t numStreamed = 0;
+    std::chrono::steady_clock::time_point streamStart;
+};
+
+} // namespace pbr
+
+#endif
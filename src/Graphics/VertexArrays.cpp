@@ -7,7 +7,8 @@
 using namespace pbr;
 
 namespace {
-const std::array OglAttribType{GL_BYTE, GL_SHORT, GL_UNSIGNED_INT, GL_FLOAT};
+const std::array OglAttribType{GL_BYTE,  GL_SHORT,          GL_UNSIGNED_INT,
+                               GL_FLOAT, GL_UNSIGNED_SHORT, GL_HALF_FLOAT};
 
 auto ToOglType(AttribType type) {
     return OglAttribType[static_cast<int>(type)];
@@ -54,7 +55,8 @@ void VertexArrays::addVertexBuffer(Buffer&& buffer, std::span<BufferLayoutEntry>
         glEnableVertexArrayAttrib(handle, entry.index);
         glVertexArrayAttribBinding(handle, entry.index, bindIndex);
         glVertexArrayAttribFormat(handle, entry.index, entry.numElems,
-                                  ToOglType(entry.type), GL_FALSE, entry.offset);
+                                  ToOglType(entry.type), entry.normalized,
+                                  entry.offset);
     }
 }
 
@@ -66,11 +68,40 @@ void VertexArrays::addElementBuffer(Buffer&& buffer, unsigned int numIndices,
 }
 
 void VertexArrays::draw() const {
+    bind();
+    submit();
+    glBindVertexArray(0);
+}
+
+void VertexArrays::bind() const {
     glBindVertexArray(handle);
+}
+
+void VertexArrays::submit(unsigned int numInstances, unsigned int baseInstance) const {
     if (elementBuffer.handle != 0)
-        glDrawElements(GL_TRIANGLES, elementBuffer.numIndices,
-                       ToOglType(elementBuffer.type), 0);
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, elementBuffer.numIndices,
+                                            ToOglType(elementBuffer.type), 0,
+                                            numInstances, baseInstance);
     else
-        glDrawArrays(GL_TRIANGLES, 0, numVerts);
-    glBindVertexArray(0);
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, numVerts, numInstances,
+                                          baseInstance);
+}
+
+void VertexArrays::submit(unsigned int firstIndex, unsigned int numIndices,
+                          unsigned int numInstances, unsigned int baseInstance) const {
+    const std::size_t indexSize = elementBuffer.type == AttribType::UInt
+                                      ? sizeof(unsigned int)
+                                      : sizeof(unsigned short);
+
+    glDrawElementsInstancedBaseInstance(
+        GL_TRIANGLES, numIndices, ToOglType(elementBuffer.type),
+        reinterpret_cast<const void*>(firstIndex * indexSize), numInstances, baseInstance);
+}
+
+void VertexArrays::submitIndirect(std::size_t commandOffset, std::size_t countOffset,
+                                  unsigned int maxDraws) const {
+    DCHECK(elementBuffer.handle != 0);
+    glMultiDrawElementsIndirectCount(GL_TRIANGLES, ToOglType(elementBuffer.type),
+                                     reinterpret_cast<const void*>(commandOffset),
+                                     static_cast<GLintptr>(countOffset), maxDraws, 0);
 }
\ No newline at end of file
@@ -6,7 +6,14 @@
 
 namespace pbr {
 
-enum class AttribType : int { Byte = 0, Short = 1, UInt = 2, Float = 3 };
+enum class AttribType : int {
+    Byte = 0,
+    Short = 1,
+    UInt = 2,
+    Float = 3,
+    UShort = 4,
+    Half = 5
+};
 consteval bool EnableConversion(AttribType);
 
 struct BufferLayoutEntry {
@@ -15,6 +22,7 @@ struct BufferLayoutEntry {
     AttribType type = AttribType::Float;
     std::size_t stride = 0;
     std::size_t offset = 0;
+    bool normalized = false; // Integers read as [0, 1], or [-1, 1] if signed
 };
 
 struct VertexBufferEntry {
@@ -52,6 +60,20 @@ public:
 
     void draw() const;
 
+    // Lets callers that draw the same arrays back to back skip redundant binds.
+    // submit() assumes the arrays are already bound.
+    void bind() const;
+    void submit(unsigned int numInstances = 1, unsigned int baseInstance = 0) const;
+
+    // Draws numIndices elements starting at firstIndex, e.g. one level of detail
+    void submit(unsigned int firstIndex, unsigned int numIndices, unsigned int numInstances,
+                unsigned int baseInstance) const;
+
+    // Draws up to maxDraws DrawElementsIndirectCommands from the bound indirect buffer at
+    // commandOffset, as many as the bound parameter buffer holds at countOffset
+    void submitIndirect(std::size_t commandOffset, std::size_t countOffset,
+                        unsigned int maxDraws) const;
+
 public:
     unsigned int handle = 0;
     ElementBuffer elementBuffer = {};
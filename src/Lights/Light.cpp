@@ -29,8 +29,12 @@ std::unique_ptr<Light> pbr::CreateLight(const ParameterMap& params) {
     auto pos = params.lookup("position", Vec3{0.0});
     auto toWorld = params.lookup("toWorld", math::Translation(pos));
 
+    // Area lights
+    auto radius = params.lookup("radius", 0.2f);
+
+    std::unique_ptr<Light> light = nullptr;
     if (type == "point") {
-        return std::make_unique<PointLight>(emission, intensity, toWorld);
+        light = std::make_unique<PointLight>(emission, intensity, toWorld);
     } else if (type == "directional") {
         auto dir = params.lookup<Vec3>("dir");
         if (dir.has_value())
@@ -39,16 +43,17 @@ std::unique_ptr<Light> pbr::CreateLight(const ParameterMap& params) {
     } else if (type == "spot") {
         auto cutoff = Radians(params.lookup("cutoff", 36.5f));
         auto outerCutoff = Radians(params.lookup("outerCutoff", 40.0f));
-        return std::make_unique<SpotLight>(emission, intensity, pos, cutoff, outerCutoff);
-    }
-
-    // Area lights
-    auto radius = params.lookup("radius", 0.2f);
-    if (type == "sphere") {
-        return std::make_unique<SphereLight>(emission, intensity, toWorld, radius);
+        light =
+            std::make_unique<SpotLight>(emission, intensity, pos, cutoff, outerCutoff);
+    } else if (type == "sphere") {
+        light = std::make_unique<SphereLight>(emission, intensity, toWorld, radius);
     } else if (type == "tube") {
-        return std::make_unique<TubeLight>(emission, intensity, toWorld, radius);
+        light = std::make_unique<TubeLight>(emission, intensity, toWorld, radius);
+    } else {
+        FATAL("Unknwon light type '{}'.", type);
     }
 
-    FATAL("Unknwon light type '{}'.", type);
-}
\ No newline at end of file
+    light->setRange(params.lookup("range", light->range()));
+
+    return light;
+}
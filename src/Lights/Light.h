@@ -17,8 +17,8 @@ enum class LightType : int {
 
 consteval bool EnableConversion(LightType);
 
-// Light data for shader blocks
-// CARE: data is properly aligned to std140, do not change
+// Light data for shader storage blocks
+// CARE: data is properly aligned to std430, do not change
 struct LightData {
     alignas(16) Vec3 position;
     float auxA;
@@ -26,6 +26,7 @@ struct LightData {
     int type;
     alignas(16) Vec3 auxB;
     float auxC;
+    alignas(16) float range;
 };
 
 class Light : public SceneObject {
@@ -45,12 +46,17 @@ public:
     Color emission() const { return _emission; }
     void setEmission(const Color& emission) { _emission = emission; }
 
+    // Distance at which the light's contribution falls to zero
+    float range() const { return _range; }
+    void setRange(float range) { _range = range; }
+
     virtual LightType type() const = 0;
     virtual void toData(LightData& data) const = 0;
 
 protected:
     Color _emission{1.0f}; // Normalized emission
     float _intensity = 1.0f;
+    float _range = 100.0f;
     bool _on = true;
 };
 
@@ -18,4 +18,5 @@ void PointLight::toData(LightData& data) const {
     data.type = _on ? ToUnderlying(Point) : ToUnderlying(None);
     data.emission = _intensity * _emission;
     data.position = position();
+    data.range = _range;
 }
\ No newline at end of file
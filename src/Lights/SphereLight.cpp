@@ -17,4 +17,5 @@ void SphereLight::toData(LightData& data) const {
     data.emission = _intensity * _emission;
     data.position = position();
     data.auxA = _radius;
+    data.range = _range;
 }
\ No newline at end of file
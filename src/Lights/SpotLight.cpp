@@ -38,4 +38,5 @@ void SpotLight::toData(LightData& data) const {
     data.auxA = std::cos(_cutoff);
     data.auxC = std::cos(_outerCutoff);
     data.auxB = direction();
+    data.range = _range;
 }
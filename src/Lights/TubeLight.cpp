@@ -24,4 +24,5 @@ void TubeLight::toData(LightData& data) const {
     data.position = objToWorld() * EndPointA;
     data.auxB = objToWorld() * EndPointB;
     data.auxA = _radius;
+    data.range = _range;
 }
\ No newline at end of file
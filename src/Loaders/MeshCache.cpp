@@ -0,0 +1,260 @@
+#include <MeshCache.h>
+
+#include <Geometry.h>
+#include <JobSystem.h>
+#include <MappedFile.h>
+#include <ObjLoader.h>
+#include <SourceKey.h>
+#include <Utils.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+using namespace pbr;
+using namespace pbr::util;
+
+namespace {
+
+constexpr std::array<char, 8> Magic{'P', 'B', 'R', 'M', 'E', 'S', 'H', '\0'};
+constexpr std::uint32_t Version = 4;
+
+struct MeshCacheHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t vertexSize;
+
+    // Source key
+    std::uint64_t pathHash;
+    std::int64_t sourceTime;
+    std::uint64_t sourceSize;
+    std::uint64_t sourceHash;
+
+    std::uint64_t numVertices;
+    std::uint64_t numIndices; // Of every level of detail
+    std::uint64_t numLods;
+    Vec3 bboxMin;
+    Vec3 bboxMax;
+};
+
+static_assert(std::is_trivially_copyable_v<MeshCacheHeader>);
+static_assert(sizeof(MeshCacheHeader) % alignof(Vertex) == 0);
+
+std::size_t PayloadSize(const MeshCacheHeader& header) {
+    return sizeof(MeshCacheHeader) + header.numVertices * sizeof(Vertex) +
+           header.numIndices * sizeof(unsigned int) + header.numLods * sizeof(MeshLod);
+}
+
+bool IsCompatible(const MeshCacheHeader& header, std::size_t fileSize) {
+    return header.magic == Magic && header.version == Version &&
+           header.vertexSize == sizeof(Vertex) && PayloadSize(header) == fileSize;
+}
+
+bool MatchesKey(const MeshCacheHeader& header, const SourceKey& key) {
+    return header.pathHash == key.pathHash && header.sourceTime == key.time &&
+           header.sourceSize == key.size;
+}
+
+void RefreshKey(const fs::path& cachePath, const SourceKey& key) {
+    std::fstream file{cachePath, std::ios::in | std::ios::out | std::ios::binary};
+
+    MeshCacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return;
+
+    header.pathHash = key.pathHash;
+    header.sourceTime = key.time;
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+// Maps the cache of a source if it is still valid for it
+MappedFile OpenCache(const fs::path& sourcePath) {
+    const fs::path cachePath = MeshCachePath(sourcePath);
+    if (!fs::exists(cachePath))
+        return {};
+
+    MappedFile file{cachePath};
+    if (!file.isOpen() || file.size() < sizeof(MeshCacheHeader))
+        return {};
+
+    const auto& header = *file.as<MeshCacheHeader>();
+    if (!IsCompatible(header, file.size())) {
+        LOGW("Discarding incompatible mesh cache {}.", cachePath.string());
+        return {};
+    }
+
+    const auto key = GetSourceKey(sourcePath);
+    if (!key)
+        return {};
+
+    if (!MatchesKey(header, *key)) {
+        // A touched, copied or moved source is still valid if its content is unchanged
+        if (header.sourceSize != key->size || header.sourceHash != HashFile(sourcePath))
+            return {};
+
+        // Release the mapping before the header is rewritten in place
+        file = MappedFile{};
+        RefreshKey(cachePath, *key);
+        file = MappedFile{cachePath};
+    }
+
+    return file;
+}
+
+} // namespace
+
+fs::path pbr::MeshCachePath(const fs::path& sourcePath) {
+    fs::path cachePath = sourcePath;
+    cachePath += ".pbrmesh";
+    return cachePath;
+}
+
+std::unique_ptr<Geometry> pbr::LoadMeshCache(const fs::path& sourcePath, bool upload) {
+    MappedFile file = OpenCache(sourcePath);
+    if (!file.isOpen())
+        return nullptr;
+
+    const auto& header = *file.as<MeshCacheHeader>();
+    const std::size_t indexOffset =
+        sizeof(MeshCacheHeader) + header.numVertices * sizeof(Vertex);
+
+    const std::size_t lodOffset = indexOffset + header.numIndices * sizeof(unsigned int);
+
+    std::span vertices{file.as<Vertex>(sizeof(MeshCacheHeader)), header.numVertices};
+    std::span indices{file.as<unsigned int>(indexOffset), header.numIndices};
+    std::span lods{file.as<MeshLod>(lodOffset), header.numLods};
+
+    return std::make_unique<Geometry>(vertices, indices, lods,
+                                      BBox3{header.bboxMin, header.bboxMax}, upload);
+}
+
+bool pbr::WriteMeshCache(const fs::path& sourcePath, const Geometry& geometry) {
+    const auto key = GetSourceKey(sourcePath);
+    if (!key)
+        return false;
+
+    const auto& vertices = geometry.vertices();
+    const auto& indices = geometry.indices();
+    const auto lods = geometry.lods();
+
+    MeshCacheHeader header{.magic = Magic,
+                           .version = Version,
+                           .vertexSize = sizeof(Vertex),
+                           .pathHash = key->pathHash,
+                           .sourceTime = key->time,
+                           .sourceSize = key->size,
+                           .sourceHash = HashFile(sourcePath),
+                           .numVertices = vertices.size(),
+                           .numIndices = indices.size(),
+                           .numLods = lods.size(),
+                           .bboxMin = geometry.bbox().min(),
+                           .bboxMax = geometry.bbox().max()};
+
+    // Write to a temporary first so an interrupted write never leaves a truncated cache
+    const fs::path cachePath = MeshCachePath(sourcePath);
+    fs::path tmpPath = cachePath;
+    tmpPath += ".tmp";
+
+    {
+        std::ofstream file{tmpPath, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(vertices.data()),
+                   vertices.size() * sizeof(Vertex));
+        file.write(reinterpret_cast<const char*>(indices.data()),
+                   indices.size() * sizeof(unsigned int));
+        file.write(reinterpret_cast<const char*>(lods.data()),
+                   lods.size() * sizeof(MeshLod));
+
+        if (!file) {
+            LOGW("Failed to write mesh cache {}.", cachePath.string());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmpPath, cachePath, ec);
+    if (ec) {
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+
+    return true;
+}
+
+std::unique_ptr<Geometry> pbr::LoadCachedObj(const fs::path& sourcePath, bool upload) {
+    if (auto geo = LoadMeshCache(sourcePath, upload))
+        return geo;
+
+    auto objFile = LoadObjFile(sourcePath);
+    if (!objFile)
+        return nullptr;
+
+    auto geo = std::make_unique<Geometry>(std::move(objFile->vertices),
+                                          std::move(objFile->indices), false);
+
+    const auto stats = geo->optimize();
+    LOGI("Optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+         sourcePath.string(), stats.before.acmr, stats.after.acmr, stats.before.atvr,
+         stats.after.atvr);
+
+    geo->buildLods();
+    LOGI("Built {} levels of detail for {}", geo->numLods(), sourcePath.string());
+
+    if (!WriteMeshCache(sourcePath, *geo))
+        LOGW("Unable to cache mesh {}.", sourcePath.string());
+
+    if (upload)
+        geo->upload();
+
+    return geo;
+}
+
+std::size_t pbr::BuildMeshCaches(const fs::path& directory) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+
+    std::vector<fs::path> sources;
+    for (const auto& entry : fs::recursive_directory_iterator(directory))
+        if (entry.is_regular_file() && entry.path().extension() == ".obj")
+            sources.push_back(entry.path());
+
+    // One job per file, each parse is itself split across the job system
+    std::atomic<std::size_t> numWritten = 0, numValid = 0;
+    auto& jobs = JobSystem::get();
+    jobs.parallelFor(sources.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const fs::path& path = sources[i];
+            if (OpenCache(path).isOpen()) {
+                ++numValid;
+                continue;
+            }
+
+            auto objFile = LoadObjFile(path);
+            if (!objFile)
+                continue;
+
+            // Tangents, deduplication, reordering and simplification only, nothing is
+            // uploaded
+            Geometry geo{std::move(objFile->vertices), std::move(objFile->indices),
+                         false};
+            const auto stats = geo.optimize();
+            geo.buildLods();
+            if (WriteMeshCache(path, geo)) {
+                Print("Cached {} ({} vertices, {} indices, {} lods, "
+                      "ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f})",
+                      path.string(), geo.vertices().size(), geo.lod(0).numIndices,
+                      geo.numLods(), stats.before.acmr, stats.after.acmr,
+                      stats.before.atvr, stats.after.atvr);
+                ++numWritten;
+            }
+        }
+    });
+
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+    Print("Wrote {} mesh caches, {} already up to date ({:.2f} s)", numWritten.load(),
+          numValid.load(), elapsed.count());
+
+    return numWritten;
+}
@@ -0,0 +1,32 @@
+#ifndef PBR_MESHCACHE_H
+#define PBR_MESHCACHE_H
+
+#include <PBR.h>
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace pbr {
+
+class Geometry;
+
+// Binary .pbrmesh files store a geometry's final deduplicated vertices, indices, levels
+// of detail and bounds next to its source, already reordered by OptimizeMesh(). A cache is keyed by the source path, modification time
+// and content hash, and is invalidated by a version or vertex layout change.
+fs::path MeshCachePath(const fs::path& sourcePath);
+
+std::unique_ptr<Geometry> LoadMeshCache(const fs::path& sourcePath, bool upload = true);
+bool WriteMeshCache(const fs::path& sourcePath, const Geometry& geometry);
+
+// Loads an OBJ file through its cache, creating the cache when it is missing or stale.
+// Without upload no GL calls are made, so it can run on any thread.
+std::unique_ptr<Geometry> LoadCachedObj(const fs::path& sourcePath, bool upload = true);
+
+// Builds caches for every OBJ file under a directory without a GL context. Returns the
+// number of caches written.
+std::size_t BuildMeshCaches(const fs::path& directory);
+
+} // namespace pbr
+
+#endif
@@ -1,15 +1,238 @@
 #include <ObjLoader.h>
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
+#include <JobSystem.h>
+#include <MappedFile.h>
 
-#include <filesystem>
+#include <atomic>
+#include <charconv>
+#include <chrono>
 
 using namespace pbr;
 using namespace pbr::math;
 using namespace std::filesystem;
 
+namespace {
+
+// Files are split in chunks of at least this size, one per thread
+constexpr std::size_t MinChunkSize = 1 << 20;
+
+constexpr std::int32_t NoIndex = std::numeric_limits<std::int32_t>::min();
+
+enum Attrib { Position = 0, TexCoord = 1, Normal = 2, NumAttribs = 3 };
+
+// Zero based indices of a face corner into the position, texcoord and normal arrays
+struct Corner {
+    std::array<std::int32_t, NumAttribs> idx;
+
+    bool operator==(const Corner&) const = default;
+};
+
+struct CornerHash {
+    std::size_t operator()(const Corner& c) const {
+        std::uint64_t h = static_cast<std::uint32_t>(c.idx[Position]);
+        h = h * 0x9e3779b97f4a7c15ull + static_cast<std::uint32_t>(c.idx[TexCoord]);
+        h = h * 0x9e3779b97f4a7c15ull + static_cast<std::uint32_t>(c.idx[Normal]);
+        return h ^ (h >> 29);
+    }
+};
+
+// Negative OBJ indices are relative to the elements read so far. While parsing they
+// are resolved against the chunk, and the chunk's base is added once all are known.
+struct Fixup {
+    std::uint32_t corner;
+    std::uint8_t attribMask;
+};
+
+struct Chunk {
+    std::string_view text;
+
+    std::array<std::vector<float>, NumAttribs> attribs;
+    std::vector<Corner> corners;
+    std::vector<Fixup> fixups;
+
+    std::array<std::size_t, NumAttribs> base{};
+    std::size_t firstCorner = 0;
+    std::size_t line = 0;
+    bool failed = false;
+};
+
+constexpr std::array<std::size_t, NumAttribs> AttribSize{3, 2, 3};
+
+template<typename Func>
+void ParallelFor(std::size_t count, Func&& func) {
+    JobSystem::get().parallelFor(count, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            func(i);
+    });
+}
+
+const char* SkipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t'))
+        ++p;
+    return p;
+}
+
+template<typename T>
+bool ParseNumber(const char*& p, const char* end, T& value) {
+    p = SkipSpaces(p, end);
+    if (p < end && *p == '+')
+        ++p;
+
+    auto [ptr, ec] = std::from_chars(p, end, value);
+    if (ec != std::errc())
+        return false;
+
+    p = ptr;
+    return true;
+}
+
+bool ParseFloats(const char* p, const char* end, std::size_t count,
+                 std::vector<float>& out) {
+    for (std::size_t i = 0; i < count; ++i) {
+        float value;
+        if (!ParseNumber(p, end, value))
+            return false;
+        out.push_back(value);
+    }
+    return true;
+}
+
+bool ParseFace(const char* p, const char* end, Chunk& chunk) {
+    // Corners of the polygon and the mask of their chunk relative indices
+    thread_local std::vector<std::pair<Corner, std::uint8_t>> polygon;
+    polygon.clear();
+
+    while (true) {
+        p = SkipSpaces(p, end);
+        if (p == end || *p == '\r' || *p == '#')
+            break;
+
+        Corner corner{NoIndex, NoIndex, NoIndex};
+        std::uint8_t mask = 0;
+
+        auto parseIndex = [&](Attrib attrib) {
+            std::int32_t idx;
+            if (!ParseNumber(p, end, idx) || idx == 0)
+                return false;
+
+            if (idx > 0) {
+                corner.idx[attrib] = idx - 1;
+            } else {
+                const auto count = chunk.attribs[attrib].size() / AttribSize[attrib];
+                corner.idx[attrib] = static_cast<std::int32_t>(count) + idx;
+                mask |= 1 << attrib;
+            }
+            return true;
+        };
+
+        if (!parseIndex(Position))
+            return false;
+
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p != '/' && !parseIndex(TexCoord))
+                return false;
+
+            if (p < end && *p == '/') {
+                ++p;
+                if (!parseIndex(Normal))
+                    return false;
+            }
+        }
+
+        polygon.emplace_back(corner, mask);
+    }
+
+    if (polygon.size() < 3)
+        return false;
+
+    // Fan triangulation
+    auto emit = [&chunk](const std::pair<Corner, std::uint8_t>& c) {
+        if (c.second != 0)
+            chunk.fixups.push_back({static_cast<std::uint32_t>(chunk.corners.size()),
+                                    c.second});
+        chunk.corners.push_back(c.first);
+    };
+
+    for (std::size_t i = 1; i + 1 < polygon.size(); ++i) {
+        emit(polygon[0]);
+        emit(polygon[i]);
+        emit(polygon[i + 1]);
+    }
+
+    return true;
+}
+
+void ParseChunk(Chunk& chunk) {
+    const char* p = chunk.text.data();
+    const char* end = p + chunk.text.size();
+
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol)
+            eol = end;
+
+        ++chunk.line;
+
+        const char* s = SkipSpaces(p, eol);
+        bool ok = true;
+        if (eol - s > 2 && s[0] == 'v') {
+            switch (s[1]) {
+            case ' ':
+            case '\t':
+                ok = ParseFloats(s + 1, eol, 3, chunk.attribs[Position]);
+                break;
+            case 't':
+                ok = ParseFloats(s + 2, eol, 2, chunk.attribs[TexCoord]);
+                break;
+            case 'n':
+                ok = ParseFloats(s + 2, eol, 3, chunk.attribs[Normal]);
+                break;
+            }
+        } else if (eol - s > 1 && s[0] == 'f' && (s[1] == ' ' || s[1] == '\t')) {
+            ok = ParseFace(s + 1, eol, chunk);
+        }
+
+        if (!ok) {
+            chunk.failed = true;
+            return;
+        }
+
+        p = eol + 1;
+    }
+}
+
+// Splits the text in roughly equal chunks that start at line boundaries
+std::vector<Chunk> SplitChunks(std::string_view text, std::size_t numChunks) {
+    std::vector<Chunk> chunks;
+
+    std::size_t begin = 0;
+    for (std::size_t c = 0; c < numChunks && begin < text.size(); ++c) {
+        std::size_t end = text.size() * (c + 1) / numChunks;
+        if (end < begin)
+            end = begin;
+
+        end = text.find('\n', end);
+        end = end == std::string_view::npos ? text.size() : end + 1;
+
+        chunks.emplace_back().text = text.substr(begin, end - begin);
+        begin = end;
+    }
+
+    return chunks;
+}
+
+bool InRange(std::int32_t idx, std::size_t count, bool optional) {
+    if (idx == NoIndex)
+        return optional;
+    return idx >= 0 && static_cast<std::size_t>(idx) < count;
+}
+
+} // namespace
+
 std::optional<ObjFile> pbr::LoadObjFile(const fs::path& filePath) {
+    using Clock = std::chrono::steady_clock;
+
     auto filePathStr = filePath.string();
 
     if (!std::filesystem::exists(filePath)) {
@@ -17,43 +240,140 @@ std::optional<ObjFile> pbr::LoadObjFile(const fs::path& filePath) {
         return std::nullopt;
     }
 
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string err;
+    const auto start = Clock::now();
 
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, filePathStr.c_str())) {
-        LOG_ERROR("Failed to load obj file {}: {}", filePathStr, err);
+    MappedFile file{filePath};
+    if (!file.isOpen()) {
+        LOG_ERROR("Failed to map obj file {}.", filePathStr);
         return std::nullopt;
     }
 
+    const std::string_view text{file.as<char>(), file.size()};
+    const std::size_t numThreads = std::clamp<std::size_t>(
+        text.size() / MinChunkSize, 1, JobSystem::get().numThreads());
+
+    // Parse chunks independently
+    std::vector<Chunk> chunks = SplitChunks(text, numThreads);
+    ParallelFor(chunks.size(), [&](std::size_t c) { ParseChunk(chunks[c]); });
+
+    std::array<std::size_t, NumAttribs> counts{};
+    std::size_t numCorners = 0, line = 0;
+    for (auto& chunk : chunks) {
+        if (chunk.failed) {
+            LOG_ERROR("Failed to parse obj file {} at line {}.", filePathStr,
+                      line + chunk.line);
+            return std::nullopt;
+        }
+
+        for (std::size_t a = 0; a < NumAttribs; ++a) {
+            chunk.base[a] = counts[a];
+            counts[a] += chunk.attribs[a].size() / AttribSize[a];
+        }
+
+        chunk.firstCorner = numCorners;
+        numCorners += chunk.corners.size();
+        line += chunk.line;
+    }
+
+    // Gather attributes and make indices absolute
+    std::array<std::vector<float>, NumAttribs> attribs;
+    for (std::size_t a = 0; a < NumAttribs; ++a)
+        attribs[a].resize(counts[a] * AttribSize[a]);
+
+    ParallelFor(chunks.size(), [&](std::size_t c) {
+        Chunk& chunk = chunks[c];
+        for (std::size_t a = 0; a < NumAttribs; ++a) {
+            std::copy(chunk.attribs[a].begin(), chunk.attribs[a].end(),
+                      attribs[a].begin() + chunk.base[a] * AttribSize[a]);
+            std::vector<float>().swap(chunk.attribs[a]);
+        }
+
+        for (const Fixup& fixup : chunk.fixups)
+            for (std::size_t a = 0; a < NumAttribs; ++a)
+                if (fixup.attribMask & (1 << a))
+                    chunk.corners[fixup.corner].idx[a] += chunk.base[a];
+    });
+
+    // Deduplicate corners. Each thread owns the corners that hash to its shard and
+    // numbers them in file order, so the result doesn't depend on scheduling.
+    const std::size_t numShards = chunks.size();
+    auto shardOf = [numShards](const Corner& c) { return CornerHash{}(c) % numShards; };
+
+    std::vector<std::vector<std::vector<std::uint32_t>>> buckets(chunks.size());
+    ParallelFor(chunks.size(), [&](std::size_t c) {
+        buckets[c].resize(numShards);
+        const auto& corners = chunks[c].corners;
+        for (std::size_t i = 0; i < corners.size(); ++i)
+            buckets[c][shardOf(corners[i])].push_back(i);
+    });
+
     ObjFile objFile;
     objFile.objName = filePath.filename().string();
+    objFile.indices.resize(numCorners);
+
+    std::vector<std::vector<Corner>> shardVerts(numShards);
+    std::atomic<bool> badIndex = false;
+    ParallelFor(numShards, [&](std::size_t s) {
+        std::unordered_map<Corner, std::uint32_t, CornerHash> unique;
+        for (std::size_t c = 0; c < chunks.size(); ++c) {
+            for (const auto i : buckets[c][s]) {
+                const Corner& corner = chunks[c].corners[i];
+                auto [it, inserted] = unique.try_emplace(corner, shardVerts[s].size());
+                if (inserted) {
+                    if (!InRange(corner.idx[Position], counts[Position], false) ||
+                        !InRange(corner.idx[TexCoord], counts[TexCoord], true) ||
+                        !InRange(corner.idx[Normal], counts[Normal], true))
+                        badIndex = true;
+                    shardVerts[s].push_back(corner);
+                }
+                objFile.indices[chunks[c].firstCorner + i] = it->second;
+            }
+        }
+    });
 
-    auto& vertices = objFile.vertices;
-    auto& indices = objFile.indices;
-    for (const auto& shape : shapes) {
-        for (const auto& index : shape.mesh.indices) {
-            Vertex& vertex = vertices.emplace_back();
+    if (badIndex) {
+        LOG_ERROR("Obj file {} has out of range indices.", filePathStr);
+        return std::nullopt;
+    }
 
-            vertex.position = {attrib.vertices[3 * index.vertex_index + 0],
-                               attrib.vertices[3 * index.vertex_index + 1],
-                               attrib.vertices[3 * index.vertex_index + 2]};
+    std::vector<std::size_t> shardBase(numShards + 1, 0);
+    for (std::size_t s = 0; s < numShards; ++s)
+        shardBase[s + 1] = shardBase[s] + shardVerts[s].size();
 
-            if (attrib.normals.size() > 0) {
-                vertex.normal = {attrib.normals[3 * index.normal_index + 0],
-                                 attrib.normals[3 * index.normal_index + 1],
-                                 attrib.normals[3 * index.normal_index + 2]};
-            }
+    objFile.vertices.resize(shardBase.back());
+    ParallelFor(numShards, [&](std::size_t s) {
+        const float* pos = attribs[Position].data();
+        const float* uv = attribs[TexCoord].data();
+        const float* nrm = attribs[Normal].data();
 
-            if (attrib.texcoords.size() > 0) {
-                vertex.uv = {attrib.texcoords[2 * index.texcoord_index + 0],
-                             1.0f - attrib.texcoords[2 * index.texcoord_index + 1]};
-            }
+        Vertex* out = objFile.vertices.data() + shardBase[s];
+        for (const Corner& corner : shardVerts[s]) {
+            Vertex& vertex = *out++;
 
-            indices.push_back(indices.size());
+            const auto p = corner.idx[Position];
+            vertex.position = {pos[3 * p], pos[3 * p + 1], pos[3 * p + 2]};
+
+            if (const auto n = corner.idx[Normal]; n != NoIndex)
+                vertex.normal = {nrm[3 * n], nrm[3 * n + 1], nrm[3 * n + 2]};
+
+            if (const auto t = corner.idx[TexCoord]; t != NoIndex)
+                vertex.uv = {uv[2 * t], 1.0f - uv[2 * t + 1]};
         }
-    }
+    });
+
+    ParallelFor(chunks.size(), [&](std::size_t c) {
+        const auto& corners = chunks[c].corners;
+        unsigned int* indices = objFile.indices.data() + chunks[c].firstCorner;
+        for (std::size_t i = 0; i < corners.size(); ++i)
+            indices[i] += shardBase[shardOf(corners[i])];
+    });
+
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+    const double sizeMB = text.size() / (1024.0 * 1024.0);
+    LOGI("Loaded {} ({:.1f} MB, {} vertices, {} triangles) in {:.2f} s, {:.1f} MB/s on {} "
+         "threads",
+         objFile.objName, sizeMB, objFile.vertices.size(), objFile.indices.size() / 3,
+         elapsed.count(), sizeMB / elapsed.count(), chunks.size());
 
     return objFile;
-}
\ No newline at end of file
+}
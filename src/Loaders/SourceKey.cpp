@@ -0,0 +1,27 @@
+#include <SourceKey.h>
+
+#include <Hash.h>
+#include <MappedFile.h>
+
+using namespace pbr;
+
+std::optional<SourceKey> pbr::GetSourceKey(const fs::path& sourcePath) {
+    std::error_code ec;
+    const auto time = fs::last_write_time(sourcePath, ec);
+    if (ec)
+        return std::nullopt;
+
+    const auto size = fs::file_size(sourcePath, ec);
+    if (ec)
+        return std::nullopt;
+
+    const std::string path = fs::weakly_canonical(sourcePath, ec).generic_string();
+    return SourceKey{.pathHash = HashBytes(std::as_bytes(std::span{path})),
+                     .time = static_cast<std::int64_t>(time.time_since_epoch().count()),
+                     .size = size};
+}
+
+std::uint64_t pbr::HashFile(const fs::path& filePath) {
+    MappedFile file{filePath};
+    return HashBytes(file.data());
+}
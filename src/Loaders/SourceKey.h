@@ -0,0 +1,25 @@
+#ifndef PBR_SOURCEKEY_H
+#define PBR_SOURCEKEY_H
+
+#include <PBR.h>
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace pbr {
+
+// Identifies the source file a cache was built from. The content hash is only computed
+// when the cheap key doesn't match, so touched or moved sources stay valid.
+struct SourceKey {
+    std::uint64_t pathHash;
+    std::int64_t time;
+    std::uint64_t size;
+};
+
+std::optional<SourceKey> GetSourceKey(const fs::path& sourcePath);
+std::uint64_t HashFile(const fs::path& filePath);
+
+} // namespace pbr
+
+#endif
@@ -0,0 +1,227 @@
+#include <TextureCache.h>
+
+#include <MappedFile.h>
+#include <SourceKey.h>
+#include <Utils.h>
+
+#include <fstream>
+
+using namespace pbr;
+using namespace pbr::util;
+
+namespace {
+
+constexpr std::array<char, 8> Magic{'P', 'B', 'R', 'M', 'I', 'P', 'S', '\0'};
+constexpr std::uint32_t Version = 1;
+
+struct TextureCacheHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t options;
+
+    // Source key
+    std::uint64_t pathHash;
+    std::int64_t sourceTime;
+    std::uint64_t sourceSize;
+    std::uint64_t sourceHash;
+
+    std::uint32_t pixelFormat;
+    std::int32_t width;
+    std::int32_t height;
+    std::int32_t numChannels;
+    std::int32_t numLevels;
+    std::uint32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable_v<TextureCacheHeader>);
+static_assert(sizeof(TextureCacheHeader) % alignof(float) == 0);
+
+constexpr std::array EncodingNames{"linear", "srgb", "normal"};
+
+std::uint32_t PackOptions(MipOptions options) {
+    return static_cast<std::uint32_t>(options.filter) |
+           static_cast<std::uint32_t>(options.encoding) << 8 |
+           static_cast<std::uint32_t>(options.wrap) << 16;
+}
+
+ImageFormat HeaderFormat(const TextureCacheHeader& header) {
+    return {.pFmt = static_cast<PixelFormat>(header.pixelFormat),
+            .width = header.width,
+            .height = header.height,
+            .nChannels = header.numChannels};
+}
+
+bool IsCompatible(const TextureCacheHeader& header, std::size_t fileSize) {
+    if (header.magic != Magic || header.version != Version ||
+        header.pixelFormat > static_cast<std::uint32_t>(PixelFormat::BC7) ||
+        header.width <= 0 || header.height <= 0 || header.numChannels < 1 ||
+        header.numChannels > 4 || header.numLevels < 1)
+        return false;
+
+    return sizeof(TextureCacheHeader) +
+               ImageSize(HeaderFormat(header), header.numLevels) ==
+           fileSize;
+}
+
+bool MatchesKey(const TextureCacheHeader& header, const SourceKey& key) {
+    return header.pathHash == key.pathHash && header.sourceTime == key.time &&
+           header.sourceSize == key.size;
+}
+
+void RefreshKey(const fs::path& cachePath, const SourceKey& key) {
+    std::fstream file{cachePath, std::ios::in | std::ios::out | std::ios::binary};
+
+    TextureCacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return;
+
+    header.pathHash = key.pathHash;
+    header.sourceTime = key.time;
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+// Maps the cache of a source if it is still valid for it and was built with options
+MappedFile OpenCache(const fs::path& sourcePath, MipOptions options) {
+    const fs::path cachePath = TextureCachePath(sourcePath, options.encoding);
+    if (!fs::exists(cachePath))
+        return {};
+
+    MappedFile file{cachePath};
+    if (!file.isOpen() || file.size() < sizeof(TextureCacheHeader))
+        return {};
+
+    const auto& header = *file.as<TextureCacheHeader>();
+    if (!IsCompatible(header, file.size())) {
+        LOGW("Discarding incompatible texture cache {}.", cachePath.string());
+        return {};
+    }
+
+    if (header.options != PackOptions(options))
+        return {};
+
+    const auto key = GetSourceKey(sourcePath);
+    if (!key)
+        return {};
+
+    if (!MatchesKey(header, *key)) {
+        // A touched, copied or moved source is still valid if its content is unchanged
+        if (header.sourceSize != key->size || header.sourceHash != HashFile(sourcePath))
+            return {};
+
+        // Release the mapping before the header is rewritten in place
+        file = MappedFile{};
+        RefreshKey(cachePath, *key);
+        file = MappedFile{cachePath};
+    }
+
+    return file;
+}
+
+} // namespace
+
+fs::path pbr::TextureCachePath(const fs::path& sourcePath, MipEncoding encoding) {
+    fs::path cachePath = sourcePath;
+    cachePath += std::format(".{}.pbrmips", EncodingNames[static_cast<int>(encoding)]);
+    return cachePath;
+}
+
+std::unique_ptr<Image> pbr::LoadTextureCache(const fs::path& sourcePath,
+                                             MipOptions options) {
+    MappedFile file = OpenCache(sourcePath, options);
+    if (!file.isOpen())
+        return nullptr;
+
+    const auto& header = *file.as<TextureCacheHeader>();
+    const ImageFormat fmt = HeaderFormat(header);
+    const int numLevels = header.numLevels;
+
+    // Pixels are read straight from the mapping
+    auto mapping = std::make_shared<const MappedFile>(std::move(file));
+    return std::make_unique<Image>(fmt, std::move(mapping), sizeof(TextureCacheHeader),
+                                   numLevels);
+}
+
+bool pbr::WriteTextureCache(const fs::path& sourcePath, const Image& image,
+                            MipOptions options) {
+    const auto key = GetSourceKey(sourcePath);
+    if (!key)
+        return false;
+
+    const ImageFormat fmt = image.format();
+
+    TextureCacheHeader header{.magic = Magic,
+                              .version = Version,
+                              .options = PackOptions(options),
+                              .pathHash = key->pathHash,
+                              .sourceTime = key->time,
+                              .sourceSize = key->size,
+                              .sourceHash = HashFile(sourcePath),
+                              .pixelFormat = static_cast<std::uint32_t>(fmt.pFmt),
+                              .width = fmt.width,
+                              .height = fmt.height,
+                              .numChannels = fmt.nChannels,
+                              .numLevels = image.numLevels(),
+                              .reserved = 0};
+
+    // Write to a temporary first so an interrupted write never leaves a truncated cache
+    const fs::path cachePath = TextureCachePath(sourcePath, options.encoding);
+    fs::path tmpPath = cachePath;
+    tmpPath += ".tmp";
+
+    {
+        std::ofstream file{tmpPath, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(image.data()), image.size());
+
+        if (!file) {
+            LOGW("Failed to write texture cache {}.", cachePath.string());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmpPath, cachePath, ec);
+    if (ec) {
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+
+    return true;
+}
+
+std::unique_ptr<Image> pbr::LoadMippedImage(const fs::path& sourcePath,
+                                            MipOptions options) {
+    if (auto image = LoadTextureCache(sourcePath, options))
+        return image;
+
+    auto image = LoadImage(sourcePath);
+    if (!image || image->numLevels() > 1 || IsCompressed(image->format().pFmt) ||
+        NumMipLevels(image->format()) == 1)
+        return image;
+
+    auto mips = std::make_unique<Image>(GenerateMips(*image, options));
+    if (!WriteTextureCache(sourcePath, *mips, options))
+        LOGW("Unable to cache texture mips {}.", sourcePath.string());
+
+    return mips;
+}
+
+fs::path pbr::CompressedCubePath(const fs::path& sourcePath) {
+    fs::path cubePath = sourcePath;
+    cubePath.replace_extension(".bc6h.cube");
+    return cubePath;
+}
+
+fs::path pbr::ResolveCubemapPath(const fs::path& sourcePath) {
+    const fs::path cubePath = CompressedCubePath(sourcePath);
+
+    std::error_code ec;
+    const auto cubeTime = fs::last_write_time(cubePath, ec);
+    if (ec)
+        return sourcePath;
+
+    const auto sourceTime = fs::last_write_time(sourcePath, ec);
+    return !ec && cubeTime >= sourceTime ? cubePath : sourcePath;
+}
@@ -0,0 +1,35 @@
+#ifndef PBR_TEXTURECACHE_H
+#define PBR_TEXTURECACHE_H
+
+#include <PBR.h>
+#include <MipChain.h>
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace pbr {
+
+// Binary .pbrmips files store an image with its generated mip chain next to its source,
+// one per encoding. A cache is keyed by the source like mesh caches, and is rebuilt
+// when the filter or wrap mode it was generated with changes. Caches written offline by
+// pbr-texc hold block compressed levels and load the same way.
+fs::path TextureCachePath(const fs::path& sourcePath, MipEncoding encoding);
+
+std::unique_ptr<Image> LoadTextureCache(const fs::path& sourcePath, MipOptions options);
+bool WriteTextureCache(const fs::path& sourcePath, const Image& image,
+                       MipOptions options);
+
+// Loads an image with a full mip chain, through its cache when the source has a single
+// level. Images that come with their own levels are returned as they are. No GL calls
+// are made, so it can run on any thread.
+std::unique_ptr<Image> LoadMippedImage(const fs::path& sourcePath, MipOptions options);
+
+// BC6H cubemaps written by pbr-texc sit next to their source as <name>.bc6h.cube. Returns
+// that path while it's at least as new as the source, the source path otherwise.
+fs::path CompressedCubePath(const fs::path& sourcePath);
+fs::path ResolveCubemapPath(const fs::path& sourcePath);
+
+} // namespace pbr
+
+#endif
@@ -5,10 +5,30 @@
 #include <PBRMaterial.h>
 #include <Shader.h>
 #include <Utils.h>
+#include <TextureStreamer.h>
+#include <MipChain.h>
 
 using namespace pbr;
 using namespace util;
 
+namespace {
+
+using TextureSetter = void (PBRMaterial::*)(RRID);
+
+// The material keeps its placeholder map until the texture is streamed in. Colors are
+// gamma encoded, other maps hold linear values or normals.
+void StreamTexture(const sref<PBRMaterial>& mat, const fs::path& path,
+                   TextureSetter setter, MipEncoding encoding = MipEncoding::Linear) {
+    auto onReady = [weak = std::weak_ptr(mat), setter](RRID tex) {
+        if (auto mat = weak.lock())
+            (*mat.*setter)(tex);
+    };
+
+    TextureStreamer::get().request(path, encoding, std::move(onReady));
+}
+
+} // namespace
+
 void Material::use() const {
     _program->use();
 }
@@ -21,38 +41,42 @@ std::shared_ptr<Material> pbr::CreateMaterial(const ParameterMap& params) {
     auto type = params.lookup("type", "pbr"s);
     fs::path parent = params.lookup("parentdir", ""s);
 
-    auto mat = std::make_unique<PBRMaterial>();
+    auto mat = std::make_shared<PBRMaterial>();
 
     if (auto tex = params.lookup<std::string>("diffuse"))
-        mat->setDiffuse(LoadTexture(parent / tex.value()));
+        StreamTexture(mat, parent / tex.value(), &PBRMaterial::setDiffuse,
+                      MipEncoding::SRGB);
     else
         mat->setDiffuse(params.lookup<Color>("diffuse", Color{0.5f}));
 
     if (auto tex = params.lookup<std::string>("normal"))
-        mat->setNormal(LoadTexture(parent / tex.value()));
+        StreamTexture(mat, parent / tex.value(), &PBRMaterial::setNormal,
+                      MipEncoding::Normal);
 
     mat->setReflectivity(params.lookup<float>("specular", 0.5f));
 
     if (auto tex = params.lookup<std::string>("roughness"))
-        mat->setRoughness(LoadTexture(parent / tex.value()));
+        StreamTexture(mat, parent / tex.value(), &PBRMaterial::setRoughness);
     else
         mat->setRoughness(params.lookup<float>("roughness", 0.2f));
 
     if (auto tex = params.lookup<std::string>("metallic"))
-        mat->setMetallic(LoadTexture(parent / tex.value()));
+        StreamTexture(mat, parent / tex.value(), &PBRMaterial::setMetallic);
     else
         mat->setMetallic(params.lookup<float>("metallic", 0.5f));
 
     if (auto tex = params.lookup<std::string>("ao"))
-        mat->setOcclusion(LoadTexture(parent / tex.value()));
+        StreamTexture(mat, parent / tex.value(), &PBRMaterial::setOcclusion);
 
     if (auto tex = params.lookup<std::string>("emissive"))
-        mat->setEmissive(LoadTexture(parent / tex.value()));
+        StreamTexture(mat, parent / tex.value(), &PBRMaterial::setEmissive,
+                      MipEncoding::SRGB);
 
     mat->setClearCoat(params.lookup<float>("clearcoat", 0.0f));
 
     if (auto tex = params.lookup<std::string>("clearnormal"))
-        mat->setClearCoatNormal(LoadTexture(parent / tex.value()));
+        StreamTexture(mat, parent / tex.value(), &PBRMaterial::setClearCoatNormal,
+                      MipEncoding::Normal);
 
     return mat;
 }
\ No newline at end of file
@@ -2,9 +2,22 @@
 #define PBR_MATERIAL_H
 
 #include <PBR.h>
+#include <Spectrum.h>
+
+#include <span>
 
 namespace pbr {
 
+// Matches the std430 Material struct in pbr.fs
+struct MaterialData {
+    alignas(16) Color diffuse;
+    float reflectivity;
+    float metallic;
+    float roughness;
+    float clearCoat;
+    float clearCoatRough;
+};
+
 class ParameterMap;
 class Program;
 
@@ -16,7 +29,11 @@ public:
     RRID program() const;
 
     virtual void prepare() = 0;
-    virtual void uploadData() const = 0;
+    virtual void toData(MaterialData& data) const = 0;
+    virtual void bindTextures() const = 0;
+
+    // Textures bound by bindTextures(), used to group draws that share them
+    virtual std::span<const RRID> textures() const = 0;
 
 protected:
     std::shared_ptr<Program> _program;
@@ -3,16 +3,49 @@
 #include <Resources.h>
 #include <Texture.h>
 #include <Shader.h>
+#include <ShaderPermutations.h>
 #include <RenderInterface.h>
 
 using namespace pbr;
 
 namespace {
-consteval int Index(PBRUniform uniform) {
+
+constexpr int Index(PBRUniform uniform) {
     return static_cast<int>(uniform) - 1;
 }
+
+// Maps of a material without textures
+const std::array<RRID, 7>& DefaultMaps() {
+    static const auto maps = [] {
+        RRID null = Resource.get<Texture>("null")->id();
+        RRID white = Resource.get<Texture>("white")->id();
+        RRID planar = Resource.get<Texture>("planar")->id();
+
+        std::array<RRID, 7> maps;
+        maps[Index(DIFFUSE_MAP)] = white;
+        maps[Index(NORMAL_MAP)] = planar;
+        maps[Index(METALLIC_MAP)] = white;
+        maps[Index(ROUGHNESS_MAP)] = white;
+        maps[Index(OCCLUSION_MAP)] = white;
+        maps[Index(EMISSIVE_MAP)] = null;
+        maps[Index(CLEARCOAT_NORMAL_MAP)] = planar;
+        return maps;
+    }();
+
+    return maps;
+}
+
 } // namespace
 
+const std::vector<std::string>& pbr::PBRFeatureDefines() {
+    static const std::vector<std::string> defines{
+        "HAS_DIFFUSE_MAP",   "HAS_NORMAL_MAP",    "HAS_METALLIC_MAP",
+        "HAS_ROUGHNESS_MAP", "HAS_OCCLUSION_MAP", "HAS_EMISSIVE_MAP",
+        "HAS_CLEARCOAT",     "HAS_CLEARCOAT_NORMAL_MAP",
+        "MULTISCATTERING",   "HAS_SPOT_LIGHTS",   "HAS_AREA_LIGHTS"};
+    return defines;
+}
+
 PBRMaterial::PBRMaterial()
     : Material(), _diffuse(1), _f0(0.5f), _metallic(1), _roughness(1) {
 
@@ -26,29 +59,60 @@ PBRMaterial::PBRMaterial(const Color& diff, float metallic, float roughness)
 }
 
 void PBRMaterial::init() {
-    _program = Resource.get<Program>("pbr");
+    _maps = DefaultMaps();
+}
 
-    RRID null = Resource.get<Texture>("null")->id();
-    RRID white = Resource.get<Texture>("white")->id();
-    RRID planar = Resource.get<Texture>("planar")->id();
+PBRFeature PBRMaterial::features() const {
+    using enum PBRFeature;
 
-    _maps[Index(DIFFUSE_MAP)] = white;
-    _maps[Index(NORMAL_MAP)] = planar;
-    _maps[Index(METALLIC_MAP)] = white;
-    _maps[Index(ROUGHNESS_MAP)] = white;
-    _maps[Index(OCCLUSION_MAP)] = white;
-    _maps[Index(EMISSIVE_MAP)] = null;
-    _maps[Index(CLEARCOAT_NORMAL_MAP)] = planar;
+    auto hasMap = [this](PBRUniform map) {
+        return _maps[Index(map)] != DefaultMaps()[Index(map)];
+    };
+
+    PBRFeature features = None;
+    if (hasMap(DIFFUSE_MAP))
+        features = features | DiffuseMap;
+    if (hasMap(NORMAL_MAP))
+        features = features | NormalMap;
+    if (hasMap(METALLIC_MAP))
+        features = features | MetallicMap;
+    if (hasMap(ROUGHNESS_MAP))
+        features = features | RoughnessMap;
+    if (hasMap(OCCLUSION_MAP))
+        features = features | OcclusionMap;
+    if (hasMap(EMISSIVE_MAP))
+        features = features | EmissiveMap;
+
+    if (_clearCoat > 0) {
+        features = features | ClearCoat;
+        if (hasMap(CLEARCOAT_NORMAL_MAP))
+            features = features | ClearCoatNormalMap;
+    }
+
+    return features;
+}
+
+void PBRMaterial::prepare() {
+    auto& programs = RHI.pbrPrograms();
+
+    const auto variant = ToUnderlying(features()) | programs.globalFeatures();
+    if (_program && variant == _variant)
+        return;
+
+    _program = programs.get(variant);
+    _variant = variant;
 }
 
-void PBRMaterial::uploadData() const {
-    _program->setVector3(DIFFUSE_VEC, {_diffuse.r, _diffuse.g, _diffuse.b});
-    _program->setFloat(REFLECTIVITY_FLOAT, _f0);
-    _program->setFloat(METALLIC_FLOAT, _metallic);
-    _program->setFloat(ROUGHNESS_FLOAT, _roughness);
-    _program->setFloat(CLEARCOAT_FLOAT, _clearCoat);
-    _program->setFloat(CLEARCOAT_ROUGH_FLOAT, _clearCoatRough);
+void PBRMaterial::toData(MaterialData& data) const {
+    data.diffuse = _diffuse;
+    data.reflectivity = _f0;
+    data.metallic = _metallic;
+    data.roughness = _roughness;
+    data.clearCoat = _clearCoat;
+    data.clearCoatRough = _clearCoatRough;
+}
 
+void PBRMaterial::bindTextures() const {
     RHI.bindTextures(1, 7, _maps);
 }
 
@@ -17,25 +17,48 @@ enum PBRUniform : int {
     OCCLUSION_MAP = 5,
     EMISSIVE_MAP = 6,
     CLEARCOAT_NORMAL_MAP = 7,
-    DIFFUSE_VEC = 8,
-    METALLIC_FLOAT = 9,
-    ROUGHNESS_FLOAT = 10,
-    REFLECTIVITY_FLOAT = 11,
-    CLEARCOAT_ROUGH_FLOAT = 12,
-    CLEARCOAT_FLOAT = 13,
 
     ENV_IRRADIANCE_MAP = 15,
     ENV_GGX_MAP = 16,
     ENV_BRDF_MAP = 17
 };
 
+// Shader variant features, each bit enables the code for it in pbr.fs. Maps left at
+// their defaults aren't sampled.
+enum class PBRFeature : std::uint32_t {
+    None = 0,
+    DiffuseMap = 1 << 0,
+    NormalMap = 1 << 1,
+    MetallicMap = 1 << 2,
+    RoughnessMap = 1 << 3,
+    OcclusionMap = 1 << 4,
+    EmissiveMap = 1 << 5,
+    ClearCoat = 1 << 6,
+    ClearCoatNormalMap = 1 << 7,
+
+    // Global, set for the whole scene
+    MultiScattering = 1 << 8,
+    SpotLights = 1 << 9,
+    AreaLights = 1 << 10
+};
+
+consteval bool EnableConversion(PBRFeature);
+consteval bool EnableBitmaskOperators(PBRFeature);
+
+// Defines of the PBRFeature bits, in bit order
+const std::vector<std::string>& PBRFeatureDefines();
+
 class PBRMaterial : public Material {
 public:
     PBRMaterial();
     PBRMaterial(const Color& diff, float metallic, float roughness);
 
-    void prepare() override {}
-    void uploadData() const override;
+    // Selects the cheapest program variant for the current maps and parameters
+    void prepare() override;
+    void toData(MaterialData& data) const override;
+    void bindTextures() const override;
+
+    std::span<const RRID> textures() const override { return _maps; }
 
     void setDiffuse(RRID diffTex);
     void setDiffuse(const Color& diffuse);
@@ -69,6 +92,8 @@ public:
     RRID roughTex() const;
     RRID emissiveTex() const;
 
+    PBRFeature features() const;
+
 private:
     void init();
 
@@ -80,6 +105,8 @@ private:
     float _roughness = 1;
     float _clearCoat = 0;
     float _clearCoatRough = 0;
+
+    std::uint32_t _variant = 0;
 };
 
 } // namespace pbr
@@ -123,6 +123,28 @@ bool math::Overlaps(const BBox3& box1, const BBox3& box2) {
 }
 
 BBox3 math::Transform(const Matrix4x4& mat, const BBox3& box) {
+    const bool affine =
+        mat(3, 0) == 0 && mat(3, 1) == 0 && mat(3, 2) == 0 && mat(3, 3) == 1;
+
+    if (affine) {
+        // Transform center and extent instead of the 8 corners [Arvo 1990]
+#ifdef PBR_SIMD_ENABLED
+        Vec3 min, max;
+        simd::TransformBox(mat.data(), &box[0].x, &box[1].x, &min.x, &max.x);
+        return {min, max};
+#else
+        const Vec3 center = mat * box.center();
+        const Vec3 extent = box.sizes() * 0.5f;
+
+        Vec3 newExtent;
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                newExtent[r] += std::abs(mat(r, c)) * extent[c];
+
+        return {center - newExtent, center + newExtent};
+#endif
+    }
+
     BBox3 ret(FLOAT_INFINITY, -FLOAT_INFINITY);
 
     ret.expand(mat * Vec4(box[0].x, box[0].y, box[0].z, 1.0f));
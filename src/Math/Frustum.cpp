@@ -0,0 +1,31 @@
+#include <Frustum.h>
+
+#include <BBox.h>
+
+using namespace pbr;
+using namespace pbr::math;
+
+Frustum::Frustum(const Mat4& viewProj) {
+    auto row = [&](unsigned int r) {
+        return Vec4(viewProj(r, 0), viewProj(r, 1), viewProj(r, 2), viewProj(r, 3));
+    };
+
+    const Vec4 w = row(3);
+    for (unsigned int axis = 0; axis < 3; ++axis) {
+        _planes[2 * axis] = w + row(axis);
+        _planes[2 * axis + 1] = w - row(axis);
+    }
+}
+
+bool Frustum::overlaps(const BBox3& box) const {
+    for (const Vec4& p : _planes) {
+        // Corner furthest along the plane normal
+        const Vec3 corner{p.x >= 0 ? box[1].x : box[0].x, p.y >= 0 ? box[1].y : box[0].y,
+                          p.z >= 0 ? box[1].z : box[0].z};
+
+        if (p.x * corner.x + p.y * corner.y + p.z * corner.z + p.w < 0)
+            return false;
+    }
+
+    return true;
+}
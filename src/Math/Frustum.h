@@ -0,0 +1,32 @@
+#ifndef PBR_FRUSTUM_H
+#define PBR_FRUSTUM_H
+
+#include <PBRMath.h>
+
+namespace pbr {
+namespace math {
+
+class BBox3;
+
+// Clip planes (a, b, c, d) of a view projection matrix, with normals pointing inwards.
+// Ordered left, right, bottom, top, near and far.
+// Reference: [Gribb and Hartmann, 2001] - "Fast Extraction of Viewing Frustum Planes"
+class Frustum {
+public:
+    Frustum() = default;
+    explicit Frustum(const Mat4& viewProj);
+
+    const Vec4& plane(unsigned int i) const { return _planes[i]; }
+    const std::array<Vec4, 6>& planes() const { return _planes; }
+
+    // Conservative, boxes near the frustum corners may be reported as overlapping
+    bool overlaps(const BBox3& box) const;
+
+private:
+    std::array<Vec4, 6> _planes;
+};
+
+} // namespace math
+} // namespace pbr
+
+#endif
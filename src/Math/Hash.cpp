@@ -1,5 +1,7 @@
 #include <Hash.h>
 
+#include <bit>
+
 namespace std {
     size_t hash<Vec2>::operator()(const Vec2& v) const {
         size_t seed = 0;
@@ -37,4 +39,41 @@ namespace std {
         HashCombine(seed, hasher(q.w));
         return seed;
     }
-}
\ No newline at end of file
+}
+
+namespace {
+    constexpr std::uint64_t Prime1 = 0x9e3779b185ebca87ull;
+    constexpr std::uint64_t Prime2 = 0xc2b2ae3d27d4eb4full;
+
+    std::uint64_t Mix(std::uint64_t h) {
+        h ^= h >> 33;
+        h *= Prime2;
+        h ^= h >> 29;
+        h *= Prime1;
+        h ^= h >> 32;
+        return h;
+    }
+}
+
+std::uint64_t pbr::math::HashBytes(std::span<const std::byte> bytes, std::uint64_t seed) {
+    std::uint64_t h = seed ^ (bytes.size() * Prime1);
+
+    // Four independent lanes over 32 byte blocks keep the multiplies pipelined
+    std::array<std::uint64_t, 4> lanes{h + Prime1, h + Prime2, h, h - Prime1};
+    std::size_t pos = 0;
+    for (; pos + 32 <= bytes.size(); pos += 32) {
+        for (std::size_t l = 0; l < 4; ++l) {
+            std::uint64_t word;
+            std::memcpy(&word, bytes.data() + pos + 8 * l, 8);
+            lanes[l] = std::rotl(lanes[l] + word * Prime2, 31) * Prime1;
+        }
+    }
+
+    for (std::size_t l = 0; l < 4; ++l)
+        h = (h ^ Mix(lanes[l])) * Prime1;
+
+    for (; pos < bytes.size(); ++pos)
+        h = (h ^ static_cast<std::uint64_t>(bytes[pos])) * Prime2;
+
+    return Mix(h);
+}
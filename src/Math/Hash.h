@@ -33,6 +33,9 @@ namespace pbr {
             hash += 0x9e3779b9 + (seed << 6) + (seed >> 2);
             seed ^= hash;
         }
+
+        // 64 bit hash of a byte range, for content keyed caches
+        std::uint64_t HashBytes(std::span<const std::byte> bytes, std::uint64_t seed = 0);
     }
 }
 
@@ -2,52 +2,101 @@
 #define PBR_MATRIX4X4_H
 
 #include <PBR.h>
+#include <SIMD.h>
+#include <Vector3.h>
+#include <Vector4.h>
 
 namespace pbr {
 namespace math {
 
-class Vector3;
-class Vector4;
 class Matrix3x3;
 class Quat;
 
+// Column major storage, operator()(row, col)
 class Matrix4x4 {
 public:
-    Matrix4x4();
-    explicit Matrix4x4(float scalar);
-    Matrix4x4(float m11, float m12, float m13, float m14, float m21, float m22, float m23,
-              float m24, float m31, float m32, float m33, float m34, float m41, float m42,
-              float m43, float m44);
-    Matrix4x4(const Vector4& col0, const Vector4& col1, const Vector4& col2,
-              const Vector4& col3);
-    explicit Matrix4x4(const Matrix3x3& mat);
-    explicit Matrix4x4(const Quat& quat);
+    // clang-format off
+    constexpr Matrix4x4() : m{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}} {}
 
-    Matrix4x4 operator*(float scalar) const;
-    Matrix4x4& operator*=(float scalar);
+    constexpr explicit Matrix4x4(float s)
+        : m{{s, s, s, s}, {s, s, s, s}, {s, s, s, s}, {s, s, s, s}} {}
 
-    Vector3 operator*(const Vector3& v) const;
-    Vector4 operator*(const Vector4& v) const;
-    Matrix4x4 operator*(const Matrix4x4& mat) const;
+    constexpr Matrix4x4(float m11, float m12, float m13, float m14, float m21, float m22,
+                        float m23, float m24, float m31, float m32, float m33, float m34,
+                        float m41, float m42, float m43, float m44)
+        : m{{m11, m21, m31, m41}, {m12, m22, m32, m42}, {m13, m23, m33, m43},
+            {m14, m24, m34, m44}} {}
 
-    Matrix4x4 operator+(const Matrix4x4& mat) const;
-    Matrix4x4& operator+=(const Matrix4x4& mat);
+    constexpr Matrix4x4(const Vector4& col0, const Vector4& col1, const Vector4& col2,
+                        const Vector4& col3)
+        : m{{col0.x, col0.y, col0.z, col0.w}, {col1.x, col1.y, col1.z, col1.w},
+            {col2.x, col2.y, col2.z, col2.w}, {col3.x, col3.y, col3.z, col3.w}} {}
+    // clang-format on
 
-    Matrix4x4 operator-(const Matrix4x4& mat) const;
-    Matrix4x4& operator-=(const Matrix4x4& mat);
+    explicit Matrix4x4(const Matrix3x3& mat);
+    explicit Matrix4x4(const Quat& quat);
 
-    Matrix4x4 operator-() const;
+    constexpr Matrix4x4 operator*(float scalar) const {
+        Matrix4x4 ret = *this;
+        return ret *= scalar;
+    }
 
-    bool operator==(const Matrix4x4& mat) const;
-    bool operator!=(const Matrix4x4& mat) const;
+    constexpr Matrix4x4& operator*=(float scalar) {
+        for (auto& col : m)
+            for (float& v : col)
+                v *= scalar;
+        return *this;
+    }
 
-    float operator()(unsigned int i, unsigned int j) const;
-    float& operator()(unsigned int i, unsigned int j);
+    // Transforms a point, the result is not projected
+    Vector3 operator*(const Vector3& v) const;
+    Vector4 operator*(const Vector4& v) const;
+    Matrix4x4 operator*(const Matrix4x4& mat) const;
 
-    float trace() const;
+    constexpr Matrix4x4 operator+(const Matrix4x4& mat) const {
+        Matrix4x4 ret = *this;
+        return ret += mat;
+    }
+
+    constexpr Matrix4x4& operator+=(const Matrix4x4& mat) {
+        for (int c = 0; c < 4; ++c)
+            for (int r = 0; r < 4; ++r)
+                m[c][r] += mat.m[c][r];
+        return *this;
+    }
+
+    constexpr Matrix4x4 operator-(const Matrix4x4& mat) const {
+        Matrix4x4 ret = *this;
+        return ret -= mat;
+    }
+
+    constexpr Matrix4x4& operator-=(const Matrix4x4& mat) {
+        for (int c = 0; c < 4; ++c)
+            for (int r = 0; r < 4; ++r)
+                m[c][r] -= mat.m[c][r];
+        return *this;
+    }
+
+    constexpr Matrix4x4 operator-() const { return *this * -1.0f; }
+
+    constexpr bool operator==(const Matrix4x4& mat) const {
+        for (int c = 0; c < 4; ++c)
+            for (int r = 0; r < 4; ++r)
+                if (m[c][r] != mat.m[c][r])
+                    return false;
+        return true;
+    }
+
+    constexpr bool operator!=(const Matrix4x4& mat) const { return !(*this == mat); }
+
+    constexpr float operator()(unsigned int i, unsigned int j) const { return m[j][i]; }
+    constexpr float& operator()(unsigned int i, unsigned int j) { return m[j][i]; }
+
+    constexpr float trace() const { return m[0][0] + m[1][1] + m[2][2] + m[3][3]; }
     float det() const;
 
     const float* data() const { return &m[0][0]; }
+    float* data() { return &m[0][0]; }
 
 private:
     float m[4][4];
@@ -57,12 +106,97 @@ std::istream& operator>>(std::istream& is, Matrix4x4& mat);
 std::ostream& operator<<(std::ostream& os, const Matrix4x4& mat);
 
 Vector3 operator*(const Vector3& v, const Matrix4x4& mat);
-Matrix4x4 operator*(float scalar, const Matrix4x4& mat);
+
+constexpr Matrix4x4 operator*(float scalar, const Matrix4x4& mat) {
+    return mat * scalar;
+}
 
 Matrix4x4 Transpose(const Matrix4x4& mat);
 Matrix4x4 Inverse(const Matrix4x4& mat);
 
+namespace scalar {
+
+constexpr Vector4 Mul(const Matrix4x4& mat, const Vector4& v) {
+    return {mat(0, 0) * v.x + mat(0, 1) * v.y + mat(0, 2) * v.z + mat(0, 3) * v.w,
+            mat(1, 0) * v.x + mat(1, 1) * v.y + mat(1, 2) * v.z + mat(1, 3) * v.w,
+            mat(2, 0) * v.x + mat(2, 1) * v.y + mat(2, 2) * v.z + mat(2, 3) * v.w,
+            mat(3, 0) * v.x + mat(3, 1) * v.y + mat(3, 2) * v.z + mat(3, 3) * v.w};
+}
+
+constexpr Matrix4x4 Mul(const Matrix4x4& a, const Matrix4x4& b) {
+    Matrix4x4 ret{0};
+    for (int c = 0; c < 4; ++c)
+        for (int k = 0; k < 4; ++k)
+            for (int r = 0; r < 4; ++r)
+                ret(r, c) += a(r, k) * b(k, c);
+    return ret;
+}
+
+constexpr Matrix4x4 Transpose(const Matrix4x4& mat) {
+    return {mat(0, 0), mat(1, 0), mat(2, 0), mat(3, 0), mat(0, 1), mat(1, 1),
+            mat(2, 1), mat(3, 1), mat(0, 2), mat(1, 2), mat(2, 2), mat(3, 2),
+            mat(0, 3), mat(1, 3), mat(2, 3), mat(3, 3)};
+}
+
+Matrix4x4 Inverse(const Matrix4x4& mat);
+
+} // namespace scalar
+
+inline Vector3 Matrix4x4::operator*(const Vector3& v) const {
+#ifdef PBR_SIMD_ENABLED
+    alignas(16) float ret[4];
+    _mm_store_ps(ret, simd::Combine(data(), _mm_setr_ps(v.x, v.y, v.z, 1.0f)));
+    return {ret[0], ret[1], ret[2]};
+#else
+    return {m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z + m[3][0],
+            m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z + m[3][1],
+            m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z + m[3][2]};
+#endif
+}
+
+inline Vector4 Matrix4x4::operator*(const Vector4& v) const {
+#ifdef PBR_SIMD_ENABLED
+    Vector4 ret;
+    simd::Store(&ret.x, simd::Combine(data(), simd::Load(&v.x)));
+    return ret;
+#else
+    return scalar::Mul(*this, v);
+#endif
+}
+
+inline Matrix4x4 Matrix4x4::operator*(const Matrix4x4& mat) const {
+#ifdef PBR_SIMD_ENABLED
+    Matrix4x4 ret;
+    simd::MulMat4(data(), mat.data(), ret.data());
+    return ret;
+#else
+    return scalar::Mul(*this, mat);
+#endif
+}
+
+inline Matrix4x4 Transpose(const Matrix4x4& mat) {
+#ifdef PBR_SIMD_ENABLED
+    Matrix4x4 ret;
+    simd::Transpose(mat.data(), ret.data());
+    return ret;
+#else
+    return scalar::Transpose(mat);
+#endif
+}
+
+// Singular matrices give a zero matrix
+inline Matrix4x4 Inverse(const Matrix4x4& mat) {
+#ifdef PBR_SIMD_ENABLED
+    Matrix4x4 ret;
+    if (!simd::Inverse(mat.data(), ret.data()))
+        return Matrix4x4(0);
+    return ret;
+#else
+    return scalar::Inverse(mat);
+#endif
+}
+
 } // namespace math
 } // namespace pbr
 
-#endif
\ No newline at end of file
+#endif
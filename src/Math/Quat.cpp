@@ -42,140 +42,6 @@ Quat::Quat(const Matrix4x4& mat) {
     }
 }
 
-Quat Quat::operator+(const Quat& q) const {
-    return {x + q.x, y + q.y, z + q.z, w + q.w};
-}
-
-Quat& Quat::operator+=(const Quat& q) {
-    w += q.w;
-    x += q.x;
-    y += q.y;
-    z += q.z;
-
-    return *this;
-}
-
-Quat Quat::operator-(const Quat& q) const {
-    return {x - q.x, y - q.y, z - q.z, w - q.w};
-}
-
-Quat& Quat::operator-=(const Quat& q) {
-    w -= q.w;
-    x -= q.x;
-    y -= q.y;
-    z -= q.z;
-
-    return *this;
-}
-
-Quat Quat::operator*(float scalar) const {
-    return {x * scalar, y * scalar, z * scalar, w * scalar};
-}
-
-Quat& Quat::operator*=(float scalar) {
-    x *= scalar;
-    y *= scalar;
-    z *= scalar;
-    w *= scalar;
-
-    return *this;
-}
-
-Quat Quat::operator*(const Quat& q) const {
-    Quat r;
-    r.w = w * q.w - x * q.x - y * q.y - z * q.z;
-    r.x = x * q.w + w * q.x + y * q.z - z * q.y;
-    r.y = y * q.w + w * q.y + z * q.x - x * q.z;
-    r.z = z * q.w + w * q.z + x * q.y - y * q.x;
-
-    return r;
-}
-
-Quat& Quat::operator*=(const Quat& q) {
-    Quat r = (*this * q);
-    *this = r;
-
-    return *this;
-}
-
-Quat Quat::operator/(float scalar) const {
-    return {x / scalar, y / scalar, z / scalar, w / scalar};
-}
-
-Quat& Quat::operator/=(float scalar) {
-    x /= scalar;
-    y /= scalar;
-    z /= scalar;
-    w /= scalar;
-
-    return *this;
-}
-
-float Quat::operator[](unsigned int idx) const {
-    if (idx == 0)
-        return w;
-
-    if (idx == 1)
-        return x;
-
-    if (idx == 2)
-        return y;
-
-    return z;
-}
-
-float& Quat::operator[](unsigned int idx) {
-    if (idx == 0)
-        return w;
-
-    if (idx == 1)
-        return x;
-
-    if (idx == 2)
-        return y;
-
-    return z;
-}
-
-Quat Quat::conj() const {
-    return {-x, -y, -z, w};
-}
-
-float Quat::lengthSqr() const {
-    return w * w + x * x + y * y + z * z;
-}
-
-float Quat::length() const {
-    return std::sqrt(lengthSqr());
-}
-
-void Quat::normalize() {
-    float lenSqr = lengthSqr();
-    if (lenSqr > 0)
-        *this /= std::sqrt(lenSqr);
-}
-
-Matrix4x4 Quat::toMatrix() const {
-    float xx = x * x, yy = y * y, zz = z * z;
-    float xy = x * y, xz = x * z, yz = y * z;
-    float wx = x * w, wy = y * w, wz = z * w;
-
-    Matrix4x4 m;
-    m(0, 0) = 1.0f - 2.0f * (yy + zz);
-    m(0, 1) = 2.0f * (xy - wz);
-    m(0, 2) = 2.0f * (xz + wy);
-
-    m(1, 0) = 2.0f * (xy + wz);
-    m(1, 1) = 1.0f - 2.0f * (xx + zz);
-    m(1, 2) = 2.0f * (yz - wx);
-
-    m(2, 0) = 2.0f * (xz - wy);
-    m(2, 1) = 2.0f * (yz + wx);
-    m(2, 2) = 1.0f - 2.0f * (xx + yy);
-
-    return m;
-}
-
 std::istream& math::operator>>(std::istream& is, Quat& q) {
     is >> q.x;
     is >> q.y;
@@ -189,21 +55,6 @@ std::ostream& math::operator<<(std::ostream& os, const Quat& q) {
     return os;
 }
 
-Quat math::operator*(float scalar, const Quat& q) {
-    return q * scalar;
-}
-
-float math::Dot(const Quat& q1, const Quat& q2) {
-    return q1.w * q2.w + q1.x * q2.x + q1.y * q2.y + q1.z * q2.z;
-}
-
-Quat math::Normalize(const Quat& q) {
-    float lenSqr = q.lengthSqr();
-    if (lenSqr > 0)
-        return q / std::sqrt(lenSqr);
-    return Quat(Vector3(0), 0);
-}
-
 Quat math::Slerp(float t, const Quat& q1, const Quat& q2) {
     float cosTheta = Dot(q1, q2);
     if (cosTheta > ONE_MINUS_EPSILON)
@@ -218,13 +69,6 @@ Quat math::Slerp(float t, const Quat& q1, const Quat& q2) {
     }
 }
 
-Vector3 math::Rotate(const Quat& q, const Vector3& v) {
-    Vector3 u(q.x, q.y, q.z);
-    float s = q.w;
-
-    return 2.0f * Dot(u, v) * u + (s * s - Dot(u, u)) * v + 2.0f * s * Cross(u, v);
-}
-
 Quat math::AxisAngle(const Vector3& axis, float angle) {
     auto cos = std::cos(angle * 0.5f);
     auto sin = std::sin(angle * 0.5f);
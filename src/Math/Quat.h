@@ -3,59 +3,172 @@
 
 #include <PBR.h>
 #include <Vector3.h>
+#include <Matrix4x4.h>
 
 namespace pbr {
 namespace math {
 
-class Matrix4x4;
-
 class Quat {
 public:
     float x = 0, y = 0, z = 0, w = 1;
 
-    Quat() = default;
-    Quat(const Vector3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
-    Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w){};
+    constexpr Quat() = default;
+    constexpr Quat(const Vector3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+    constexpr Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w){};
     explicit Quat(const Matrix4x4& mat);
 
-    Quat operator+(const Quat& q) const;
-    Quat& operator+=(const Quat& q);
+    constexpr Quat operator+(const Quat& q) const {
+        return {x + q.x, y + q.y, z + q.z, w + q.w};
+    }
+
+    constexpr Quat& operator+=(const Quat& q) {
+        w += q.w;
+        x += q.x;
+        y += q.y;
+        z += q.z;
+
+        return *this;
+    }
+
+    constexpr Quat operator-(const Quat& q) const {
+        return {x - q.x, y - q.y, z - q.z, w - q.w};
+    }
+
+    constexpr Quat& operator-=(const Quat& q) {
+        w -= q.w;
+        x -= q.x;
+        y -= q.y;
+        z -= q.z;
+
+        return *this;
+    }
+
+    constexpr Quat operator*(float scalar) const {
+        return {x * scalar, y * scalar, z * scalar, w * scalar};
+    }
+
+    constexpr Quat& operator*=(float scalar) {
+        x *= scalar;
+        y *= scalar;
+        z *= scalar;
+        w *= scalar;
+
+        return *this;
+    }
+
+    constexpr Quat operator*(const Quat& q) const {
+        Quat r;
+        r.w = w * q.w - x * q.x - y * q.y - z * q.z;
+        r.x = x * q.w + w * q.x + y * q.z - z * q.y;
+        r.y = y * q.w + w * q.y + z * q.x - x * q.z;
+        r.z = z * q.w + w * q.z + x * q.y - y * q.x;
+
+        return r;
+    }
+
+    constexpr Quat& operator*=(const Quat& q) {
+        *this = *this * q;
+        return *this;
+    }
+
+    constexpr Quat operator/(float scalar) const {
+        return {x / scalar, y / scalar, z / scalar, w / scalar};
+    }
 
-    Quat operator-(const Quat& q) const;
-    Quat& operator-=(const Quat& q);
+    constexpr Quat& operator/=(float scalar) {
+        x /= scalar;
+        y /= scalar;
+        z /= scalar;
+        w /= scalar;
 
-    Quat operator*(float scalar) const;
-    Quat& operator*=(float scalar);
+        return *this;
+    }
 
-    Quat operator*(const Quat& q) const;
-    Quat& operator*=(const Quat& q);
+    constexpr float operator[](unsigned int idx) const {
+        if (idx == 0)
+            return w;
 
-    Quat operator/(float scalar) const;
-    Quat& operator/=(float scalar);
+        if (idx == 1)
+            return x;
 
-    float operator[](unsigned int idx) const;
-    float& operator[](unsigned int idx);
+        if (idx == 2)
+            return y;
 
-    Quat conj() const;
+        return z;
+    }
 
-    float lengthSqr() const;
-    float length() const;
+    constexpr float& operator[](unsigned int idx) {
+        if (idx == 0)
+            return w;
 
-    void normalize();
+        if (idx == 1)
+            return x;
 
-    Matrix4x4 toMatrix() const;
+        if (idx == 2)
+            return y;
+
+        return z;
+    }
+
+    constexpr Quat conj() const { return {-x, -y, -z, w}; }
+
+    constexpr float lengthSqr() const { return w * w + x * x + y * y + z * z; }
+    float length() const { return std::sqrt(lengthSqr()); }
+
+    void normalize() {
+        float lenSqr = lengthSqr();
+        if (lenSqr > 0)
+            *this /= std::sqrt(lenSqr);
+    }
+
+    constexpr Matrix4x4 toMatrix() const {
+        float xx = x * x, yy = y * y, zz = z * z;
+        float xy = x * y, xz = x * z, yz = y * z;
+        float wx = x * w, wy = y * w, wz = z * w;
+
+        Matrix4x4 m;
+        m(0, 0) = 1.0f - 2.0f * (yy + zz);
+        m(0, 1) = 2.0f * (xy - wz);
+        m(0, 2) = 2.0f * (xz + wy);
+
+        m(1, 0) = 2.0f * (xy + wz);
+        m(1, 1) = 1.0f - 2.0f * (xx + zz);
+        m(1, 2) = 2.0f * (yz - wx);
+
+        m(2, 0) = 2.0f * (xz - wy);
+        m(2, 1) = 2.0f * (yz + wx);
+        m(2, 2) = 1.0f - 2.0f * (xx + yy);
+
+        return m;
+    }
 };
 
 std::istream& operator>>(std::istream& is, Quat& q);
 std::ostream& operator<<(std::ostream& os, const Quat& q);
 
-Quat operator*(float scalar, const Quat& q);
+constexpr Quat operator*(float scalar, const Quat& q) {
+    return q * scalar;
+}
+
+constexpr float Dot(const Quat& q1, const Quat& q2) {
+    return q1.w * q2.w + q1.x * q2.x + q1.y * q2.y + q1.z * q2.z;
+}
+
+inline Quat Normalize(const Quat& q) {
+    float lenSqr = q.lengthSqr();
+    if (lenSqr > 0)
+        return q / std::sqrt(lenSqr);
+    return Quat(Vector3(0), 0);
+}
+
+constexpr Vector3 Rotate(const Quat& q, const Vector3& v) {
+    Vector3 u(q.x, q.y, q.z);
+    float s = q.w;
 
-float Dot(const Quat& q1, const Quat& q2);
-Quat Normalize(const Quat& q);
+    return 2.0f * Dot(u, v) * u + (s * s - Dot(u, u)) * v + 2.0f * s * Cross(u, v);
+}
 
 Quat Slerp(float t, const Quat& q1, const Quat& q2);
-Vector3 Rotate(const Quat& q, const Vector3& v);
 Quat AxisAngle(const Vector3& axis, float angle);
 Quat RotationAlign(const Vector3& from, const Vector3& to);
 
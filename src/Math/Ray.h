@@ -23,6 +23,12 @@ private:
     float _tMin = FLOAT_EPSILON;
 };
 
+struct TriangleHit {
+    float t;
+    unsigned int triangle;
+    Vec2 barycentrics; // Weights of the second and third vertices
+};
+
 } // namespace math
 } // namespace pbr
 
@@ -0,0 +1,190 @@
+#ifndef PBR_SIMD_H
+#define PBR_SIMD_H
+
+// Vector kernels for 4x4 matrices stored as 4 contiguous columns. The instruction set is
+// picked at build time (PBR_SIMD=SSE|AVX2 in CMake), otherwise the math types fall back
+// to their scalar code.
+#if defined(PBR_SIMD_AVX2) || defined(PBR_SIMD_SSE)
+#define PBR_SIMD_ENABLED
+
+#include <immintrin.h>
+
+#include <algorithm>
+
+namespace pbr {
+namespace math {
+namespace simd {
+
+inline __m128 Load(const float* ptr) {
+    return _mm_loadu_ps(ptr);
+}
+
+inline void Store(float* ptr, __m128 v) {
+    _mm_storeu_ps(ptr, v);
+}
+
+inline __m128 MulAdd(__m128 a, __m128 b, __m128 c) {
+#ifdef PBR_SIMD_AVX2
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+template<int I>
+inline __m128 Splat(__m128 v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(I, I, I, I));
+}
+
+inline __m128 Abs(__m128 v) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+// Sum of the columns of mat weighted by the components of w
+inline __m128 Combine(const float* mat, __m128 w) {
+    __m128 r = _mm_mul_ps(Load(mat), Splat<0>(w));
+    r = MulAdd(Load(mat + 4), Splat<1>(w), r);
+    r = MulAdd(Load(mat + 8), Splat<2>(w), r);
+    return MulAdd(Load(mat + 12), Splat<3>(w), r);
+}
+
+inline void MulMat4(const float* a, const float* b, float* out) {
+#ifdef PBR_SIMD_AVX2
+    // Two result columns per iteration
+    const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+    const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+    const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+    const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+
+    for (int c = 0; c < 16; c += 8) {
+        const __m256 cols = _mm256_loadu_ps(b + c);
+        __m256 r = _mm256_mul_ps(a0, _mm256_shuffle_ps(cols, cols, 0x00));
+        r = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(cols, cols, 0x55), r);
+        r = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(cols, cols, 0xAA), r);
+        r = _mm256_fmadd_ps(a3, _mm256_shuffle_ps(cols, cols, 0xFF), r);
+        _mm256_storeu_ps(out + c, r);
+    }
+#else
+    for (int c = 0; c < 16; c += 4)
+        Store(out + c, Combine(a, Load(b + c)));
+#endif
+}
+
+inline void Transpose(const float* mat, float* out) {
+    __m128 c0 = Load(mat), c1 = Load(mat + 4), c2 = Load(mat + 8), c3 = Load(mat + 12);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    Store(out, c0);
+    Store(out + 4, c1);
+    Store(out + 8, c2);
+    Store(out + 12, c3);
+}
+
+// 2x2 blocks packed as (m00, m01, m10, m11)
+inline __m128 Mat2Mul(__m128 a, __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+                      _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+                                 _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+
+// adj(a) * b
+inline __m128 Mat2AdjMul(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+                      _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)),
+                                 _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+}
+
+// a * adj(b)
+inline __m128 Mat2MulAdj(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+                      _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+                                 _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+
+// Block wise inverse through 2x2 adjugates. The storage order doesn't matter since
+// inverse and transpose commute. Returns false for singular matrices.
+inline bool Inverse(const float* mat, float* out) {
+    const __m128 c0 = Load(mat), c1 = Load(mat + 4), c2 = Load(mat + 8),
+                 c3 = Load(mat + 12);
+
+    const __m128 A = _mm_movelh_ps(c0, c1);
+    const __m128 B = _mm_movehl_ps(c1, c0);
+    const __m128 C = _mm_movelh_ps(c2, c3);
+    const __m128 D = _mm_movehl_ps(c3, c2);
+
+    // (|A|, |B|, |C|, |D|)
+    const __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0)),
+                   _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+        _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1)),
+                   _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0))));
+    const __m128 detA = Splat<0>(detSub);
+    const __m128 detB = Splat<1>(detSub);
+    const __m128 detC = Splat<2>(detSub);
+    const __m128 detD = Splat<3>(detSub);
+
+    const __m128 DC = Mat2AdjMul(D, C);
+    const __m128 AB = Mat2AdjMul(A, B);
+
+    __m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mul(B, DC));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mul(C, AB));
+    __m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MulAdj(D, AB));
+    __m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MulAdj(A, DC));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+    __m128 tr = _mm_mul_ps(AB, _mm_shuffle_ps(DC, DC, _MM_SHUFFLE(3, 1, 2, 0)));
+    tr = _mm_add_ps(tr, _mm_movehl_ps(tr, tr));
+    tr = _mm_add_ss(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(1, 1, 1, 1)));
+
+    const __m128 detM =
+        _mm_sub_ss(_mm_add_ss(_mm_mul_ss(detA, detD), _mm_mul_ss(detB, detC)), tr);
+    if (_mm_cvtss_f32(detM) == 0.0f)
+        return false;
+
+    const __m128 rDetM =
+        _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), Splat<0>(detM));
+
+    X = _mm_mul_ps(X, rDetM);
+    Y = _mm_mul_ps(Y, rDetM);
+    Z = _mm_mul_ps(Z, rDetM);
+    W = _mm_mul_ps(W, rDetM);
+
+    // Adjugate shuffle combined with the block layout
+    Store(out, _mm_shuffle_ps(X, Y, _MM_SHUFFLE(1, 3, 1, 3)));
+    Store(out + 4, _mm_shuffle_ps(X, Y, _MM_SHUFFLE(0, 2, 0, 2)));
+    Store(out + 8, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(1, 3, 1, 3)));
+    Store(out + 12, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(0, 2, 0, 2)));
+
+    return true;
+}
+
+// Bounds of an axis aligned box under an affine transform [Arvo 1990]
+inline void TransformBox(const float* mat, const float* boxMin, const float* boxMax,
+                         float* outMin, float* outMax) {
+    const __m128 lo = _mm_setr_ps(boxMin[0], boxMin[1], boxMin[2], 1.0f);
+    const __m128 hi = _mm_setr_ps(boxMax[0], boxMax[1], boxMax[2], 1.0f);
+
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 center = _mm_mul_ps(_mm_add_ps(lo, hi), half);
+    const __m128 extent = _mm_mul_ps(_mm_sub_ps(hi, lo), half);
+
+    const __m128 newCenter = Combine(mat, center);
+
+    __m128 newExtent = _mm_mul_ps(Abs(Load(mat)), Splat<0>(extent));
+    newExtent = MulAdd(Abs(Load(mat + 4)), Splat<1>(extent), newExtent);
+    newExtent = MulAdd(Abs(Load(mat + 8)), Splat<2>(extent), newExtent);
+
+    alignas(16) float lower[4], upper[4];
+    _mm_store_ps(lower, _mm_sub_ps(newCenter, newExtent));
+    _mm_store_ps(upper, _mm_add_ps(newCenter, newExtent));
+
+    std::copy_n(lower, 3, outMin);
+    std::copy_n(upper, 3, outMax);
+}
+
+} // namespace simd
+} // namespace math
+} // namespace pbr
+
+#endif
+
+#endif
@@ -12,64 +12,172 @@ class Vector3 {
 public:
     float x = 0, y = 0, z = 0;
 
-    Vector3() = default;
-    Vector3(float s) : x(s), y(s), z(s) {}
-    Vector3(float x, float y, float z) : x(x), y(y), z(z) {}
-    Vector3(const Vector4& v);
-
-    Vector3 operator*(float scalar) const;
-    Vector3& operator*=(float scalar);
-
-    Vector3 operator/(float scalar) const;
-    Vector3& operator/=(float scalar);
-
-    Vector3 operator+(const Vector3& v) const;
-    Vector3& operator+=(const Vector3& v);
+    constexpr Vector3() = default;
+    constexpr Vector3(float s) : x(s), y(s), z(s) {}
+    constexpr Vector3(float x, float y, float z) : x(x), y(y), z(z) {}
+    constexpr Vector3(const Vector4& v);
+
+    constexpr Vector3 operator*(float scalar) const {
+        return {scalar * x, scalar * y, scalar * z};
+    }
+
+    constexpr Vector3& operator*=(float scalar) {
+        x *= scalar;
+        y *= scalar;
+        z *= scalar;
+        return *this;
+    }
+
+    constexpr Vector3 operator/(float scalar) const {
+        return {x / scalar, y / scalar, z / scalar};
+    }
+
+    constexpr Vector3& operator/=(float scalar) {
+        x /= scalar;
+        y /= scalar;
+        z /= scalar;
+        return *this;
+    }
+
+    constexpr Vector3 operator+(const Vector3& v) const {
+        return {x + v.x, y + v.y, z + v.z};
+    }
+
+    constexpr Vector3& operator+=(const Vector3& v) {
+        x += v.x;
+        y += v.y;
+        z += v.z;
+        return *this;
+    }
+
+    constexpr Vector3 operator-(const Vector3& v) const {
+        return {x - v.x, y - v.y, z - v.z};
+    }
+
+    constexpr Vector3& operator-=(const Vector3& v) {
+        x -= v.x;
+        y -= v.y;
+        z -= v.z;
+        return *this;
+    }
+
+    constexpr Vector3 operator-() const { return {-x, -y, -z}; }
+
+    constexpr bool operator==(const Vector3& v) const {
+        return x == v.x && y == v.y && z == v.z;
+    }
+
+    constexpr bool operator!=(const Vector3& v) const { return !(*this == v); }
+
+    constexpr float operator[](unsigned int idx) const {
+        if (idx == 0)
+            return x;
+
+        if (idx == 1)
+            return y;
+
+        return z;
+    }
+
+    constexpr float& operator[](unsigned int idx) {
+        if (idx == 0)
+            return x;
+
+        if (idx == 1)
+            return y;
+
+        return z;
+    }
+
+    constexpr float lengthSqr() const { return x * x + y * y + z * z; }
+    float length() const { return std::sqrt(lengthSqr()); }
+
+    void normalize() {
+        float lenSqr = lengthSqr();
+        if (lenSqr > 0)
+            *this /= std::sqrt(lenSqr);
+    }
+
+    constexpr float min() const { return std::min(x, std::min(y, z)); }
+    constexpr float max() const { return std::max(x, std::max(y, z)); }
+
+    constexpr unsigned int maxDim() const {
+        if (x > y)
+            return x > z ? 0 : 2;
+        return y > z ? 1 : 2;
+    }
+
+    constexpr unsigned int minDim() const {
+        if (x < y)
+            return x < z ? 0 : 2;
+        return y < z ? 1 : 2;
+    }
+
+    bool isInfinite() const {
+        return std::isinf(x) || std::isinf(y) || std::isinf(z);
+    }
+
+    constexpr bool isZero() const { return x == 0 && y == 0 && z == 0; }
+};
 
-    Vector3 operator-(const Vector3& v) const;
-    Vector3& operator-=(const Vector3& v);
+std::istream& operator>>(std::istream& is, Vector3& v);
+std::ostream& operator<<(std::ostream& os, const Vector3& v);
 
-    Vector3 operator-() const;
+constexpr Vector3 operator*(float scalar, const Vector3& v) {
+    return v * scalar;
+}
 
-    bool operator==(const Vector3& v) const;
-    bool operator!=(const Vector3& v) const;
+inline Vector3 Abs(const Vector3& v) {
+    return {std::abs(v.x), std::abs(v.y), std::abs(v.z)};
+}
 
-    float operator[](unsigned int idx) const;
-    float& operator[](unsigned int idx);
+constexpr Vector3 Cross(const Vector3& v1, const Vector3& v2) {
+    return {(v1.y * v2.z) - (v1.z * v2.y), (v1.z * v2.x) - (v1.x * v2.z),
+            (v1.x * v2.y) - (v1.y * v2.x)};
+}
 
-    float lengthSqr() const;
-    float length() const;
+inline Vector3 Pow(const Vector3& v, float exp) {
+    return {std::pow(v.x, exp), std::pow(v.y, exp), std::pow(v.z, exp)};
+}
 
-    void normalize();
+inline Vector3 Normalize(const Vector3& v) {
+    float lenSqr = v.lengthSqr();
+    if (lenSqr > 0)
+        return v / std::sqrt(lenSqr);
+    return {0};
+}
 
-    float min() const;
-    float max() const;
-    unsigned int maxDim() const;
-    unsigned int minDim() const;
+constexpr Vector3 Min(const Vector3& v1, const Vector3& v2) {
+    return {std::min(v1.x, v2.x), std::min(v1.y, v2.y), std::min(v1.z, v2.z)};
+}
 
-    bool isInfinite() const;
-    bool isZero() const;
-};
+constexpr Vector3 Max(const Vector3& v1, const Vector3& v2) {
+    return {std::max(v1.x, v2.x), std::max(v1.y, v2.y), std::max(v1.z, v2.z)};
+}
 
-std::istream& operator>>(std::istream& is, Vector3& v);
-std::ostream& operator<<(std::ostream& os, const Vector3& v);
+constexpr float Dot(const Vector3& v1, const Vector3& v2) {
+    return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+}
 
-Vector3 operator*(float scalar, const Vector3& v);
+inline float AbsDot(const Vector3& v1, const Vector3& v2) {
+    return std::abs(Dot(v1, v2));
+}
 
-Vector3 Abs(const Vector3& v);
-Vector3 Cross(const Vector3& v1, const Vector3& v2);
-Vector3 Pow(const Vector3& v, float exp);
-Vector3 Normalize(const Vector3& v);
-Vector3 Min(const Vector3& v1, const Vector3& v2);
-Vector3 Max(const Vector3& v1, const Vector3& v2);
+inline float Distance(const Vector3& v1, const Vector3& v2) {
+    return (v1 - v2).length();
+}
 
-float Distance(const Vector3& v1, const Vector3& v2);
-float Dot(const Vector3& v1, const Vector3& v2);
-float AbsDot(const Vector3& v1, const Vector3& v2);
+inline void BasisFromVector(const Vector3& v1, Vector3* v2, Vector3* v3) {
+    // Reference: [Duff et. al, 2017] - "Building an Orthonormal Basis, Revisited"
+    const float sign = std::copysign(1.0f, v1.z);
+    const float a = -1.0f / (sign + v1.z);
+    const float b = v1.x * v1.y * a;
 
-void BasisFromVector(const Vector3& v1, Vector3* v2, Vector3* v3);
+    *v2 = Vector3(1.0f + sign * v1.x * v1.x * a, sign * b, -sign * v1.x);
+    *v3 = Vector3(b, sign + v1.y * v1.y * a, -v1.y);
+}
 
 } // namespace math
 } // namespace pbr
 
-#endif
\ No newline at end of file
+#endif
@@ -2,65 +2,157 @@
 #define PBR_VECTOR4_H
 
 #include <PBR.h>
+#include <Vector3.h>
 
 namespace pbr {
 namespace math {
 
-class Vector3;
-
 class Vector4 {
 public:
     float x = 0, y = 0, z = 0, w = 1;
 
-    Vector4() = default;
-    Vector4(float s) : x(s), y(s), z(s), w(1) {}
-    Vector4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
-    Vector4(const Vector3& v, float w);
-
-    Vector4 operator*(float scalar) const;
-    Vector4& operator*=(float scalar);
-
-    Vector4 operator/(float scalar) const;
-    Vector4& operator/=(float scalar);
-
-    Vector4 operator+(const Vector4& v) const;
-    Vector4& operator+=(const Vector4& v);
-
-    Vector4 operator-(const Vector4& v) const;
-    Vector4& operator-=(const Vector4& v);
-
-    Vector4 operator-() const;
-
-    bool operator==(const Vector4& v) const;
-    bool operator!=(const Vector4& v) const;
+    constexpr Vector4() = default;
+    constexpr Vector4(float s) : x(s), y(s), z(s), w(1) {}
+    constexpr Vector4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    constexpr Vector4(const Vector3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+
+    constexpr Vector4 operator*(float scalar) const {
+        return {scalar * x, scalar * y, scalar * z, scalar * w};
+    }
+
+    constexpr Vector4& operator*=(float scalar) {
+        x *= scalar;
+        y *= scalar;
+        z *= scalar;
+        w *= scalar;
+        return *this;
+    }
+
+    constexpr Vector4 operator/(float scalar) const {
+        return {x / scalar, y / scalar, z / scalar, w / scalar};
+    }
+
+    constexpr Vector4& operator/=(float scalar) {
+        x /= scalar;
+        y /= scalar;
+        z /= scalar;
+        w /= scalar;
+        return *this;
+    }
+
+    constexpr Vector4 operator+(const Vector4& v) const {
+        return {x + v.x, y + v.y, z + v.z, w + v.w};
+    }
+
+    constexpr Vector4& operator+=(const Vector4& v) {
+        x += v.x;
+        y += v.y;
+        z += v.z;
+        w += v.w;
+        return *this;
+    }
+
+    constexpr Vector4 operator-(const Vector4& v) const {
+        return {x - v.x, y - v.y, z - v.z, w - v.w};
+    }
+
+    constexpr Vector4& operator-=(const Vector4& v) {
+        x -= v.x;
+        y -= v.y;
+        z -= v.z;
+        w -= v.w;
+        return *this;
+    }
+
+    constexpr Vector4 operator-() const { return {-x, -y, -z, -w}; }
+
+    constexpr bool operator==(const Vector4& v) const {
+        return x == v.x && y == v.y && z == v.z && w == v.w;
+    }
+
+    constexpr bool operator!=(const Vector4& v) const { return !(*this == v); }
+
+    constexpr float operator[](unsigned int idx) const {
+        if (idx == 0)
+            return x;
+
+        if (idx == 1)
+            return y;
+
+        if (idx == 2)
+            return z;
+
+        return w;
+    }
+
+    constexpr float& operator[](unsigned int idx) {
+        if (idx == 0)
+            return x;
+
+        if (idx == 1)
+            return y;
+
+        if (idx == 2)
+            return z;
+
+        return w;
+    }
+
+    constexpr float lengthSqr() const { return x * x + y * y + z * z + w * w; }
+    float length() const { return std::sqrt(lengthSqr()); }
+
+    void normalize() {
+        float lenSqr = lengthSqr();
+        if (lenSqr > 0)
+            *this /= std::sqrt(lenSqr);
+    }
+
+    constexpr float min() const { return std::min(x, std::min(y, std::min(z, w))); }
+    constexpr float max() const { return std::max(x, std::max(y, std::max(z, w))); }
+
+    constexpr bool isZero() const { return x == 0 && y == 0 && z == 0 && w == 0; }
+};
 
-    float operator[](unsigned int idx) const;
-    float& operator[](unsigned int idx);
+// Projects homogeneous points, directions (w = 0) are kept as is
+constexpr Vector3::Vector3(const Vector4& v) : x(v.x), y(v.y), z(v.z) {
+    if (v.w != 0) {
+        x /= v.w;
+        y /= v.w;
+        z /= v.w;
+    }
+}
 
-    float lengthSqr() const;
-    float length() const;
+std::istream& operator>>(std::istream& is, Vector4& v);
+std::ostream& operator<<(std::ostream& os, const Vector4& v);
 
-    void normalize();
+constexpr Vector4 operator*(float scalar, const Vector4& v) {
+    return v * scalar;
+}
 
-    float min() const;
-    float max() const;
+inline Vector4 Abs(const Vector4& v) {
+    return {std::abs(v.x), std::abs(v.y), std::abs(v.z), std::abs(v.w)};
+}
 
-    bool isZero() const;
-};
-
-std::istream& operator>>(std::istream& is, Vector4& v);
-std::ostream& operator<<(std::ostream& os, const Vector4& v);
+inline Vector4 Normalize(const Vector4& v) {
+    float lenSqr = v.lengthSqr();
+    if (lenSqr > 0)
+        return v / std::sqrt(lenSqr);
+    return {0};
+}
 
-Vector4 operator*(float scalar, const Vector4& v);
+constexpr float Dot(const Vector4& v1, const Vector4& v2) {
+    return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w;
+}
 
-Vector4 Abs(const Vector4& v);
-Vector4 Normalize(const Vector4& v);
+inline float AbsDot(const Vector4& v1, const Vector4& v2) {
+    return std::abs(Dot(v1, v2));
+}
 
-float Distance(const Vector4& v1, const Vector4& v2);
-float Dot(const Vector4& v1, const Vector4& v2);
-float AbsDot(const Vector4& v1, const Vector4& v2);
+inline float Distance(const Vector4& v1, const Vector4& v2) {
+    return (v1 - v2).length();
+}
 
 } // namespace math
 } // namespace pbr
 
-#endif
\ No newline at end of file
+#endif
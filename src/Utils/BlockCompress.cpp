@@ -0,0 +1,557 @@
+#include <BlockCompress.h>
+
+#include <JobSystem.h>
+#include <PixelConvert.h>
+
+#include <bit>
+#include <cstring>
+
+using namespace pbr;
+
+namespace {
+
+// Blocks per job
+constexpr std::size_t GrainBlocks = 256;
+
+// BC6H and BC7 interpolation weights of 4 bit indices, out of 64
+constexpr std::array<int, 16> Weights4{0,  4,  9,  13, 17, 21, 26, 30,
+                                       34, 38, 43, 47, 51, 55, 60, 64};
+
+using Pixel = std::array<float, 4>;
+using Block = std::array<Pixel, 16>;
+using Indices = std::array<int, 16>;
+
+using EncodeFunc = void (*)(const Block& block, std::byte* out);
+
+// Fills a 128 bit block from its least significant bit
+class BitWriter {
+public:
+    void write(std::uint32_t value, int bits) {
+        for (int b = 0; b < bits; ++b, ++pos)
+            if ((value >> b) & 1)
+                words[pos / 64] |= std::uint64_t{1} << (pos % 64);
+    }
+
+    void store(std::byte* out) const { std::memcpy(out, words.data(), sizeof(words)); }
+
+private:
+    std::array<std::uint64_t, 2> words{};
+    int pos = 0;
+};
+
+// --------------------------------------------------------------------------------------
+//      Endpoint fitting
+// --------------------------------------------------------------------------------------
+template<int N>
+using Vec = std::array<float, N>;
+
+template<int N>
+Vec<N> Mean(const Block& block) {
+    Vec<N> mean{};
+    for (const Pixel& px : block)
+        for (int c = 0; c < N; ++c)
+            mean[c] += px[c] / 16.0f;
+    return mean;
+}
+
+// Direction of largest variance, by power iteration on the covariance
+template<int N>
+Vec<N> PrincipalAxis(const Block& block, const Vec<N>& mean) {
+    std::array<Vec<N>, N> cov{};
+    for (const Pixel& px : block)
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                cov[i][j] += (px[i] - mean[i]) * (px[j] - mean[j]);
+
+    // Starting from the row with the largest variance avoids a start orthogonal to it
+    int start = 0;
+    for (int i = 1; i < N; ++i)
+        if (cov[i][i] > cov[start][start])
+            start = i;
+
+    Vec<N> axis = cov[start];
+    for (int iter = 0; iter < 8; ++iter) {
+        Vec<N> next{};
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                next[i] += cov[i][j] * axis[j];
+
+        float length = 0.0f;
+        for (float v : next)
+            length += v * v;
+        length = std::sqrt(length);
+        if (length < 1e-12f)
+            break;
+
+        for (int i = 0; i < N; ++i)
+            axis[i] = next[i] / length;
+    }
+
+    return axis;
+}
+
+// Ends of the segment along the principal axis covering every pixel
+template<int N>
+std::pair<Vec<N>, Vec<N>> FitLine(const Block& block) {
+    const Vec<N> mean = Mean<N>(block);
+    const Vec<N> axis = PrincipalAxis<N>(block, mean);
+
+    float tMin = 0.0f, tMax = 0.0f;
+    for (const Pixel& px : block) {
+        float t = 0.0f;
+        for (int c = 0; c < N; ++c)
+            t += (px[c] - mean[c]) * axis[c];
+        tMin = std::min(tMin, t);
+        tMax = std::max(tMax, t);
+    }
+
+    Vec<N> lo, hi;
+    for (int c = 0; c < N; ++c) {
+        lo[c] = mean[c] + axis[c] * tMin;
+        hi[c] = mean[c] + axis[c] * tMax;
+    }
+
+    return {lo, hi};
+}
+
+// Endpoints minimizing the squared error of the pixels for fixed indices, where
+// weights[i] is how far index i is from the first endpoint towards the second
+template<int N>
+bool RefitLine(const Block& block, const Indices& indices, const float* weights,
+               Vec<N>& e0, Vec<N>& e1) {
+    float a = 0.0f, b = 0.0f, c = 0.0f;
+    Vec<N> x0{}, x1{};
+    for (int i = 0; i < 16; ++i) {
+        const float w = weights[indices[i]];
+        a += (1.0f - w) * (1.0f - w);
+        b += (1.0f - w) * w;
+        c += w * w;
+        for (int ch = 0; ch < N; ++ch) {
+            x0[ch] += (1.0f - w) * block[i][ch];
+            x1[ch] += w * block[i][ch];
+        }
+    }
+
+    const float det = a * c - b * b;
+    if (std::abs(det) < 1e-6f)
+        return false;
+
+    for (int ch = 0; ch < N; ++ch) {
+        e0[ch] = (c * x0[ch] - b * x1[ch]) / det;
+        e1[ch] = (a * x1[ch] - b * x0[ch]) / det;
+    }
+
+    return true;
+}
+
+// Picks the closest palette entry for every pixel, returns the total squared error
+template<int N, std::size_t Size>
+float PickIndices(const Block& block, const std::array<Vec<N>, Size>& palette,
+                  Indices& indices) {
+    float total = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        float best = std::numeric_limits<float>::max();
+        for (std::size_t p = 0; p < Size; ++p) {
+            float err = 0.0f;
+            for (int c = 0; c < N; ++c) {
+                const float d = block[i][c] - palette[p][c];
+                err += d * d;
+            }
+
+            if (err < best) {
+                best = err;
+                indices[i] = static_cast<int>(p);
+            }
+        }
+
+        total += best;
+    }
+
+    return total;
+}
+
+// --------------------------------------------------------------------------------------
+//      BC1
+// --------------------------------------------------------------------------------------
+std::uint16_t To565(const Vec<3>& color) {
+    auto quantize = [](float v, int max) {
+        return static_cast<std::uint16_t>(std::clamp(v, 0.0f, 1.0f) * max + 0.5f);
+    };
+
+    return quantize(color[0], 31) << 11 | quantize(color[1], 63) << 5 |
+           quantize(color[2], 31);
+}
+
+Vec<3> From565(std::uint16_t color) {
+    const int r = color >> 11, g = (color >> 5) & 63, b = color & 31;
+    return {((r << 3) | (r >> 2)) / 255.0f, ((g << 2) | (g >> 4)) / 255.0f,
+            ((b << 3) | (b >> 2)) / 255.0f};
+}
+
+struct BC1Block {
+    std::uint16_t c0 = 0, c1 = 0;
+    Indices indices{};
+    float error = std::numeric_limits<float>::max();
+};
+
+BC1Block FitBC1(const Block& block, const Vec<3>& e0, const Vec<3>& e1) {
+    BC1Block bc1;
+    bc1.c0 = To565(e0);
+    bc1.c1 = To565(e1);
+
+    // Four color mode needs c0 > c1, equal endpoints use index 0 everywhere
+    if (bc1.c0 < bc1.c1)
+        std::swap(bc1.c0, bc1.c1);
+
+    const Vec<3> p0 = From565(bc1.c0), p1 = From565(bc1.c1);
+    std::array<Vec<3>, 4> palette{p0, p1};
+    for (int c = 0; c < 3; ++c) {
+        palette[2][c] = (2.0f * p0[c] + p1[c]) / 3.0f;
+        palette[3][c] = (p0[c] + 2.0f * p1[c]) / 3.0f;
+    }
+
+    if (bc1.c0 == bc1.c1) {
+        bc1.indices.fill(0);
+        std::array<Vec<3>, 1> single{p0};
+        bc1.error = PickIndices<3>(block, single, bc1.indices);
+        return bc1;
+    }
+
+    bc1.error = PickIndices<3>(block, palette, bc1.indices);
+    return bc1;
+}
+
+void EncodeBC1(const Block& block, std::byte* out) {
+    auto [lo, hi] = FitLine<3>(block);
+    BC1Block best = FitBC1(block, hi, lo);
+
+    constexpr std::array<float, 4> weights{0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+    if (RefitLine<3>(block, best.indices, weights.data(), hi, lo)) {
+        const BC1Block refit = FitBC1(block, hi, lo);
+        if (refit.error < best.error)
+            best = refit;
+    }
+
+    std::uint32_t bits = 0;
+    for (int i = 0; i < 16; ++i)
+        bits |= static_cast<std::uint32_t>(best.indices[i]) << (2 * i);
+
+    std::memcpy(out, &best.c0, 2);
+    std::memcpy(out + 2, &best.c1, 2);
+    std::memcpy(out + 4, &bits, 4);
+}
+
+// --------------------------------------------------------------------------------------
+//      BC4 and BC5
+// --------------------------------------------------------------------------------------
+void EncodeBC4Channel(const Block& block, int channel, std::byte* out) {
+    float lo = 255.0f, hi = 0.0f;
+    std::array<float, 16> values;
+    for (int i = 0; i < 16; ++i) {
+        values[i] = std::clamp(block[i][channel], 0.0f, 1.0f) * 255.0f;
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+    }
+
+    // Eight value mode, r0 > r1. Index 0 is r0, 1 is r1 and 2 to 7 step from r0 to r1.
+    const auto r0 = static_cast<std::uint8_t>(hi + 0.5f);
+    const auto r1 = static_cast<std::uint8_t>(lo + 0.5f);
+
+    std::uint64_t bits = 0;
+    if (r0 > r1) {
+        for (int i = 0; i < 16; ++i) {
+            const float t = (r0 - values[i]) / (r0 - r1) * 7.0f;
+            const int step = std::clamp(static_cast<int>(t + 0.5f), 0, 7);
+            const int index = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+            bits |= static_cast<std::uint64_t>(index) << (3 * i);
+        }
+    }
+
+    out[0] = std::byte{r0};
+    out[1] = std::byte{r1};
+    for (int b = 0; b < 6; ++b)
+        out[2 + b] = static_cast<std::byte>(bits >> (8 * b));
+}
+
+void EncodeBC4(const Block& block, std::byte* out) {
+    EncodeBC4Channel(block, 0, out);
+}
+
+void EncodeBC5(const Block& block, std::byte* out) {
+    EncodeBC4Channel(block, 0, out);
+    EncodeBC4Channel(block, 1, out + 8);
+}
+
+// --------------------------------------------------------------------------------------
+//      BC7, mode 6: one subset, RGBA endpoints of 7 bits plus a p-bit, 4 bit indices
+// --------------------------------------------------------------------------------------
+struct BC7Endpoint {
+    std::array<int, 4> q{};
+    int pBit = 0;
+
+    int value(int c) const { return (q[c] << 1) | pBit; }
+};
+
+BC7Endpoint QuantizeBC7(const Vec<4>& color) {
+    BC7Endpoint best;
+    float bestError = std::numeric_limits<float>::max();
+
+    for (int p = 0; p < 2; ++p) {
+        BC7Endpoint e;
+        e.pBit = p;
+
+        float error = 0.0f;
+        for (int c = 0; c < 4; ++c) {
+            const float v = std::clamp(color[c], 0.0f, 1.0f) * 255.0f;
+            e.q[c] = std::clamp(static_cast<int>((v - p) / 2.0f + 0.5f), 0, 127);
+            error += (e.value(c) - v) * (e.value(c) - v);
+        }
+
+        if (error < bestError) {
+            bestError = error;
+            best = e;
+        }
+    }
+
+    return best;
+}
+
+struct BC7Block {
+    BC7Endpoint e0, e1;
+    Indices indices{};
+    float error = std::numeric_limits<float>::max();
+};
+
+BC7Block FitBC7(const Block& block, const Vec<4>& e0, const Vec<4>& e1) {
+    BC7Block bc7;
+    bc7.e0 = QuantizeBC7(e0);
+    bc7.e1 = QuantizeBC7(e1);
+
+    std::array<Vec<4>, 16> palette;
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 4; ++c) {
+            const int w = Weights4[i];
+            const int v = ((64 - w) * bc7.e0.value(c) + w * bc7.e1.value(c) + 32) >> 6;
+            palette[i][c] = v / 255.0f;
+        }
+
+    bc7.error = PickIndices<4>(block, palette, bc7.indices);
+    return bc7;
+}
+
+void EncodeBC7(const Block& block, std::byte* out) {
+    auto [lo, hi] = FitLine<4>(block);
+    BC7Block best = FitBC7(block, lo, hi);
+
+    std::array<float, 16> weights;
+    for (int i = 0; i < 16; ++i)
+        weights[i] = Weights4[i] / 64.0f;
+
+    if (RefitLine<4>(block, best.indices, weights.data(), lo, hi)) {
+        const BC7Block refit = FitBC7(block, lo, hi);
+        if (refit.error < best.error)
+            best = refit;
+    }
+
+    // The most significant bit of the first index is implicitly 0
+    if (best.indices[0] >= 8) {
+        std::swap(best.e0, best.e1);
+        for (int& index : best.indices)
+            index = 15 - index;
+    }
+
+    BitWriter bits;
+    bits.write(1 << 6, 7);
+    for (int c = 0; c < 4; ++c) {
+        bits.write(best.e0.q[c], 7);
+        bits.write(best.e1.q[c], 7);
+    }
+    bits.write(best.e0.pBit, 1);
+    bits.write(best.e1.pBit, 1);
+
+    for (int i = 0; i < 16; ++i)
+        bits.write(best.indices[i], i == 0 ? 3 : 4);
+
+    bits.store(out);
+}
+
+// --------------------------------------------------------------------------------------
+//      BC6H, mode 11: one region, 10 bit RGB endpoints, 4 bit indices. Pixels are fit on
+//      the bits of their half floats, which is how the format interpolates them.
+// --------------------------------------------------------------------------------------
+int UnquantizeBC6H(int q) {
+    if (q == 0)
+        return 0;
+    if (q == 1023)
+        return 0xFFFF;
+    return ((q << 16) + 0x8000) >> 10;
+}
+
+// Half float bits of an interpolated, unquantized value
+int FinishBC6H(int v) {
+    return (v * 31) >> 6;
+}
+
+int QuantizeBC6H(float half) {
+    // Inverse of FinishBC6H(UnquantizeBC6H(q)), which is about 31 q + 15.5
+    const auto guess =
+        std::clamp(static_cast<int>((half - 15.5f) / 31.0f + 0.5f), 0, 1023);
+
+    int best = guess;
+    for (int q = std::max(guess - 1, 0); q <= std::min(guess + 1, 1023); ++q)
+        if (std::abs(FinishBC6H(UnquantizeBC6H(q)) - half) <
+            std::abs(FinishBC6H(UnquantizeBC6H(best)) - half))
+            best = q;
+
+    return best;
+}
+
+struct BC6HBlock {
+    std::array<int, 3> e0{}, e1{};
+    Indices indices{};
+    float error = std::numeric_limits<float>::max();
+};
+
+BC6HBlock FitBC6H(const Block& block, const Vec<3>& e0, const Vec<3>& e1) {
+    BC6HBlock bc6;
+    for (int c = 0; c < 3; ++c) {
+        bc6.e0[c] = QuantizeBC6H(e0[c]);
+        bc6.e1[c] = QuantizeBC6H(e1[c]);
+    }
+
+    std::array<Vec<3>, 16> palette;
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 3; ++c) {
+            const int a = UnquantizeBC6H(bc6.e0[c]), b = UnquantizeBC6H(bc6.e1[c]);
+            const int w = Weights4[i];
+            const int v = FinishBC6H(((64 - w) * a + w * b + 32) >> 6);
+            palette[i][c] = static_cast<float>(v);
+        }
+
+    bc6.error = PickIndices<3>(block, palette, bc6.indices);
+    return bc6;
+}
+
+void EncodeBC6H(const Block& pixels, std::byte* out) {
+    // Positive halves order like their bits
+    constexpr float MaxHalf = 65504.0f;
+    Block block;
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 3; ++c) {
+            const float v = std::isnan(pixels[i][c]) ? 0.0f : pixels[i][c];
+            const Half half{std::clamp(v, 0.0f, MaxHalf)};
+            block[i][c] = std::bit_cast<std::uint16_t>(half);
+        }
+
+    auto [lo, hi] = FitLine<3>(block);
+    BC6HBlock best = FitBC6H(block, lo, hi);
+
+    std::array<float, 16> weights;
+    for (int i = 0; i < 16; ++i)
+        weights[i] = Weights4[i] / 64.0f;
+
+    if (RefitLine<3>(block, best.indices, weights.data(), lo, hi)) {
+        const BC6HBlock refit = FitBC6H(block, lo, hi);
+        if (refit.error < best.error)
+            best = refit;
+    }
+
+    if (best.indices[0] >= 8) {
+        std::swap(best.e0, best.e1);
+        for (int& index : best.indices)
+            index = 15 - index;
+    }
+
+    BitWriter bits;
+    bits.write(0x03, 5);
+    for (int c = 0; c < 3; ++c)
+        bits.write(best.e0[c], 10);
+    for (int c = 0; c < 3; ++c)
+        bits.write(best.e1[c], 10);
+
+    for (int i = 0; i < 16; ++i)
+        bits.write(best.indices[i], i == 0 ? 3 : 4);
+
+    bits.store(out);
+}
+
+EncodeFunc Encoder(PixelFormat format) {
+    using enum PixelFormat;
+    switch (format) {
+    case BC1:
+        return EncodeBC1;
+    case BC4:
+        return EncodeBC4;
+    case BC5:
+        return EncodeBC5;
+    case BC6H:
+        return EncodeBC6H;
+    case BC7:
+        return EncodeBC7;
+    default:
+        FATAL("Pixel format isn't block compressed.");
+    }
+}
+
+void CompressLevel(const Image& image, int lvl, PixelFormat format, std::byte* out) {
+    const ImageFormat fmt = image.format(lvl);
+    const std::size_t numPixels = TotalPixels(fmt);
+
+    // Images without alpha are opaque
+    std::vector<Pixel> pixels(numPixels);
+    ConvertPixels(image.data(lvl), {fmt.pFmt, fmt.nChannels},
+                  reinterpret_cast<std::byte*>(pixels.data()), {PixelFormat::F32, 4},
+                  numPixels);
+    if (fmt.nChannels == 1 || fmt.nChannels == 3)
+        for (Pixel& px : pixels)
+            px[3] = 1.0f;
+
+    const EncodeFunc encode = Encoder(format);
+    const int blockSize = BlockSize(format);
+    const int blocksX = (fmt.width + 3) / 4;
+    const int blocksY = (fmt.height + 3) / 4;
+
+    const std::size_t grain = std::max<std::size_t>(1, GrainBlocks / blocksX);
+    JobSystem::get().parallelFor(blocksY, grain, [&](std::size_t begin, std::size_t end) {
+        Block block;
+        for (auto by = static_cast<int>(begin); by < static_cast<int>(end); ++by) {
+            for (int bx = 0; bx < blocksX; ++bx) {
+                // Partial blocks at the edges repeat the last row and column
+                for (int i = 0; i < 16; ++i) {
+                    const int x = std::min(bx * 4 + i % 4, fmt.width - 1);
+                    const int y = std::min(by * 4 + i / 4, fmt.height - 1);
+                    block[i] = pixels[std::size_t(y) * fmt.width + x];
+                }
+
+                encode(block, out + (std::size_t(by) * blocksX + bx) * blockSize);
+            }
+        }
+    });
+}
+
+} // namespace
+
+Image pbr::CompressImage(const Image& image, PixelFormat format) {
+    const ImageFormat fmt = image.format();
+    DCHECK(IsCompressed(format) && !IsCompressed(fmt.pFmt));
+
+    const ImageFormat compressedFmt{format, fmt.width, fmt.height,
+                                    CompressedChannels(format)};
+    Image compressed{compressedFmt, image.numLevels()};
+    for (int lvl = 0; lvl < image.numLevels(); ++lvl)
+        CompressLevel(image, lvl, format, compressed.data(lvl));
+
+    return compressed;
+}
+
+CubeImage pbr::CompressCube(const CubeImage& cube, PixelFormat format) {
+    const ImageFormat fmt = cube.format();
+    const ImageFormat compressedFmt{format, fmt.width, fmt.height,
+                                    CompressedChannels(format)};
+
+    CubeImage compressed{compressedFmt, cube.numLevels()};
+    for (int face = 0; face < 6; ++face)
+        compressed[face] = CompressImage(cube[face], format);
+
+    return compressed;
+}
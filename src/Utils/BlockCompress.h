@@ -0,0 +1,18 @@
+#ifndef PBR_BLOCKCOMPRESS_H
+#define PBR_BLOCKCOMPRESS_H
+
+#include <Image.h>
+
+namespace pbr {
+
+// Compresses every level of an image into 4x4 blocks of a BCn format. BC1 and BC7 take
+// the color channels, BC7 alpha as well (opaque if the image has none), BC4 the first
+// channel, BC5 the first two and BC6H positive half floats. Each block is fit along the
+// principal axis of its pixels with a single partition, and blocks are encoded in
+// parallel by the job system.
+Image CompressImage(const Image& image, PixelFormat format);
+CubeImage CompressCube(const CubeImage& cube, PixelFormat format);
+
+} // namespace pbr
+
+#endif
@@ -1,5 +1,8 @@
 #include <Image.h>
 
+#include <MappedFile.h>
+#include <PixelConvert.h>
+
 using namespace pbr;
 
 namespace {
@@ -28,6 +31,38 @@ int pbr::ComponentSize(PixelFormat pFmt) {
     }
 }
 
+int pbr::BlockSize(PixelFormat pFmt) {
+    using enum PixelFormat;
+    switch (pFmt) {
+    case BC1:
+    case BC4:
+        return 8;
+    case BC5:
+    case BC6H:
+    case BC7:
+        return 16;
+    default:
+        FATAL("Pixel format isn't block compressed.");
+    }
+}
+
+int pbr::CompressedChannels(PixelFormat pFmt) {
+    using enum PixelFormat;
+    switch (pFmt) {
+    case BC4:
+        return 1;
+    case BC5:
+        return 2;
+    case BC1:
+    case BC6H:
+        return 3;
+    case BC7:
+        return 4;
+    default:
+        FATAL("Pixel format isn't block compressed.");
+    }
+}
+
 Image::Image(ImageFormat format, int levels) : fmt(format), levels(levels) {
     resizeBuffer();
 }
@@ -40,13 +75,8 @@ Image::Image(ImageFormat format, PixelVal fillVal, int levels)
 
 Image::Image(ImageFormat format, const std::byte* imgPtr, int levels)
     : fmt(format), levels(levels) {
-
-    auto numElems = TotalPixels(format, levels) * fmt.nChannels;
-    auto compSize = ComponentSize(fmt.pFmt);
-
     resizeBuffer();
-
-    std::copy(imgPtr, imgPtr + numElems * compSize, getPtr());
+    std::copy(imgPtr, imgPtr + size(), getPtr());
 }
 
 Image::Image(ImageFormat format, const float* imgPtr, int levels)
@@ -67,23 +97,32 @@ Image::Image(ImageFormat format, Image&& srcImg) : fmt(format), levels(srcImg.le
     else {
         resizeBuffer();
         for (int lvl = 0; lvl < levels; ++lvl)
-            copy(srcImg, lvl);
+            copy(srcImg, lvl, lvl);
     }
 }
 
+Image::Image(ImageFormat format, std::shared_ptr<const MappedFile> mapping,
+             std::size_t offset, int levels)
+    : file(std::move(mapping)), fmt(format), levels(levels) {
+    CHECK_LE(offset + size(), file->size());
+    mapped = file->data().data() + offset;
+}
+
 float Image::channel(int x, int y, int c, int lvl) const {
+    DCHECK(!IsCompressed(fmt.pFmt));
     if (c >= fmt.nChannels)
         return 0;
 
     auto offset = pixelOffset(x, y, lvl) * fmt.nChannels;
+    auto ptr = getPtr();
 
     switch (fmt.pFmt) {
     case PixelFormat::U8:
-        return EncodeU8(p8[offset + c]);
+        return EncodeU8(reinterpret_cast<const std::uint8_t*>(ptr)[offset + c]);
     case PixelFormat::F16:
-        return p16[offset + c];
+        return reinterpret_cast<const Half*>(ptr)[offset + c];
     case PixelFormat::F32:
-        return p32[offset + c];
+        return reinterpret_cast<const float*>(ptr)[offset + c];
     default:
         FATAL("Unknown pixel format.");
     }
@@ -92,6 +131,8 @@ float Image::channel(int x, int y, int c, int lvl) const {
 void Image::setChannel(float val, int x, int y, int c, int lvl) {
     assert(c < fmt.nChannels);
 
+    detach();
+
     auto offset = pixelOffset(x, y, lvl) * fmt.nChannels;
 
     switch (fmt.pFmt) {
@@ -122,12 +163,8 @@ void Image::setPixel(const PixelVal& px, int x, int y, int lvl) {
 }
 
 void Image::fill(PixelVal val) {
-    for (int lvl = 0; lvl < levels; ++lvl) {
-        const auto lvlFmt = format(lvl);
-        for (int y = 0; y < lvlFmt.height; ++y)
-            for (int x = 0; x < lvlFmt.width; ++x)
-                setPixel(val, x, y, lvl);
-    }
+    // Levels are contiguous
+    FillPixels(data(), {fmt.pFmt, fmt.nChannels}, val, TotalPixels(fmt, levels));
 }
 
 void Image::copy(const Image& srcImg, int toLvl, int fromLvl) {
@@ -136,14 +173,33 @@ void Image::copy(const Image& srcImg, int toLvl, int fromLvl) {
 }
 
 void Image::copy(Extents ext, const Image& srcImg, int toLvl, int fromLvl) {
-    const auto toX = ext.toX, toY = ext.toY;
-    const auto fromX = ext.fromX, fromY = ext.fromY;
+    const auto toFmt = format(toLvl);
+    const auto fromFmt = srcImg.format(fromLvl);
+
+    DCHECK(!IsCompressed(toFmt.pFmt) && !IsCompressed(fromFmt.pFmt));
+    DCHECK(ext.toX + ext.sizeX <= toFmt.width && ext.toY + ext.sizeY <= toFmt.height);
+    DCHECK(ext.fromX + ext.sizeX <= fromFmt.width &&
+           ext.fromY + ext.sizeY <= fromFmt.height);
+
+    const PixelLayout toLayout{toFmt.pFmt, toFmt.nChannels};
+    const PixelLayout fromLayout{fromFmt.pFmt, fromFmt.nChannels};
+    const std::size_t toPixel = ComponentSize(toFmt.pFmt) * toFmt.nChannels;
+    const std::size_t fromPixel = ComponentSize(fromFmt.pFmt) * fromFmt.nChannels;
+
+    std::byte* dst = data(toLvl) + (ext.toY * toFmt.width + ext.toX) * toPixel;
+    const std::byte* src =
+        srcImg.data(fromLvl) + (ext.fromY * fromFmt.width + ext.fromX) * fromPixel;
+
+    // Whole rows on both sides are one contiguous run
+    if (ext.sizeX == toFmt.width && ext.sizeX == fromFmt.width) {
+        ConvertPixels(src, fromLayout, dst, toLayout, std::size_t(ext.sizeX) * ext.sizeY);
+        return;
+    }
 
     for (int y = 0; y < ext.sizeY; ++y) {
-        for (int x = 0; x < ext.sizeX; ++x) {
-            const auto& px = srcImg.pixel(fromX + x, fromY + y, fromLvl);
-            setPixel(px, toX + x, toY + y, toLvl);
-        }
+        ConvertPixels(src, fromLayout, dst, toLayout, ext.sizeX);
+        src += fromFmt.width * fromPixel;
+        dst += toFmt.width * toPixel;
     }
 }
 
@@ -151,14 +207,21 @@ Image Image::convertTo(ImageFormat newFmt, int nLvls) const {
     if (fmt.pFmt == newFmt.pFmt && fmt.nChannels == newFmt.nChannels && nLvls == levels)
         return *this;
 
+    // Levels this image doesn't have are left zeroed
     Image newImg{newFmt, nLvls};
-    for (int lvl = 0; lvl < nLvls; ++lvl)
-        newImg.copy(*this, lvl);
+    for (int lvl = 0; lvl < std::min(nLvls, levels); ++lvl)
+        newImg.copy(*this, lvl, lvl);
 
     return newImg;
 }
 
 void Image::resizeBuffer() {
+    // Blocks are kept as bytes
+    if (IsCompressed(fmt.pFmt)) {
+        p8.resize(size());
+        return;
+    }
+
     auto numElems = TotalPixels(fmt, levels) * fmt.nChannels;
     switch (fmt.pFmt) {
     case PixelFormat::U8:
@@ -175,6 +238,18 @@ void Image::resizeBuffer() {
     }
 }
 
+void Image::detach() {
+    if (!mapped)
+        return;
+
+    // Keep the mapping alive until the pixels are copied
+    const auto mapping = std::move(file);
+    const std::byte* src = std::exchange(mapped, nullptr);
+
+    resizeBuffer();
+    std::copy(src, src + size(), getPtr());
+}
+
 std::size_t Image::pixelOffset(int x, int y, int lvl) const {
     auto nPixels = TotalPixels(fmt, lvl);
     return nPixels + (y * ResizeLvl(fmt.width, lvl) + x);
@@ -191,9 +266,17 @@ std::byte* Image::data(int lvl) {
 }
 
 const std::byte* Image::getPtr() const {
+    if (mapped)
+        return mapped;
+
     using enum PixelFormat;
     switch (fmt.pFmt) {
     case U8:
+    case BC1:
+    case BC4:
+    case BC5:
+    case BC6H:
+    case BC7:
         return reinterpret_cast<const std::byte*>(p8.data());
     case F16:
         return reinterpret_cast<const std::byte*>(p16.data());
@@ -205,9 +288,16 @@ const std::byte* Image::getPtr() const {
 }
 
 std::byte* Image::getPtr() {
+    detach();
+
     using enum PixelFormat;
     switch (fmt.pFmt) {
     case U8:
+    case BC1:
+    case BC4:
+    case BC5:
+    case BC6H:
+    case BC7:
         return reinterpret_cast<std::byte*>(p8.data());
     case F16:
         return reinterpret_cast<std::byte*>(p16.data());
@@ -219,20 +309,18 @@ std::byte* Image::getPtr() {
 }
 
 void Image::flipY() {
-    Image flipImg{format(), levels};
+    DCHECK(!IsCompressed(fmt.pFmt));
 
     for (int lvl = 0; lvl < levels; ++lvl) {
         const auto lvlFmt = format(lvl);
+        const std::size_t rowSize = ImageSize({fmt.pFmt, lvlFmt.width, 1, fmt.nChannels});
 
-        for (int x = 0; x < lvlFmt.width; ++x) {
-            for (int y = 0; y < lvlFmt.height; ++y) {
-                auto px = pixel(x, lvlFmt.height - 1 - y, lvl);
-                flipImg.setPixel(px, x, y, lvl);
-            }
-        }
+        // Swaps whole rows in place
+        std::byte* top = data(lvl);
+        std::byte* bottom = top + (lvlFmt.height - 1) * rowSize;
+        for (; top < bottom; top += rowSize, bottom -= rowSize)
+            std::swap_ranges(top, top + rowSize, bottom);
     }
-
-    *this = std::move(flipImg);
 }
 
 ImageView::ImageView(const Image& image)
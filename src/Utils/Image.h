@@ -7,9 +7,14 @@
 
 namespace pbr {
 
+class MappedFile;
+
 using Half = half_float::half;
 
-enum class PixelFormat : std::uint32_t { U8, F16, F32 };
+// Block compressed formats come last. Their images hold 4x4 pixel blocks that are
+// uploaded as they are: BC1 is opaque RGB, BC4 one channel, BC5 two, BC6H unsigned
+// half float RGB and BC7 RGBA.
+enum class PixelFormat : std::uint32_t { U8, F16, F32, BC1, BC4, BC5, BC6H, BC7 };
 
 struct ImageFormat {
     PixelFormat pFmt = PixelFormat::F32;
@@ -25,6 +30,21 @@ struct Extents {
 
 int ComponentSize(PixelFormat pFmt);
 
+inline bool IsCompressed(PixelFormat pFmt) {
+    return pFmt >= PixelFormat::BC1;
+}
+
+// Bytes per 4x4 block of a compressed format
+int BlockSize(PixelFormat pFmt);
+
+// Channels a compressed format decodes to
+int CompressedChannels(PixelFormat pFmt);
+
+// Rows that are copied or uploaded together, a row of blocks for compressed formats
+inline int RowsPerBand(PixelFormat pFmt) {
+    return IsCompressed(pFmt) ? 4 : 1;
+}
+
 inline int ResizeLvl(int dim, int lvl) {
     return std::max(dim >> lvl, 1);
 }
@@ -38,10 +58,20 @@ inline std::size_t TotalPixels(ImageFormat fmt, int levels = 1) {
 }
 
 inline std::size_t ImageSize(ImageFormat fmt, int levels = 1) {
-    return TotalPixels(fmt, levels) * ComponentSize(fmt.pFmt) * fmt.nChannels;
+    if (!IsCompressed(fmt.pFmt))
+        return TotalPixels(fmt, levels) * ComponentSize(fmt.pFmt) * fmt.nChannels;
+
+    // Partial blocks at the edges are stored whole
+    std::size_t blocks = 0;
+    for (int l = 0; l < levels; ++l)
+        blocks += std::size_t(ResizeLvl(fmt.width, l) + 3) / 4 *
+                  ((ResizeLvl(fmt.height, l) + 3) / 4);
+    return blocks * BlockSize(fmt.pFmt);
 }
 
-// Mipmapped image
+// Mipmapped image. Images created from a mapped file read their pixels in place and
+// only copy them into owned storage on the first write. Pixels of compressed images
+// can't be read, written or converted.
 class Image {
 public:
     using PixelVal = std::array<float, 4>;
@@ -52,6 +82,8 @@ public:
     Image(ImageFormat format, const std::byte* imgPtr, int levels = 1);
     Image(ImageFormat format, const float* imgPtr, int levels = 1);
     Image(ImageFormat format, Image&& srcImg);
+    Image(ImageFormat format, std::shared_ptr<const MappedFile> mapping,
+          std::size_t offset, int levels = 1);
 
     Image convertTo(ImageFormat newFmt, int nLvls = 1) const;
 
@@ -81,8 +113,11 @@ public:
 
     int numLevels() const { return levels; }
 
+    bool isMapped() const { return mapped != nullptr; }
+
 private:
     void fill(PixelVal val);
+    void detach();
 
     void resizeBuffer();
     std::size_t pixelOffset(int x, int y, int lvl = 0) const;
@@ -94,6 +129,9 @@ private:
     std::vector<Half> p16;
     std::vector<float> p32;
 
+    std::shared_ptr<const MappedFile> file = nullptr;
+    const std::byte* mapped = nullptr;
+
     ImageFormat fmt;
     int levels = 1;
 };
@@ -106,6 +144,16 @@ public:
             img = {fmt, levels};
     }
 
+    // Faces stored one after the other, with all their levels, starting at offset
+    CubeImage(ImageFormat fmt, int levels,
+              const std::shared_ptr<const MappedFile>& mapping, std::size_t offset)
+        : levels(levels) {
+        for (auto& img : faces) {
+            img = {fmt, mapping, offset, levels};
+            offset += img.size();
+        }
+    }
+
     const Image& operator[](int idx) const { return faces[idx]; }
     Image& operator[](int idx) { return faces[idx]; }
 
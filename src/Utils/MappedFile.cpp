@@ -0,0 +1,100 @@
+#include <MappedFile.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace pbr;
+
+MappedFile::MappedFile(const fs::path& filePath) {
+#ifdef _WIN32
+    _file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (_file == INVALID_HANDLE_VALUE) {
+        _file = nullptr;
+        return;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0) {
+        close();
+        return;
+    }
+
+    _mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping == nullptr) {
+        close();
+        return;
+    }
+
+    _data = static_cast<const std::byte*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    _size = _data ? static_cast<std::size_t>(size.QuadPart) : 0;
+    if (!_data)
+        close();
+#else
+    const int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr != MAP_FAILED) {
+            madvise(ptr, st.st_size, MADV_SEQUENTIAL);
+            _data = static_cast<const std::byte*>(ptr);
+            _size = st.st_size;
+        }
+    }
+
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+    : _data(std::exchange(rhs._data, nullptr)), _size(std::exchange(rhs._size, 0)) {
+#ifdef _WIN32
+    _file = std::exchange(rhs._file, nullptr);
+    _mapping = std::exchange(rhs._mapping, nullptr);
+#endif
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+    if (this != &rhs) {
+        close();
+        _data = std::exchange(rhs._data, nullptr);
+        _size = std::exchange(rhs._size, 0);
+#ifdef _WIN32
+        _file = std::exchange(rhs._file, nullptr);
+        _mapping = std::exchange(rhs._mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (_data)
+        UnmapViewOfFile(_data);
+    if (_mapping)
+        CloseHandle(_mapping);
+    if (_file)
+        CloseHandle(_file);
+    _file = _mapping = nullptr;
+#else
+    if (_data)
+        munmap(const_cast<std::byte*>(_data), _size);
+#endif
+    _data = nullptr;
+    _size = 0;
+}
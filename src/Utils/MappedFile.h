@@ -0,0 +1,49 @@
+#ifndef PBR_MAPPEDFILE_H
+#define PBR_MAPPEDFILE_H
+
+#include <PBR.h>
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace pbr {
+
+// Read only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const fs::path& filePath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& rhs) noexcept;
+    MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+    bool isOpen() const { return _data != nullptr; }
+
+    std::span<const std::byte> data() const { return {_data, _size}; }
+    std::size_t size() const { return _size; }
+
+    template<typename T>
+    const T* as(std::size_t offset = 0) const {
+        return reinterpret_cast<const T*>(_data + offset);
+    }
+
+private:
+    void close();
+
+    const std::byte* _data = nullptr;
+    std::size_t _size = 0;
+
+#ifdef _WIN32
+    void* _file = nullptr;
+    void* _mapping = nullptr;
+#endif
+};
+
+} // namespace pbr
+
+#endif
@@ -0,0 +1,288 @@
+#include <MipChain.h>
+
+#include <JobSystem.h>
+#include <PBRMath.h>
+#include <PixelConvert.h>
+
+#include <bit>
+
+using namespace pbr;
+using namespace pbr::math;
+
+namespace {
+
+// Kaiser windowed sinc, as wide as three destination pixels on each side
+constexpr float KaiserWidth = 3.0f;
+constexpr float KaiserAlpha = 4.0f;
+
+// Pixels per job when a level is split across the job system
+constexpr std::size_t GrainPixels = 1 << 14;
+
+// Level of float pixels, channels interleaved
+struct Level {
+    int width = 0;
+    int height = 0;
+    std::vector<float> px;
+};
+
+// Source pixels averaged by each destination pixel along one axis, count per pixel
+struct Taps {
+    int count = 0;
+    std::vector<int> index;
+    std::vector<float> weight;
+};
+
+template<typename Func>
+void ForRows(int width, int height, Func&& func) {
+    const std::size_t grain = std::max<std::size_t>(1, GrainPixels / width);
+    JobSystem::get().parallelFor(height, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t y = begin; y < end; ++y)
+            func(static_cast<int>(y));
+    });
+}
+
+float SrgbToLinear(float v) {
+    return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+}
+
+float LinearToSrgb(float v) {
+    v = std::clamp(v, 0.0f, 1.0f);
+    return v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+}
+
+// Channels holding color, a trailing alpha channel is linear
+int ColorChannels(int nChannels) {
+    return nChannels == 2 || nChannels == 4 ? nChannels - 1 : nChannels;
+}
+
+float Sinc(float x) {
+    if (std::abs(x) < 1e-4f)
+        return 1.0f;
+
+    x *= PI;
+    return std::sin(x) / x;
+}
+
+float BesselI0(float x) {
+    float sum = 1.0f, term = 1.0f;
+    for (int k = 1; k < 32 && term > 1e-8f * sum; ++k) {
+        const float t = x / (2.0f * k);
+        term *= t * t;
+        sum += term;
+    }
+
+    return sum;
+}
+
+float Kaiser(float x) {
+    const float t = x / KaiserWidth;
+    if (t * t >= 1.0f)
+        return 0.0f;
+
+    return Sinc(x) * BesselI0(KaiserAlpha * std::sqrt(1.0f - t * t)) /
+           BesselI0(KaiserAlpha);
+}
+
+Taps ComputeTaps(int srcSize, int dstSize, const MipOptions& options) {
+    const float scale = static_cast<float>(srcSize) / dstSize;
+    const bool box = options.filter == MipFilter::Box;
+    const float radius = box ? 0.5f * scale : KaiserWidth * scale;
+
+    Taps taps;
+    taps.count = static_cast<int>(std::ceil(2.0f * radius)) + 1;
+    taps.index.resize(std::size_t(dstSize) * taps.count);
+    taps.weight.resize(std::size_t(dstSize) * taps.count);
+
+    for (int x = 0; x < dstSize; ++x) {
+        const float center = (x + 0.5f) * scale;
+        const auto first = static_cast<int>(std::floor(center - radius));
+        int* index = &taps.index[std::size_t(x) * taps.count];
+        float* weight = &taps.weight[std::size_t(x) * taps.count];
+
+        float sum = 0.0f;
+        for (int t = 0; t < taps.count; ++t) {
+            const int i = first + t;
+
+            // Box weights are the coverage of the source pixel, Kaiser is sampled at
+            // its center in destination pixels
+            float w = 0.0f;
+            if (box)
+                w = std::max(0.0f, std::min(i + 1.0f, center + radius) -
+                                       std::max(float(i), center - radius));
+            else
+                w = Kaiser((i + 0.5f - center) / scale);
+
+            index[t] = options.wrap ? ((i % srcSize) + srcSize) % srcSize
+                                    : std::clamp(i, 0, srcSize - 1);
+            weight[t] = w;
+            sum += w;
+        }
+
+        for (int t = 0; t < taps.count; ++t)
+            weight[t] /= sum;
+    }
+
+    return taps;
+}
+
+Level Decode(const Image& image, MipEncoding encoding) {
+    const ImageFormat fmt = image.format();
+    const int nc = fmt.nChannels;
+
+    Level level{fmt.width, fmt.height, {}};
+    level.px.resize(TotalPixels(fmt) * nc);
+
+    auto* dst = reinterpret_cast<std::byte*>(level.px.data());
+    ConvertPixels(image.data(), {fmt.pFmt, nc}, dst, {PixelFormat::F32, nc},
+                  TotalPixels(fmt));
+
+    // Normal maps without a z channel are filtered as they are
+    if (encoding == MipEncoding::Linear || (encoding == MipEncoding::Normal && nc < 3))
+        return level;
+
+    std::array<float, 256> srgbLut;
+    for (std::size_t i = 0; i < srgbLut.size(); ++i)
+        srgbLut[i] = SrgbToLinear(i / 255.0f);
+
+    const bool fromU8 = fmt.pFmt == PixelFormat::U8;
+    const int colors = ColorChannels(nc);
+
+    ForRows(level.width, level.height, [&](int y) {
+        float* px = &level.px[std::size_t(y) * level.width * nc];
+        for (int x = 0; x < level.width; ++x, px += nc) {
+            if (encoding == MipEncoding::Normal) {
+                for (int c = 0; c < 3; ++c)
+                    px[c] = px[c] * 2.0f - 1.0f;
+                continue;
+            }
+
+            for (int c = 0; c < colors; ++c)
+                px[c] = fromU8 ? srgbLut[static_cast<int>(px[c] * 255.0f + 0.5f)]
+                               : SrgbToLinear(px[c]);
+        }
+    });
+
+    return level;
+}
+
+// Writes a level in the encoding of the image, into out
+void Encode(const Level& level, MipEncoding encoding, int nc, std::vector<float>& out) {
+    out.resize(level.px.size());
+
+    const int colors = ColorChannels(nc);
+    ForRows(level.width, level.height, [&](int y) {
+        const std::size_t offset = std::size_t(y) * level.width * nc;
+        const float* px = &level.px[offset];
+        float* outPx = &out[offset];
+
+        for (int x = 0; x < level.width; ++x, px += nc, outPx += nc) {
+            std::copy(px, px + nc, outPx);
+
+            if (encoding == MipEncoding::SRGB) {
+                for (int c = 0; c < colors; ++c)
+                    outPx[c] = LinearToSrgb(px[c]);
+            } else if (encoding == MipEncoding::Normal && nc >= 3) {
+                // The filtered vectors are shorter where normals diverge, only the
+                // stored level is renormalized and the next one still filters these
+                Vec3 n{px[0], px[1], px[2]};
+                const float length = n.length();
+                n = length > 1e-6f ? n / length : Vec3{0.0f, 0.0f, 1.0f};
+
+                for (int c = 0; c < 3; ++c)
+                    outPx[c] = n[c] * 0.5f + 0.5f;
+            }
+        }
+    });
+}
+
+Level FilterRows(const Level& src, int dstWidth, const Taps& taps, int nc) {
+    Level dst{dstWidth, src.height, {}};
+    dst.px.resize(std::size_t(dstWidth) * src.height * nc);
+
+    ForRows(dstWidth, src.height, [&](int y) {
+        const float* row = &src.px[std::size_t(y) * src.width * nc];
+        float* out = &dst.px[std::size_t(y) * dstWidth * nc];
+
+        for (int x = 0; x < dstWidth; ++x, out += nc) {
+            const int* index = &taps.index[std::size_t(x) * taps.count];
+            const float* weight = &taps.weight[std::size_t(x) * taps.count];
+
+            std::array<float, 4> sum{};
+            for (int t = 0; t < taps.count; ++t)
+                for (int c = 0; c < nc; ++c)
+                    sum[c] += weight[t] * row[index[t] * nc + c];
+
+            std::copy(sum.begin(), sum.begin() + nc, out);
+        }
+    });
+
+    return dst;
+}
+
+Level FilterColumns(const Level& src, int dstHeight, const Taps& taps, int nc) {
+    Level dst{src.width, dstHeight, {}};
+    dst.px.resize(std::size_t(src.width) * dstHeight * nc);
+
+    // Whole source rows are accumulated at once, which vectorizes
+    const std::size_t rowSize = std::size_t(src.width) * nc;
+    ForRows(src.width, dstHeight, [&](int y) {
+        const int* index = &taps.index[std::size_t(y) * taps.count];
+        const float* weight = &taps.weight[std::size_t(y) * taps.count];
+        float* out = &dst.px[y * rowSize];
+
+        for (int t = 0; t < taps.count; ++t) {
+            const float w = weight[t];
+            if (w == 0.0f)
+                continue;
+
+            const float* row = &src.px[index[t] * rowSize];
+            for (std::size_t i = 0; i < rowSize; ++i)
+                out[i] += w * row[i];
+        }
+    });
+
+    return dst;
+}
+
+Level Downsample(const Level& src, int nc, const MipOptions& options) {
+    const int width = std::max(src.width / 2, 1);
+    const int height = std::max(src.height / 2, 1);
+
+    // Axes already down to one pixel are left alone
+    Level rows = width == src.width
+                     ? src
+                     : FilterRows(src, width, ComputeTaps(src.width, width, options), nc);
+    if (height == src.height)
+        return rows;
+
+    return FilterColumns(rows, height, ComputeTaps(src.height, height, options), nc);
+}
+
+} // namespace
+
+int pbr::NumMipLevels(ImageFormat fmt) {
+    return std::bit_width(static_cast<unsigned>(std::max(fmt.width, fmt.height)));
+}
+
+Image pbr::GenerateMips(const Image& image, MipOptions options) {
+    const ImageFormat fmt = image.format();
+    const int nc = fmt.nChannels;
+    const int numLevels = NumMipLevels(fmt);
+
+    Image mips{fmt, numLevels};
+    mips.copy(image, 0, 0);
+
+    Level level = Decode(image, options.encoding);
+    std::vector<float> encoded;
+
+    for (int lvl = 1; lvl < numLevels; ++lvl) {
+        level = Downsample(level, nc, options);
+        Encode(level, options.encoding, nc, encoded);
+
+        ConvertPixels(reinterpret_cast<const std::byte*>(encoded.data()),
+                      {PixelFormat::F32, nc}, mips.data(lvl), {fmt.pFmt, nc},
+                      TotalPixels(mips.format(lvl)));
+    }
+
+    return mips;
+}
@@ -0,0 +1,33 @@
+#ifndef PBR_MIPCHAIN_H
+#define PBR_MIPCHAIN_H
+
+#include <Image.h>
+
+namespace pbr {
+
+enum class MipFilter : std::uint32_t { Box, Kaiser };
+
+// What the values of an image mean, which decides how they are averaged. sRGB colors
+// are filtered in linear space, alpha stays linear. Normal maps are filtered as vectors
+// and renormalized.
+enum class MipEncoding : std::uint32_t { Linear, SRGB, Normal };
+
+struct MipOptions {
+    MipFilter filter = MipFilter::Kaiser;
+    MipEncoding encoding = MipEncoding::Linear;
+    bool wrap = true;
+
+    bool operator==(const MipOptions&) const = default;
+};
+
+// Levels of a full chain, down to 1x1
+int NumMipLevels(ImageFormat fmt);
+
+// Image with the first level of image followed by a full mip chain, in the same format.
+// Each level is filtered from the one above it in float, so quantization doesn't build
+// up down the chain. Rows of large levels are filtered in parallel by the job system.
+Image GenerateMips(const Image& image, MipOptions options = {});
+
+} // namespace pbr
+
+#endif
@@ -0,0 +1,297 @@
+#include <PixelConvert.h>
+
+#include <JobSystem.h>
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define PBR_PIXEL_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+using namespace pbr;
+
+namespace {
+
+// Pixels per scanline chunk when channels are remapped through floats
+constexpr std::size_t BlockPixels = 256;
+
+// Runs shorter than this aren't worth a job
+constexpr std::size_t ParallelPixels = 1 << 18;
+constexpr std::size_t ParallelGrain = 1 << 16;
+
+// Components of n values, between F32 and U8 or F16
+using ConvertFunc = void (*)(const void* src, void* dst, std::size_t n);
+
+struct Kernels {
+    ConvertFunc u8ToF32;
+    ConvertFunc f32ToU8;
+    ConvertFunc f16ToF32;
+    ConvertFunc f32ToF16;
+    const char* name;
+};
+
+// --------------------------------------------------------------------------------------
+//      Scalar
+// --------------------------------------------------------------------------------------
+void U8ToF32(const void* src, void* dst, std::size_t n) {
+    const auto* s = static_cast<const std::uint8_t*>(src);
+    auto* d = static_cast<float*>(dst);
+    for (std::size_t i = 0; i < n; ++i)
+        d[i] = s[i] / 255.0f;
+}
+
+void F32ToU8(const void* src, void* dst, std::size_t n) {
+    const auto* s = static_cast<const float*>(src);
+    auto* d = static_cast<std::uint8_t*>(dst);
+    for (std::size_t i = 0; i < n; ++i) {
+        const float f32 = std::min(1.0f, std::max(0.0f, s[i]));
+        d[i] = static_cast<std::uint8_t>(f32 * 255.0f + 0.5f);
+    }
+}
+
+void F16ToF32(const void* src, void* dst, std::size_t n) {
+    const auto* s = static_cast<const Half*>(src);
+    auto* d = static_cast<float*>(dst);
+    for (std::size_t i = 0; i < n; ++i)
+        d[i] = s[i];
+}
+
+void F32ToF16(const void* src, void* dst, std::size_t n) {
+    const auto* s = static_cast<const float*>(src);
+    auto* d = static_cast<Half*>(dst);
+    for (std::size_t i = 0; i < n; ++i)
+        d[i] = s[i];
+}
+
+constexpr Kernels ScalarKernels{U8ToF32, F32ToU8, F16ToF32, F32ToF16, "scalar"};
+
+// --------------------------------------------------------------------------------------
+//      AVX2 + F16C, compiled for those targets regardless of the build flags and only
+//      called when the CPU reports them
+// --------------------------------------------------------------------------------------
+#ifdef PBR_PIXEL_X86
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PBR_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#else
+#define PBR_TARGET_AVX2
+#endif
+
+PBR_TARGET_AVX2 void U8ToF32Avx2(const void* src, void* dst, std::size_t n) {
+    const auto* s = static_cast<const std::uint8_t*>(src);
+    auto* d = static_cast<float*>(dst);
+    const __m256 scale = _mm256_set1_ps(255.0f);
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + i));
+        const __m256 f32 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(u8));
+        _mm256_storeu_ps(d + i, _mm256_div_ps(f32, scale));
+    }
+
+    U8ToF32(s + i, d + i, n - i);
+}
+
+PBR_TARGET_AVX2 void F32ToU8Avx2(const void* src, void* dst, std::size_t n) {
+    const auto* s = static_cast<const float*>(src);
+    auto* d = static_cast<std::uint8_t*>(dst);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 scale = _mm256_set1_ps(255.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // NaNs become 0, like the scalar clamp
+        __m256 f32 = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(s + i), zero), one);
+        f32 = _mm256_add_ps(_mm256_mul_ps(f32, scale), half);
+
+        const __m256i i32 = _mm256_cvttps_epi32(f32);
+        const __m128i u16 = _mm_packus_epi32(_mm256_castsi256_si128(i32),
+                                             _mm256_extracti128_si256(i32, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi16(u16, u16));
+    }
+
+    F32ToU8(s + i, d + i, n - i);
+}
+
+PBR_TARGET_AVX2 void F16ToF32Avx2(const void* src, void* dst, std::size_t n) {
+    const auto* s = static_cast<const std::uint16_t*>(src);
+    auto* d = static_cast<float*>(dst);
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i f16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        _mm256_storeu_ps(d + i, _mm256_cvtph_ps(f16));
+    }
+
+    F16ToF32(s + i, d + i, n - i);
+}
+
+PBR_TARGET_AVX2 void F32ToF16Avx2(const void* src, void* dst, std::size_t n) {
+    const auto* s = static_cast<const float*>(src);
+    auto* d = static_cast<std::uint16_t*>(dst);
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 f32 = _mm256_loadu_ps(s + i);
+        const __m128i f16 = _mm256_cvtps_ph(f32, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), f16);
+    }
+
+    F32ToF16(s + i, d + i, n - i);
+}
+
+constexpr Kernels Avx2Kernels{U8ToF32Avx2, F32ToU8Avx2, F16ToF32Avx2, F32ToF16Avx2,
+                              "AVX2/F16C"};
+
+bool HasAvx2F16C() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    const bool f16c = info[2] & (1 << 29);
+    const bool osxsave = info[2] & (1 << 27);
+    __cpuidex(info, 7, 0);
+    const bool avx2 = info[1] & (1 << 5);
+
+    // The OS has to save the upper halves of the ymm registers
+    return f16c && avx2 && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+#endif
+}
+
+#endif // PBR_PIXEL_X86
+
+const Kernels& SelectKernels() {
+    static const Kernels& kernels = []() -> const Kernels& {
+#ifdef PBR_PIXEL_X86
+        if (HasAvx2F16C())
+            return Avx2Kernels;
+#endif
+        return ScalarKernels;
+    }();
+
+    return kernels;
+}
+
+// n components of one format to another
+void ConvertComponents(const std::byte* src, PixelFormat from, std::byte* dst,
+                       PixelFormat to, std::size_t n) {
+    using enum PixelFormat;
+    const Kernels& k = SelectKernels();
+
+    if (from == to) {
+        std::memcpy(dst, src, n * ComponentSize(from));
+        return;
+    }
+
+    if (from == F32) {
+        (to == U8 ? k.f32ToU8 : k.f32ToF16)(src, dst, n);
+        return;
+    }
+
+    if (to == F32) {
+        (from == U8 ? k.u8ToF32 : k.f16ToF32)(src, dst, n);
+        return;
+    }
+
+    // Between U8 and F16, through floats
+    std::array<float, BlockPixels * 4> tmp;
+    const auto fromSize = ComponentSize(from);
+    const auto toSize = ComponentSize(to);
+
+    for (std::size_t i = 0; i < n; i += tmp.size()) {
+        const std::size_t count = std::min(tmp.size(), n - i);
+        ConvertComponents(src + i * fromSize, from,
+                          reinterpret_cast<std::byte*>(tmp.data()), F32, count);
+        ConvertComponents(reinterpret_cast<const std::byte*>(tmp.data()), F32,
+                          dst + i * toSize, to, count);
+    }
+}
+
+void ConvertRun(const std::byte* src, PixelLayout srcLayout, std::byte* dst,
+                PixelLayout dstLayout, std::size_t count) {
+    if (srcLayout.nChannels == dstLayout.nChannels) {
+        ConvertComponents(src, srcLayout.pFmt, dst, dstLayout.pFmt,
+                          count * srcLayout.nChannels);
+        return;
+    }
+
+    // Channels are remapped on floats, a block of pixels at a time
+    const auto srcPixel = ComponentSize(srcLayout.pFmt) * srcLayout.nChannels;
+    const auto dstPixel = ComponentSize(dstLayout.pFmt) * dstLayout.nChannels;
+    const int common = std::min(srcLayout.nChannels, dstLayout.nChannels);
+
+    std::array<float, BlockPixels * 4> in;
+    std::array<float, BlockPixels * 4> out;
+
+    for (std::size_t p = 0; p < count; p += BlockPixels) {
+        const std::size_t n = std::min(BlockPixels, count - p);
+
+        ConvertComponents(src + p * srcPixel, srcLayout.pFmt,
+                          reinterpret_cast<std::byte*>(in.data()), PixelFormat::F32,
+                          n * srcLayout.nChannels);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            const float* px = &in[i * srcLayout.nChannels];
+            float* outPx = &out[i * dstLayout.nChannels];
+
+            int c = 0;
+            for (; c < common; ++c)
+                outPx[c] = px[c];
+            for (; c < dstLayout.nChannels; ++c)
+                outPx[c] = 0.0f;
+        }
+
+        ConvertComponents(reinterpret_cast<const std::byte*>(out.data()),
+                          PixelFormat::F32, dst + p * dstPixel, dstLayout.pFmt,
+                          n * dstLayout.nChannels);
+    }
+}
+
+} // namespace
+
+void pbr::ConvertPixels(const std::byte* src, PixelLayout srcLayout, std::byte* dst,
+                        PixelLayout dstLayout, std::size_t count) {
+    DCHECK(srcLayout.nChannels > 0 && srcLayout.nChannels <= 4);
+    DCHECK(dstLayout.nChannels > 0 && dstLayout.nChannels <= 4);
+
+    if (count < ParallelPixels) {
+        ConvertRun(src, srcLayout, dst, dstLayout, count);
+        return;
+    }
+
+    const auto srcPixel = ComponentSize(srcLayout.pFmt) * srcLayout.nChannels;
+    const auto dstPixel = ComponentSize(dstLayout.pFmt) * dstLayout.nChannels;
+
+    JobSystem::get().parallelFor(count, ParallelGrain, [&](std::size_t b, std::size_t e) {
+        ConvertRun(src + b * srcPixel, srcLayout, dst + b * dstPixel, dstLayout, e - b);
+    });
+}
+
+void pbr::FillPixels(std::byte* dst, PixelLayout layout,
+                     const std::array<float, 4>& pixel, std::size_t count) {
+    if (count == 0)
+        return;
+
+    const std::size_t pixelSize = ComponentSize(layout.pFmt) * layout.nChannels;
+    ConvertRun(reinterpret_cast<const std::byte*>(pixel.data()), {PixelFormat::F32, 4},
+               dst, layout, 1);
+
+    // Doubles the filled part with every copy
+    std::size_t filled = 1;
+    while (filled < count) {
+        const std::size_t n = std::min(filled, count - filled);
+        std::memcpy(dst + filled * pixelSize, dst, n * pixelSize);
+        filled += n;
+    }
+}
+
+const char* pbr::PixelKernelsName() {
+    return SelectKernels().name;
+}
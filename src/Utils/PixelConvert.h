@@ -0,0 +1,28 @@
+#ifndef PBR_PIXELCONVERT_H
+#define PBR_PIXELCONVERT_H
+
+#include <Image.h>
+
+namespace pbr {
+
+struct PixelLayout {
+    PixelFormat pFmt = PixelFormat::F32;
+    int nChannels = 0;
+};
+
+// Converts a run of count pixels. Channels the source doesn't have are 0 and extra ones
+// are dropped, U8 values map to [0, 1] and are clamped on the way back. Half conversions
+// use F16C when the CPU has it, large runs are split across the job system.
+void ConvertPixels(const std::byte* src, PixelLayout srcLayout, std::byte* dst,
+                   PixelLayout dstLayout, std::size_t count);
+
+// Writes count copies of the first nChannels values of pixel
+void FillPixels(std::byte* dst, PixelLayout layout, const std::array<float, 4>& pixel,
+                std::size_t count);
+
+// Instruction set of the kernels picked for this CPU
+const char* PixelKernelsName();
+
+} // namespace pbr
+
+#endif
@@ -4,6 +4,11 @@
 #include <Camera.h>
 #include <Light.h>
 #include <Mesh.h>
+#include <Geometry.h>
+#include <MeshCache.h>
+#include <JobSystem.h>
+
+#include <map>
 
 using namespace pbr;
 using namespace std::literals;
@@ -66,6 +71,7 @@ std::unique_ptr<Scene> SceneLoader::parse(const fs::path& filePath) {
 
     ParseContext ctx{.tag = Tag::Scene};
     parseXml(root.value(), ctx);
+    instantiateMeshes();
 
     return std::move(scene);
 }
@@ -82,14 +88,48 @@ void SceneLoader::instantiate(ParseContext& ctx) {
         skyboxes.emplace_back(CreateSkybox(ctx.entry));
         break;
     case Tag::Mesh:
-        ctx.entry.insert("material", &ctx.material);
-        scene->addShape(CreateMesh(ctx.entry));
+        meshes.push_back(std::move(ctx));
         break;
     default:
         break;
     }
 }
 
+void SceneLoader::instantiateMeshes() {
+    // Every source is loaded once, meshes sharing it share the geometry
+    std::map<fs::path, sref<Geometry>> sources;
+    for (const auto& mesh : meshes)
+        if (auto path = MeshSourcePath(mesh.entry))
+            sources.try_emplace(*path);
+
+    std::vector<std::pair<const fs::path, sref<Geometry>>*> toLoad;
+    for (auto& source : sources)
+        toLoad.push_back(&source);
+
+    // File parsing, tangents and deduplication run on the job system. Uploads and
+    // materials need the GL context and are done here, in scene order.
+    auto& jobs = JobSystem::get();
+    jobs.parallelFor(toLoad.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            auto& [path, geometry] = *toLoad[i];
+            geometry = LoadCachedObj(path, false);
+            if (!geometry)
+                FATAL("Unable to load mesh {}.", path.string());
+        }
+    });
+
+    for (auto& mesh : meshes) {
+        sref<Geometry> geometry = nullptr;
+        if (auto path = MeshSourcePath(mesh.entry))
+            geometry = sources.at(*path);
+
+        mesh.entry.insert("material", &mesh.material);
+        scene->addShape(CreateMesh(mesh.entry, std::move(geometry)));
+    }
+
+    meshes.clear();
+}
+
 void SceneLoader::parseChildren(const XMLElement& xmlEl, ParseContext& ctx) {
     auto type = xmlEl.attr<std::string>("type");
     ctx.entry.insert("type", type);
@@ -55,6 +55,7 @@ private:
     };
 
     void instantiate(ParseContext& ctx);
+    void instantiateMeshes();
 
     template<typename T>
     void parseSimple(const XMLElement xmlEl, ParameterMap& map) const {
@@ -71,6 +72,10 @@ private:
 
     std::vector<Skybox> skyboxes;
     std::unique_ptr<Scene> scene = nullptr;
+
+    // Meshes are created once the whole file is parsed, so their geometry can be
+    // loaded in parallel
+    std::vector<ParseContext> meshes;
 };
 
 } // namespace pbr
@@ -24,6 +24,7 @@ std::unique_ptr<Image> LoadImage(const fs::path& filePath);
 void SaveImage(const fs::path& filePath, const Image& image);
 
 std::unique_ptr<CubeImage> LoadCubemap(const fs::path& filePath);
+void SaveCubemap(const fs::path& filePath, const CubeImage& cube);
 
 RRID LoadTexture(const fs::path& path);
 
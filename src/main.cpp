@@ -1,5 +1,6 @@
 #include <PBRApp.h>
 
+#include <MeshCache.h>
 #include <Utils.h>
 
 using namespace pbr;
@@ -8,6 +9,11 @@ int main(int argc, char* argv[]) {
     try {
         InitLogger();
         auto opts = ParseArgs(argc, argv);
+        if (!opts.meshCacheDir.empty()) {
+            BuildMeshCaches(opts.meshCacheDir);
+            return 0;
+        }
+
         auto app = std::make_unique<PBRApp>("PBR Demo", opts);
         app->loop();
     } catch (std::runtime_error& err) {
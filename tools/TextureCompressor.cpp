@@ -0,0 +1,149 @@
+// Offline block compressor for textures. 2D textures get their mip chain generated and
+// compressed into the .pbrmips cache the texture streamer loads, so they upload without
+// any decoding. Environment cubemaps (.cube) are compressed to BC6H next to their source
+// and picked up by the skybox. Build with -DPBR_BUILD_TOOLS=ON.
+//
+//   pbr-texc --type srgb albedo.png emissive.png
+//   pbr-texc --type normal normal.png
+//   pbr-texc --type linear roughness.png
+//   pbr-texc skybox/cube.cube skybox/irradiance.cube skybox/specular.cube
+//
+// Textures must be compressed with the --mip-filter the demo runs with, caches made with
+// another filter are rebuilt uncompressed at load.
+
+#include <BlockCompress.h>
+#include <JobSystem.h>
+#include <TextureCache.h>
+#include <Utils.h>
+
+#include <argparse/argparse.hpp>
+
+#include <chrono>
+
+using namespace pbr;
+using namespace pbr::util;
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double ToMB(std::size_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+// Normal maps keep their xy in BC5 and single channel maps go to BC4. Color goes to BC7,
+// or BC1 when asked for, which drops alpha.
+PixelFormat ChooseFormat(ImageFormat fmt, MipEncoding encoding, bool bc1) {
+    if (encoding == MipEncoding::Normal || fmt.nChannels == 2)
+        return PixelFormat::BC5;
+    if (fmt.nChannels == 1)
+        return PixelFormat::BC4;
+
+    return bc1 ? PixelFormat::BC1 : PixelFormat::BC7;
+}
+
+void CompressTexture(const fs::path& path, MipOptions options, bool bc1) {
+    auto image = LoadImage(path);
+    if (!image)
+        throw std::runtime_error(std::format("Failed to load {}.", path.string()));
+
+    const ImageFormat fmt = image->format();
+    if (IsCompressed(fmt.pFmt)) {
+        Print("{}: already compressed, skipped.", path.string());
+        return;
+    }
+
+    const auto start = Clock::now();
+    if (image->numLevels() == 1 && NumMipLevels(fmt) > 1)
+        image = std::make_unique<Image>(GenerateMips(*image, options));
+
+    const PixelFormat format = ChooseFormat(fmt, options.encoding, bc1);
+    const Image compressed = CompressImage(*image, format);
+
+    if (!WriteTextureCache(path, compressed, options))
+        throw std::runtime_error(
+            std::format("Failed to write the cache of {}.", path.string()));
+
+    Print("{} -> {}: {} levels, {:.2f} MB -> {:.2f} MB in {:.0f} ms", path.string(),
+          TextureCachePath(path, options.encoding).string(), compressed.numLevels(),
+          ToMB(image->size()), ToMB(compressed.size()), ElapsedMs(start));
+}
+
+void CompressCubemap(const fs::path& path) {
+    auto cube = LoadCubemap(path);
+    if (IsCompressed(cube->format().pFmt)) {
+        Print("{}: already compressed, skipped.", path.string());
+        return;
+    }
+
+    const auto start = Clock::now();
+    const CubeImage compressed = CompressCube(*cube, PixelFormat::BC6H);
+
+    const fs::path outPath = CompressedCubePath(path);
+    SaveCubemap(outPath, compressed);
+
+    Print("{} -> {}: {} levels, {:.2f} MB -> {:.2f} MB in {:.0f} ms", path.string(),
+          outPath.string(), compressed.numLevels(), ToMB((*cube)[0].size() * 6),
+          ToMB(compressed[0].size() * 6), ElapsedMs(start));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    argparse::ArgumentParser program("pbr-texc");
+
+    program.add_argument("files")
+        .help("PNG or .img textures, and .cube environment maps compressed to BC6H.")
+        .nargs(argparse::nargs_pattern::at_least_one);
+
+    program.add_argument("--type")
+        .help("What the 2D textures hold, srgb color, linear data or normal maps.")
+        .nargs(1)
+        .default_value("srgb"s)
+        .choices("srgb", "linear", "normal");
+
+    program.add_argument("--color")
+        .help("Format of color textures, bc7 or bc1 without alpha.")
+        .nargs(1)
+        .default_value("bc7"s)
+        .choices("bc7", "bc1");
+
+    program.add_argument("--mip-filter")
+        .help("Filter for the mip chains, kaiser or box. Must match the demo's.")
+        .nargs(1)
+        .default_value("kaiser"s)
+        .choices("kaiser", "box");
+
+    try {
+        InitLogger();
+        program.parse_args(argc, argv);
+
+        const std::string type = program.get("--type");
+
+        MipOptions options;
+        options.filter =
+            program.get("--mip-filter") == "box" ? MipFilter::Box : MipFilter::Kaiser;
+        options.encoding = type == "normal" ? MipEncoding::Normal
+                           : type == "srgb" ? MipEncoding::SRGB
+                                            : MipEncoding::Linear;
+
+        const bool bc1 = program.get("--color") == "bc1";
+        Print("Encoding on {} threads", JobSystem::get().numThreads());
+
+        for (const auto& file : program.get<std::vector<std::string>>("files")) {
+            const fs::path path{file};
+            if (path.extension() == ".cube")
+                CompressCubemap(path);
+            else
+                CompressTexture(path, options, bc1);
+        }
+    } catch (std::exception& err) {
+        PrintError("{}", err.what());
+        return 1;
+    }
+}